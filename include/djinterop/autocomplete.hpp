@@ -0,0 +1,54 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef DJINTEROP_AUTOCOMPLETE_HPP
+#define DJINTEROP_AUTOCOMPLETE_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstdint>
+#include <string>
+
+namespace djinterop
+{
+/// Textual track metadata fields for which values can be autocompleted.
+enum class autocomplete_field
+{
+    album,
+    artist,
+    genre,
+    publisher,
+};
+
+/// The `autocomplete_suggestion` struct describes a distinct value of a
+/// metadata field that completes a prefix.
+struct autocomplete_suggestion
+{
+    /// The value, exactly as stored in the database
+    std::string text;
+
+    /// Number of tracks having the value
+    int64_t usage_count;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_AUTOCOMPLETE_HPP
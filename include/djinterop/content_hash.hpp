@@ -0,0 +1,60 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef DJINTEROP_CONTENT_HASH_HPP
+#define DJINTEROP_CONTENT_HASH_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace djinterop
+{
+/// The `content_hash_options` struct controls how the music files of tracks
+/// are read when hashing their content.
+struct content_hash_options
+{
+    /// Maximum number of files read at the same time
+    size_t max_concurrent_reads = 4;
+
+    /// Number of bytes read from a file at a time
+    size_t read_size = 1024 * 1024;
+
+    /// Whether tracks that already have a content hash are hashed again
+    bool rehash = false;
+};
+
+/// The `content_hash_result` struct summarises the hashing of the music files
+/// of tracks.
+struct content_hash_result
+{
+    /// Number of tracks whose music files were hashed
+    int64_t hashed_count = 0;
+
+    /// IDs of tracks whose music files could not be read
+    std::vector<int64_t> unreadable_track_ids;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_CONTENT_HASH_HPP
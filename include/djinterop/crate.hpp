@@ -68,13 +68,23 @@ public:
     void add_track(track tr) const;
 
     /// Add a range of tracks to the crate.
+    ///
+    /// The range may contain either `track` objects or track ids.  Tracks that
+    /// are already contained in the crate are left untouched.
     template <typename InputIterator>
-    void add_tracks(InputIterator first, InputIterator last)
+    void add_tracks(InputIterator first, InputIterator last) const
     {
+        std::vector<int64_t> track_ids;
         for (auto iter = first; iter != last; ++iter)
-            add_track(*iter);
+            track_ids.push_back(track_id_of(*iter));
+        add_tracks(track_ids);
     }
 
+    /// Adds the tracks with the given ids to the crate
+    ///
+    /// All tracks are added in a single transaction.
+    void add_tracks(const std::vector<int64_t>& track_ids) const;
+
     /// Returns the (direct) children of this crate
     std::vector<crate> children() const;
 
@@ -122,6 +132,22 @@ public:
     /// Sets the crate's name
     void set_name(std::string name) const;
 
+    /// Sets the crate's contained tracks to exactly the given range
+    ///
+    /// The range may contain either `track` objects or track ids.  Only the
+    /// difference to the current contents of the crate is written.
+    template <typename InputIterator>
+    void set_tracks(InputIterator first, InputIterator last) const
+    {
+        std::vector<int64_t> track_ids;
+        for (auto iter = first; iter != last; ++iter)
+            track_ids.push_back(track_id_of(*iter));
+        set_tracks(track_ids);
+    }
+
+    /// Sets the crate's contained tracks to exactly the given track ids
+    void set_tracks(const std::vector<int64_t>& track_ids) const;
+
     /// Sets this crate's parent
     ///
     /// If `djinterop::nullopt` is given, then this crate will have no parent.
@@ -140,6 +166,9 @@ public:
     crate(std::shared_ptr<crate_impl> pimpl);
 
 private:
+    static int64_t track_id_of(int64_t track_id) noexcept;
+    static int64_t track_id_of(const track& tr);
+
     std::shared_ptr<crate_impl> pimpl_;
 
     friend class database;
@@ -0,0 +1,72 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_CRATE_MEMBERSHIP_INDEX_HPP
+#define DJINTEROP_CRATE_MEMBERSHIP_INDEX_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/id_bitmap.hpp>
+
+namespace djinterop
+{
+class crate_membership_index_impl;
+class database;
+
+/// A `crate_membership_index` object is an in-memory index of the tracks
+/// contained in each crate of a database, for fast filtering of tracks by
+/// crate.
+///
+/// The index is loaded in a single scan.  Tracks added to or removed from a
+/// crate via `crate::add_track()`, `crate::add_tracks()`, or
+/// `crate::remove_track()` are applied to the index directly, and any other
+/// change to crate membership, including by other connections to the same
+/// database, causes the index to be reloaded upon its next use.
+///
+/// `crate_membership_index` objects can be copied cheaply, resulting in
+/// multiple handles to the same index.
+class DJINTEROP_PUBLIC crate_membership_index
+{
+public:
+    /// Returns the IDs of the tracks contained in a given crate
+    id_bitmap tracks_in(int64_t crate_id) const;
+
+    /// Returns the IDs of the tracks contained in all of the given crates
+    id_bitmap tracks_in_all(const std::vector<int64_t>& crate_ids) const;
+
+    /// Returns the IDs of the tracks contained in any of the given crates
+    id_bitmap tracks_in_any(const std::vector<int64_t>& crate_ids) const;
+
+private:
+    crate_membership_index(std::shared_ptr<crate_membership_index_impl> pimpl);
+
+    std::shared_ptr<crate_membership_index_impl> pimpl_;
+
+    friend class database;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_CRATE_MEMBERSHIP_INDEX_HPP
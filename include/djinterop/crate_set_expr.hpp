@@ -0,0 +1,103 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_CRATE_SET_EXPR_HPP
+#define DJINTEROP_CRATE_SET_EXPR_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstdint>
+#include <memory>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop
+{
+/// A `crate_set_expr` object is an expression over sets of tracks, built from
+/// the contents of crates using union, intersection, and difference.
+///
+/// Expressions are immutable, and can be copied cheaply.  For example, the
+/// tracks in crate 1 or any of its descendants, but not in crate 2, are given
+/// by:
+///
+///     crate_set_expr::of(1, true) - crate_set_expr::of(2)
+class DJINTEROP_PUBLIC crate_set_expr
+{
+public:
+    /// The kind of an expression node
+    enum class kind
+    {
+        crate,
+        unite,
+        intersect,
+        subtract,
+    };
+
+    /// Returns an expression for the tracks contained in a given crate
+    ///
+    /// If `include_descendants` is `true`, then tracks contained in any
+    /// descendant of the crate are included as well.
+    static crate_set_expr of(int64_t crate_id, bool include_descendants = false);
+
+    /// Returns the kind of this expression node
+    kind type() const noexcept;
+
+    /// Returns the crate ID of a `kind::crate` node
+    int64_t crate_id() const noexcept;
+
+    /// Returns whether a `kind::crate` node includes descendant crates
+    bool include_descendants() const noexcept;
+
+    /// Returns the left operand of a union, intersection, or difference node
+    const crate_set_expr& left() const;
+
+    /// Returns the right operand of a union, intersection, or difference node
+    const crate_set_expr& right() const;
+
+private:
+    struct node;
+
+    crate_set_expr(std::shared_ptr<const node> node) noexcept;
+
+    std::shared_ptr<const node> node_;
+
+    friend crate_set_expr operator|(
+        const crate_set_expr& a, const crate_set_expr& b);
+    friend crate_set_expr operator&(
+        const crate_set_expr& a, const crate_set_expr& b);
+    friend crate_set_expr operator-(
+        const crate_set_expr& a, const crate_set_expr& b);
+};
+
+/// Returns an expression for the tracks in either of two sets
+DJINTEROP_PUBLIC crate_set_expr operator|(
+    const crate_set_expr& a, const crate_set_expr& b);
+
+/// Returns an expression for the tracks in both of two sets
+DJINTEROP_PUBLIC crate_set_expr operator&(
+    const crate_set_expr& a, const crate_set_expr& b);
+
+/// Returns an expression for the tracks in the first set but not the second
+DJINTEROP_PUBLIC crate_set_expr operator-(
+    const crate_set_expr& a, const crate_set_expr& b);
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_CRATE_SET_EXPR_HPP
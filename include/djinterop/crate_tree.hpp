@@ -0,0 +1,125 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_CRATE_TREE_HPP
+#define DJINTEROP_CRATE_TREE_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+class database;
+class database_impl;
+
+/// The `crate_tree_node` struct describes a single crate within a
+/// `crate_tree`.
+struct crate_tree_node
+{
+    /// ID of the crate
+    int64_t id;
+
+    /// Name of the crate
+    std::string name;
+
+    /// ID of the parent crate, or `nullopt` for a root crate
+    stdx::optional<int64_t> parent_id;
+
+    /// IDs of the direct children of the crate, in ascending order
+    std::vector<int64_t> child_ids;
+};
+
+/// A `crate_tree` object is an in-memory snapshot of the names and hierarchy
+/// of all crates in a database.
+///
+/// The snapshot is loaded in a single pass, after which all lookups are
+/// answered from memory, without accessing the database.  Changes made to the
+/// database afterwards are not visible until `refresh()` is called.
+class DJINTEROP_PUBLIC crate_tree
+{
+public:
+    /// Returns the node for the crate with the given ID
+    ///
+    /// If no such crate exists in the snapshot, then `nullptr` is returned.
+    const crate_tree_node* find(int64_t id) const;
+
+    /// Returns the node for the crate with the given name and parent
+    ///
+    /// If `parent_id` is `nullopt`, then a root crate is searched for.  If
+    /// several crates match, the one with the lowest ID is returned, and if
+    /// none match, then `nullptr` is returned.
+    const crate_tree_node* find_child(
+        stdx::optional<int64_t> parent_id, const std::string& name) const;
+
+    /// Returns the IDs of all descendants of the crate with the given ID
+    ///
+    /// A descendant is a direct or indirect child of the crate.  Descendants
+    /// are returned in depth-first order.
+    std::vector<int64_t> descendant_ids(int64_t id) const;
+
+    /// Returns all nodes in the snapshot, in ascending order of crate ID
+    const std::vector<crate_tree_node>& nodes() const noexcept;
+
+    /// Reloads the snapshot if any crate has changed since it was loaded
+    ///
+    /// Changes are detected both when made via this library, and when made by
+    /// other connections to the same database.  Returns `true` if the snapshot
+    /// was reloaded.
+    bool refresh();
+
+    /// Returns the IDs of all root crates, in ascending order
+    const std::vector<int64_t>& root_ids() const noexcept;
+
+private:
+    struct child_key_hash
+    {
+        size_t operator()(
+            const std::pair<int64_t, std::string>& key) const noexcept;
+    };
+
+    crate_tree(std::shared_ptr<database_impl> pimpl);
+
+    void load();
+
+    std::shared_ptr<database_impl> pimpl_;
+    int64_t version_ = 0;
+    std::vector<crate_tree_node> nodes_;
+    std::vector<int64_t> root_ids_;
+    std::unordered_map<int64_t, size_t> index_by_id_;
+    std::unordered_map<std::string, size_t> root_index_by_name_;
+    std::unordered_map<std::pair<int64_t, std::string>, size_t, child_key_hash>
+        child_index_by_name_;
+
+    friend class database;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_CRATE_TREE_HPP
@@ -30,16 +30,49 @@
 #include <vector>
 
 #include <djinterop/config.hpp>
+#include <djinterop/content_hash.hpp>
+#include <djinterop/file_scan.hpp>
+#include <djinterop/library_sync.hpp>
+#include <djinterop/library_watcher.hpp>
 #include <djinterop/optional.hpp>
+#include <djinterop/similar_tracks.hpp>
 
 namespace djinterop
 {
+enum class autocomplete_field;
+struct autocomplete_suggestion;
 class crate;
+class crate_membership_index;
+class crate_set_expr;
+class crate_tree;
+class library_snapshot;
+enum class musical_key;
 class database_impl;
 struct semantic_version;
 class track;
+class track_cursor;
+struct track_page;
+class track_query;
 class transaction_guard;
 
+/// The `track_row_cache_policy` enum describes how the tracks of a database
+/// cache their rows of the Track table, so that reading several fields of a
+/// track costs a single query.
+enum class track_row_cache_policy
+{
+    /// Rows are not cached, and the row is read afresh for every field
+    disabled,
+
+    /// Rows are cached, and are reloaded after changes made via this
+    /// database, but changes committed by other connections are not noticed
+    this_connection,
+
+    /// Rows are cached, and are also reloaded after changes committed by
+    /// other connections, which are checked for once per read, or only once
+    /// per transaction for reads made within a transaction
+    all_connections,
+};
+
 class database_not_found : public std::runtime_error
 {
 public:
@@ -61,8 +94,54 @@ public:
     /// Copy assignment operator
     database& operator=(const database& db);
 
+    /// Returns at most `limit` distinct values of a metadata field, across all
+    /// tracks, that start with a given prefix
+    ///
+    /// The prefix is matched ignoring case and diacritics.  Values are
+    /// returned in descending order of the number of tracks having them, and
+    /// then in alphabetical order.
+    ///
+    /// An in-memory table of the values of each field is built upon the first
+    /// call, and is thereafter kept up to date with changes made via this
+    /// database, and rebuilt upon changes made by other connections.
+    std::vector<autocomplete_suggestion> autocomplete(
+        autocomplete_field field, const std::string& prefix,
+        size_t limit) const;
+
     transaction_guard begin_transaction() const;
 
+    /// Hashes the content of the music file of each track, and stores the
+    /// hash with the track
+    ///
+    /// The music file of each track is found from its relative path, resolved
+    /// against the directory of the database.  Files are read in parallel,
+    /// with at most a given number read at the same time, each with large
+    /// sequential reads.  All hashes are stored in a single transaction.
+    /// Tracks whose files cannot be read are left unchanged, and reported in
+    /// the result.
+    ///
+    /// `std::invalid_argument` is thrown if the maximum number of concurrent
+    /// reads or the read size is zero.
+    content_hash_result compute_content_hashes(
+        const content_hash_options& options = content_hash_options{}) const;
+
+    /// Copies tracks from another database into this one, and returns the
+    /// copies, in the same order as the tracks given
+    ///
+    /// All data of each track is copied, including its metadata, album art,
+    /// and performance data, but not its membership of any crates.  Rows are
+    /// copied directly from one database to the other, without decoding any
+    /// performance data, and the origin of each copy is recorded.  Relative
+    /// paths are copied unchanged.  If the path of any track is already that
+    /// of a track in this database, then no tracks are copied, and
+    /// `std::runtime_error` is thrown.
+    ///
+    /// `track_deleted` is thrown if any track does not exist in the source
+    /// database.  This method must not be called while a transaction is in
+    /// progress.
+    std::vector<track> copy_tracks(
+        const database& source, const std::vector<track>& tracks) const;
+
     /// Returns the crate with the given ID
     ///
     /// If no such crate exists in the database, then `djinterop::stdx::nullopt`
@@ -92,10 +171,127 @@ public:
     /// This is the same as the directory passed to the `database` constructor.
     std::string directory() const;
 
+    /// Returns groups of two or more tracks whose music files have the same
+    /// content, according to the hashes stored by `compute_content_hashes()`
+    ///
+    /// Tracks that have not been hashed are never included.
+    std::vector<std::vector<track>> duplicate_tracks_by_content() const;
+
+    /// Returns the tracks that mix harmonically with a track of a given BPM
+    /// and key
+    ///
+    /// A track is returned if its BPM is within a relative tolerance of the
+    /// given BPM, or of half or double it, and its key is the same as the given
+    /// key, adjacent to it on the Camelot wheel, or its relative major or
+    /// minor.  Tracks are returned in ascending order of the relative
+    /// difference in BPM, and then by ascending track ID.
+    ///
+    /// An in-memory index is built upon the first call, and is thereafter kept
+    /// up to date with changes made via this database, and rebuilt upon
+    /// changes made by other connections.
+    ///
+    /// `std::invalid_argument` is thrown if the BPM is not positive, or the
+    /// tolerance is negative or not less than one third.
+    std::vector<track> harmonic_candidates(
+        double bpm, musical_key key, double bpm_tolerance = 0.06) const;
+
     /// Returns true iff the database version is supported by this version of
     /// `libdjinterop` or not
     bool is_supported() const;
 
+    /// Returns a page of the tracks satisfying a query, in the order given by
+    /// the query
+    ///
+    /// The first page is returned if no continuation token is given, and
+    /// otherwise the page following that which returned the token.  The token
+    /// is only valid for the same query.  Any limit set on the query is
+    /// ignored.
+    ///
+    /// Each page is found from the sort keys of the last track of the previous
+    /// page, rather than by an offset, so that pages deep into a large library
+    /// are found as quickly as those near its start.  This holds in particular
+    /// where the first sort key is textual metadata, or the track ID.  Tracks
+    /// added or changed between fetching pages are listed according to their
+    /// position at the time the next page is fetched.
+    ///
+    /// `std::invalid_argument` is thrown if the page size is zero, or the
+    /// continuation token is not valid for the query.
+    track_page list_tracks(
+        const track_query& query, size_t page_size,
+        const stdx::optional<std::string>& continuation_token =
+            stdx::nullopt) const;
+
+    /// Loads an in-memory snapshot of the names and hierarchy of all crates
+    ///
+    /// See `crate_tree` for details.
+    crate_tree load_crate_tree() const;
+
+    /// Loads an in-memory index of the tracks contained in each crate
+    ///
+    /// See `crate_membership_index` for details.
+    crate_membership_index load_crate_membership_index() const;
+
+    /// Loads an in-memory, column-oriented snapshot of the metadata of all
+    /// tracks
+    ///
+    /// If `include_track_data` is `true`, then track performance data is also
+    /// scanned, so that durations are exact rather than to the nearest second.
+    /// See `library_snapshot` for details.
+    library_snapshot load_library_snapshot(
+        bool include_track_data = false) const;
+
+    /// Returns the tracks satisfying a query, in the order given by the query
+    ///
+    /// The query is executed as a single statement, and the resulting tracks
+    /// are streamed.  See `track_query` for details.
+    track_cursor query_tracks(const track_query& query) const;
+
+    /// Changes the relative path of every track beginning with a given prefix
+    /// to begin with another prefix instead, and returns the number of tracks
+    /// changed
+    ///
+    /// This is intended for when music files have been moved, such as when a
+    /// music directory is renamed.  Prefixes are matched exactly, and so a
+    /// prefix naming a directory should end with a slash.  If any new path is
+    /// already that of a track, even one whose own path would change, then no
+    /// paths are changed, and `std::runtime_error` is thrown.
+    int64_t relocate_tracks(
+        const std::string& old_prefix, const std::string& new_prefix) const;
+
+    /// Checks that the music file of each track exists, and that its size is
+    /// as recorded in the database, where the schema records it
+    ///
+    /// The music file of each track is found from its relative path, resolved
+    /// against the directory of the database.  Tracks are read in batches, and
+    /// the files of each batch are checked in parallel, with at most a given
+    /// number checked at the same time, which hides the latency of network
+    /// mounts.  Problems are passed to a callback as each batch completes, in
+    /// ascending order of track ID, followed by progress.  Callbacks are made
+    /// on the calling thread.
+    ///
+    /// `std::invalid_argument` is thrown if the parallelism or the batch size
+    /// is zero.
+    file_scan_summary scan_files(
+        const file_scan_options& options = file_scan_options{}) const;
+
+    /// Sets how the tracks of the database cache their rows
+    ///
+    /// The policy applies to all tracks of this database object, including
+    /// tracks already obtained from it.  The default is
+    /// `track_row_cache_policy::all_connections`.
+    void set_track_row_cache_policy(track_row_cache_policy policy) const;
+
+    /// Returns a watcher of the directories containing the music files of
+    /// the tracks in the database
+    ///
+    /// Only the directories of tracks at the time of the call are watched,
+    /// along with any subdirectories later created within them.  See
+    /// `library_watcher` for details.  `std::runtime_error` is thrown on
+    /// platforms other than Linux.
+    library_watcher watch_library(
+        const library_watcher_options& options =
+            library_watcher_options{}) const;
+
     /// Returns the UUID of the database
     std::string uuid() const;
 
@@ -113,14 +309,57 @@ public:
 
     /// Removes a crate from the database
     ///
-    /// All handles to that crate become invalid.
+    /// Any sub-crate of the removed crate becomes a root crate.  All handles
+    /// to that crate become invalid.
     void remove_crate(crate cr) const;
 
+    /// Removes a range of crates from the database
+    ///
+    /// If `recursive` is `true`, then all descendants of the given crates are
+    /// removed as well.  Otherwise, any sub-crate of a removed crate that is
+    /// not itself removed becomes a root crate.  All handles to removed crates
+    /// become invalid.
+    template <typename InputIterator>
+    void remove_crates(
+        InputIterator first, InputIterator last, bool recursive) const
+    {
+        std::vector<int64_t> crate_ids;
+        for (auto iter = first; iter != last; ++iter)
+            crate_ids.push_back(iter->id());
+        remove_crates(crate_ids, recursive);
+    }
+
+    /// Removes the crates with the given ids from the database
+    ///
+    /// All crates are removed in a single transaction.  See the range
+    /// overload of this method for the meaning of `recursive`.
+    void remove_crates(
+        const std::vector<int64_t>& crate_ids, bool recursive) const;
+
     /// Removes a track from the database
     ///
     /// All handles to that track become invalid.
     void remove_track(track tr) const;
 
+    /// Removes a range of tracks from the database
+    ///
+    /// All handles to removed tracks become invalid.
+    template <typename InputIterator>
+    void remove_tracks(InputIterator first, InputIterator last) const
+    {
+        std::vector<int64_t> track_ids;
+        for (auto iter = first; iter != last; ++iter)
+            track_ids.push_back(iter->id());
+        remove_tracks(track_ids);
+    }
+
+    /// Removes the tracks with the given ids from the database
+    ///
+    /// All tracks are removed in a single transaction, along with their
+    /// metadata, performance data, and membership of any crates or other
+    /// lists.
+    void remove_tracks(const std::vector<int64_t>& track_ids) const;
+
     /// Returns the root-level crate with the given name.
     ///
     /// If no such crate exists, then `djinterop::stdx::nullopt` is returned.
@@ -131,20 +370,98 @@ public:
     /// A root crate is a crate that has no parent.
     std::vector<crate> root_crates() const;
 
+    /// Returns at most `limit` tracks whose textual metadata matches a query,
+    /// best matches first
+    ///
+    /// The title, artist, album, genre, comment, publisher, and composer of
+    /// each track are searched.  Matching is insensitive to case and to
+    /// diacritics, and each word of the query must match some field.  Words of
+    /// three or more characters may match anywhere within a field, whereas
+    /// shorter words must match the start of a word.  Matches in the title or
+    /// artist, and matches of whole fields or of the start of a field or word,
+    /// are ranked higher.  Ties are broken by ascending track ID.
+    ///
+    /// An in-memory index is built upon the first search, and is thereafter
+    /// kept up to date with changes made via this database, and rebuilt upon
+    /// changes made by other connections.
+    std::vector<track> search_tracks(
+        const std::string& query, size_t limit) const;
+
+    /// Returns groups of tracks whose artist, title, and duration are similar
+    /// enough that they are likely to be duplicates of one another, such as
+    /// re-encoded or re-tagged copies of the same music
+    ///
+    /// Artists and titles are compared by their words, ignoring case,
+    /// diacritics, punctuation, and words such as "feat".  Only tracks having
+    /// the same words in their artist or title, and durations within the
+    /// tolerance, are compared, and so tracks differing in both artist and
+    /// title are never found.  Comparisons are made on a number of threads.
+    /// The duration of each track is that stored with the track, in whole
+    /// seconds.  Groups are returned in descending order of their best score.
+    ///
+    /// `std::invalid_argument` is thrown if the duration tolerance is
+    /// negative, the minimum score is not within (0, 1], or the maximum number
+    /// of threads is zero.
+    std::vector<similar_track_group> similar_tracks(
+        const similar_tracks_options& options =
+            similar_tracks_options{}) const;
+
+    /// Synchronises the tracks of this database and another, such as a
+    /// desktop library and a copy of it on removable media
+    ///
+    /// Tracks are matched by relative path, or failing that by content hash,
+    /// and matched tracks are compared by cheap fingerprints of their track
+    /// data, metadata, and performance data.  Only those parts that differ are
+    /// copied, in the direction given by the conflict policy.  Unmatched
+    /// tracks are copied to the other database if so requested, but no track
+    /// is ever removed.  Album art and crate membership of matched tracks are
+    /// not synchronised.  The changes to each database are made in a single
+    /// transaction, and all changes are returned in the report, whether or not
+    /// this is a dry run.
+    ///
+    /// `std::invalid_argument` is thrown if the other database is not of the
+    /// same kind as this one.  This method must not be called while a
+    /// transaction is in progress on either database.
+    library_sync_report sync_library(
+        const database& other,
+        const library_sync_options& options = library_sync_options{}) const;
+
     /// Returns the track with the given id
     ///
     /// If no such track exists in the database, then `djinterop::stdx::nullopt`
     /// is returned.
     stdx::optional<track> track_by_id(int64_t id) const;
 
+    /// Returns the tracks with the given ids
+    ///
+    /// The returned vector has one element per given id, in the same order.
+    /// If no track exists for a given id, then the corresponding element is
+    /// `djinterop::stdx::nullopt`.  All ids are looked up using a single query.
+    std::vector<stdx::optional<track>> tracks_by_ids(
+        const std::vector<int64_t>& ids) const;
+
     /// Returns all tracks whose `relative_path` attribute in the database
     /// matches the given string
     std::vector<track> tracks_by_relative_path(
         const std::string& relative_path) const;
 
+    /// Returns, for each of the given relative paths, all tracks whose
+    /// `relative_path` attribute in the database matches it
+    ///
+    /// The returned vector has one element per given path, in the same order.
+    /// All paths are looked up using a single query.
+    std::vector<std::vector<track>> tracks_by_relative_paths(
+        const std::vector<std::string>& relative_paths) const;
+
     /// Returns all tracks contained in the database
     std::vector<track> tracks() const;
 
+    /// Returns the tracks given by a set expression over crates
+    ///
+    /// The expression is evaluated by a single query, and the resulting tracks
+    /// are streamed in ascending order of ID.
+    track_cursor tracks_in_crates(const crate_set_expr& expr) const;
+
     // TODO (haslersn): non public?
     database(std::shared_ptr<database_impl> pimpl);
 
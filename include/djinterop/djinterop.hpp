@@ -24,14 +24,28 @@
 #endif
 
 #include <djinterop/album_art.hpp>
+#include <djinterop/autocomplete.hpp>
+#include <djinterop/content_hash.hpp>
 #include <djinterop/crate.hpp>
+#include <djinterop/crate_membership_index.hpp>
+#include <djinterop/crate_set_expr.hpp>
+#include <djinterop/crate_tree.hpp>
 #include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
 #include <djinterop/exceptions.hpp>
+#include <djinterop/file_scan.hpp>
+#include <djinterop/id_bitmap.hpp>
+#include <djinterop/library_snapshot.hpp>
+#include <djinterop/library_sync.hpp>
+#include <djinterop/library_watcher.hpp>
 #include <djinterop/musical_key.hpp>
 #include <djinterop/pad_color.hpp>
 #include <djinterop/performance_data.hpp>
 #include <djinterop/semantic_version.hpp>
+#include <djinterop/similar_tracks.hpp>
 #include <djinterop/track.hpp>
+#include <djinterop/track_cursor.hpp>
+#include <djinterop/track_edit.hpp>
+#include <djinterop/track_query.hpp>
 
 #endif  // DJINTEROP_DJINTEROP_HPP
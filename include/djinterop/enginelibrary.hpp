@@ -25,11 +25,14 @@
 
 #include <array>
 #include <cstdint>
+#include <future>
 #include <string>
 #include <vector>
 
 #include <djinterop/config.hpp>
 #include <djinterop/database.hpp>
+#include <djinterop/library_snapshot.hpp>
+#include <djinterop/optional.hpp>
 #include <djinterop/pad_color.hpp>
 #include <djinterop/semantic_version.hpp>
 
@@ -137,6 +140,36 @@ database DJINTEROP_PUBLIC create_or_load_database(
 /// given directory.
 bool DJINTEROP_PUBLIC database_exists(const std::string& directory);
 
+/// Given the directory of an Engine Library, returns the path to the sidecar
+/// file in which a library snapshot of it is cached
+std::string DJINTEROP_PUBLIC
+library_snapshot_cache_path(const std::string& directory);
+
+/// Loads the library snapshot cached for the Engine Library in a given
+/// directory, without opening the database itself.
+///
+/// The cache file is memory-mapped read-only and decoded.  If there is no
+/// readable cache file, `nullopt` is returned.  Otherwise, the boolean
+/// reference parameter `stale` is set to indicate whether the cached snapshot
+/// was taken from a different state of the database, as identified by the
+/// size and modification time of its m.db file.  Stale snapshots are still
+/// returned, so that they may be shown while
+/// `rebuild_library_snapshot_cache()` runs.  No rebuild is started by this
+/// function, and so the caller should start one if the cache is stale or
+/// missing.
+stdx::optional<library_snapshot> DJINTEROP_PUBLIC
+load_cached_library_snapshot(const std::string& directory, bool& stale);
+
+/// Rebuilds the library snapshot cache of the database in a given directory,
+/// in the background.
+///
+/// A separate connection to the database is opened on a background thread, a
+/// snapshot is loaded through it and written to the cache file, and the
+/// snapshot is then made available through the returned future.  Any
+/// exception is likewise rethrown from the future.
+std::future<library_snapshot> DJINTEROP_PUBLIC
+rebuild_library_snapshot_cache(const std::string& directory);
+
 /// Loads an Engine Library database from a given directory.
 database DJINTEROP_PUBLIC load_database(const std::string& directory);
 
@@ -126,6 +126,32 @@ private:
     std::string name_;
 };
 
+/// The `crate_invalid_parent` exception is thrown when a crate would become
+/// its own ancestor, i.e. when a crate is made a child of itself or of one of
+/// its descendants.
+class crate_invalid_parent : public std::runtime_error
+{
+public:
+    /// Construct the exception for a given crate and proposed parent ID
+    explicit crate_invalid_parent(
+        const std::string& what_arg, int64_t id, int64_t parent_id) noexcept
+        : runtime_error{what_arg.c_str()},
+          id_{id},
+          parent_id_{parent_id}
+    {
+    }
+
+    /// Get the ID of the crate that was to be moved
+    int64_t id() const noexcept { return id_; }
+
+    /// Get the ID of the parent crate that was deemed invalid
+    int64_t parent_id() const noexcept { return parent_id_; }
+
+private:
+    int64_t id_;
+    int64_t parent_id_;
+};
+
 /// The `track_deleted` exception is thrown when an invalid `track` object is
 /// used, i.e. one that does not exist in the database anymore.
 class track_deleted : public std::invalid_argument
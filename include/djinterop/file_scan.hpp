@@ -0,0 +1,110 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef DJINTEROP_FILE_SCAN_HPP
+#define DJINTEROP_FILE_SCAN_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+/// Problems that may be found with the music file of a track.
+enum class file_scan_status
+{
+    /// The file does not exist
+    missing,
+
+    /// The file exists, but its status could not be read, such as when
+    /// permission is denied or a network mount is unavailable
+    inaccessible,
+
+    /// The file exists, but its size differs from that recorded in the
+    /// database
+    size_changed,
+};
+
+/// The `file_scan_entry` struct describes a problem with the music file of a
+/// track.
+struct file_scan_entry
+{
+    /// ID of the track
+    int64_t track_id;
+
+    /// Relative path of the music file of the track
+    std::string relative_path;
+
+    /// Problem with the music file
+    file_scan_status status;
+
+    /// Size of the file recorded in the database, if any
+    stdx::optional<int64_t> recorded_size;
+
+    /// Size of the file on disk, if it could be read
+    stdx::optional<int64_t> actual_size;
+};
+
+/// The `file_scan_options` struct controls how the music files of tracks are
+/// checked.
+struct file_scan_options
+{
+    /// Maximum number of files whose status is read at the same time
+    size_t parallelism = 16;
+
+    /// Number of tracks read from the database and checked at a time
+    size_t batch_size = 1024;
+
+    /// Function called for each track whose music file has a problem, in
+    /// ascending order of track ID
+    std::function<void(const file_scan_entry&)> on_entry;
+
+    /// Function called after each batch of tracks has been checked, with the
+    /// number of tracks checked so far and the total number of tracks
+    std::function<void(int64_t scanned_count, int64_t total_count)>
+        on_progress;
+};
+
+/// The `file_scan_summary` struct summarises the checking of the music files
+/// of tracks.
+struct file_scan_summary
+{
+    /// Number of tracks whose music files were checked
+    int64_t scanned_count = 0;
+
+    /// Number of tracks whose music files do not exist
+    int64_t missing_count = 0;
+
+    /// Number of tracks whose music files could not be checked
+    int64_t inaccessible_count = 0;
+
+    /// Number of tracks whose music files have changed in size
+    int64_t size_changed_count = 0;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_FILE_SCAN_HPP
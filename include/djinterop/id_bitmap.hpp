@@ -0,0 +1,133 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ID_BITMAP_HPP
+#define DJINTEROP_ID_BITMAP_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop
+{
+/// An `id_bitmap` is a compressed set of IDs, such as track IDs.
+///
+/// IDs are partitioned into chunks of 65536 consecutive values.  Sparse
+/// chunks are stored as a sorted array of 16-bit offsets, and dense chunks as
+/// a bitmap of 1024 64-bit words, so that set operations on dense chunks
+/// reduce to simple loops over words.
+class DJINTEROP_PUBLIC id_bitmap
+{
+public:
+    /// Constructs an empty set
+    id_bitmap() noexcept;
+
+    /// Constructs a set containing the IDs in the given range
+    template <typename InputIterator>
+    id_bitmap(InputIterator first, InputIterator last) :
+        id_bitmap{std::vector<int64_t>(first, last)}
+    {
+    }
+
+    /// Constructs a set containing the given IDs
+    explicit id_bitmap(std::vector<int64_t> ids);
+
+    /// Adds an ID to the set
+    void add(int64_t id);
+
+    /// Returns `true` iff the set contains the given ID
+    bool contains(int64_t id) const;
+
+    /// Returns `true` iff the set is empty
+    bool empty() const noexcept;
+
+    /// Removes an ID from the set, if present
+    void remove(int64_t id);
+
+    /// Returns the number of IDs in the set
+    size_t size() const noexcept;
+
+    /// Returns the IDs in the set, in ascending order
+    std::vector<int64_t> to_vector() const;
+
+    /// Adds all IDs in another set to this set
+    id_bitmap& operator|=(const id_bitmap& other);
+
+    /// Removes all IDs not in another set from this set
+    id_bitmap& operator&=(const id_bitmap& other);
+
+    /// Removes all IDs in another set from this set
+    id_bitmap& operator-=(const id_bitmap& other);
+
+    /// Returns `true` iff both sets contain the same IDs
+    bool operator==(const id_bitmap& other) const noexcept;
+
+    /// Returns `true` iff the sets contain different IDs
+    bool operator!=(const id_bitmap& other) const noexcept;
+
+private:
+    struct container
+    {
+        /// Sorted offsets, if the container is in array form
+        std::vector<uint16_t> array;
+
+        /// Bit words, if the container is in bitmap form
+        std::vector<uint64_t> words;
+
+        /// Number of IDs in the container
+        size_t cardinality = 0;
+
+        bool operator==(const container& other) const noexcept;
+    };
+
+    using chunk = std::pair<int64_t, container>;
+
+    container* find_container(int64_t key);
+    const container* find_container(int64_t key) const;
+
+    static void add_to(container& c, uint16_t low);
+    static bool contains_in(const container& c, uint16_t low);
+    static void normalise(container& c);
+    static bool remove_from(container& c, uint16_t low);
+    static container unite(const container& a, const container& b);
+    static std::vector<uint64_t> words_of(const container& c);
+    static container intersect(const container& a, const container& b);
+    static container subtract(const container& a, const container& b);
+
+    std::vector<chunk> chunks_;
+};
+
+/// Returns the union of two sets
+DJINTEROP_PUBLIC id_bitmap operator|(id_bitmap a, const id_bitmap& b);
+
+/// Returns the intersection of two sets
+DJINTEROP_PUBLIC id_bitmap operator&(id_bitmap a, const id_bitmap& b);
+
+/// Returns the IDs in the first set that are not in the second set
+DJINTEROP_PUBLIC id_bitmap operator-(id_bitmap a, const id_bitmap& b);
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_ID_BITMAP_HPP
@@ -0,0 +1,202 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_LIBRARY_SNAPSHOT_HPP
+#define DJINTEROP_LIBRARY_SNAPSHOT_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+class database;
+struct library_snapshot_impl;
+
+/// The `library_column` enum identifies a column of a `library_snapshot`.
+enum class library_column
+{
+    album,
+    artist,
+    bitrate,
+    bpm,
+    duration,
+    genre,
+    key,
+    title,
+    year,
+};
+
+/// A `library_snapshot` object is an in-memory, column-oriented snapshot of
+/// the commonly-sorted and commonly-filtered metadata of all tracks in a
+/// database.
+///
+/// Each track occupies one row, and rows are numbered densely from zero in
+/// ascending order of track ID.  Each column is held as a separate vector
+/// indexed by row.  Text columns hold references to a pool of interned
+/// strings, so that repeated values such as artists and genres are stored
+/// once, and can be compared without comparing the strings themselves.
+///
+/// The snapshot is loaded in a handful of scans of the database, after which
+/// it never accesses the database again.  `library_snapshot` objects can be
+/// copied cheaply, resulting in multiple handles to the same snapshot.
+class DJINTEROP_PUBLIC library_snapshot
+{
+public:
+    /// Reference to an interned string
+    using text_ref = uint32_t;
+
+    /// Reference used in text columns where a track has no value
+    static constexpr text_ref no_text = 0;
+
+    /// Returns the album column
+    const std::vector<text_ref>& albums() const noexcept;
+
+    /// Returns the artist column
+    const std::vector<text_ref>& artists() const noexcept;
+
+    /// Returns the bitrate column
+    const std::vector<stdx::optional<int64_t> >& bitrates() const noexcept;
+
+    /// Returns the BPM column
+    const std::vector<stdx::optional<double> >& bpms() const noexcept;
+
+    /// Decodes a snapshot from the binary form produced by `encode()`
+    ///
+    /// The data is only read during the call, and need not outlive the
+    /// returned snapshot.  If the data is not a valid encoding, then
+    /// `std::invalid_argument` is thrown.
+    static library_snapshot decode(const char* data, size_t size);
+
+    /// Returns the duration column
+    ///
+    /// Durations are taken to the nearest second from track metadata, or
+    /// exactly from track performance data if it was included when the
+    /// snapshot was loaded.
+    const std::vector<stdx::optional<std::chrono::milliseconds> >& durations()
+        const noexcept;
+
+    /// Encodes the snapshot in a compact binary form
+    ///
+    /// The form consists of fixed-width columns followed by a heap of the
+    /// interned strings, and is only intended to be read back by `decode()` on
+    /// the same platform.
+    std::vector<char> encode() const;
+
+    /// Returns the interned reference to a given string, or `nullopt` if no
+    /// track in the snapshot has that string in any text column
+    stdx::optional<text_ref> find_text(const std::string& text) const;
+
+    /// Returns the genre column
+    const std::vector<text_ref>& genres() const noexcept;
+
+    /// Returns the track ID column
+    const std::vector<int64_t>& ids() const noexcept;
+
+    /// Returns the musical key column
+    const std::vector<stdx::optional<musical_key> >& keys() const noexcept;
+
+    /// Returns the row of the track with the given ID, or `nullopt` if there
+    /// is no such track in the snapshot
+    stdx::optional<size_t> row_of(int64_t id) const;
+
+    /// Returns the rows whose value in a numeric column lies in the closed
+    /// range `[min, max]`
+    ///
+    /// Durations are compared in seconds, and musical keys by their
+    /// enumeration value.  Rows with no value never match.  Rows are returned
+    /// in ascending order.  If the column is a text column, then
+    /// `std::invalid_argument` is thrown.
+    std::vector<size_t> rows_in_range(
+        library_column column, double min, double max) const;
+
+    /// Returns the rows whose value in a text column is exactly the given
+    /// string, in ascending order
+    ///
+    /// If the column is not a text column, then `std::invalid_argument` is
+    /// thrown.
+    std::vector<size_t> rows_with_text(
+        library_column column, const std::string& text) const;
+
+    /// Returns the rows for which a given predicate returns `true`, in
+    /// ascending order
+    ///
+    /// The predicate is called with each row number in turn, and is expected
+    /// to inspect the columns of this snapshot directly.
+    template <typename Predicate>
+    std::vector<size_t> rows_where(Predicate predicate) const
+    {
+        std::vector<size_t> results;
+        auto count = size();
+        for (size_t row = 0; row < count; ++row)
+        {
+            if (predicate(row))
+            {
+                results.push_back(row);
+            }
+        }
+
+        return results;
+    }
+
+    /// Returns the number of rows in the snapshot
+    size_t size() const noexcept;
+
+    /// Returns a permutation of all rows, ordered by a given column
+    ///
+    /// Text is ordered by byte-wise comparison.  Rows with no value are placed
+    /// last regardless of direction, and rows with equal values remain in
+    /// ascending order of track ID.
+    std::vector<size_t> sorted_rows(
+        library_column column, bool descending = false) const;
+
+    /// Returns the string that a given interned reference refers to
+    ///
+    /// The reference `no_text` refers to the empty string.
+    const std::string& text(text_ref ref) const;
+
+    /// Returns the title column
+    const std::vector<text_ref>& titles() const noexcept;
+
+    /// Returns the year column
+    const std::vector<stdx::optional<int32_t> >& years() const noexcept;
+
+private:
+    library_snapshot(std::shared_ptr<library_snapshot_impl> pimpl);
+
+    const std::vector<text_ref>& text_column(library_column column) const;
+
+    std::shared_ptr<const library_snapshot_impl> pimpl_;
+
+    friend class database;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_LIBRARY_SNAPSHOT_HPP
@@ -0,0 +1,131 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_LIBRARY_SYNC_HPP
+#define DJINTEROP_LIBRARY_SYNC_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+/// How a track that differs between two databases is synchronised.
+enum class library_sync_conflict_policy
+{
+    /// The track in the first database is kept, and copied to the second
+    prefer_first,
+
+    /// The track in the second database is kept, and copied to the first
+    prefer_second,
+
+    /// The track with the later last-modified time is kept, and a track
+    /// whose last-modified times are equal or missing is left unchanged
+    prefer_newer,
+
+    /// Neither track is changed
+    skip,
+};
+
+/// The `library_sync_options` struct controls how two databases are
+/// synchronised.
+struct library_sync_options
+{
+    /// How tracks that differ between the databases are synchronised
+    library_sync_conflict_policy conflict_policy =
+        library_sync_conflict_policy::prefer_newer;
+
+    /// Whether tracks in only one database are copied to the other
+    bool copy_unmatched = true;
+
+    /// Whether the changes are only reported, and not made
+    bool dry_run = false;
+};
+
+/// Changes that may be made to synchronise a track.
+enum class library_sync_action
+{
+    /// The track is copied from the second database to the first
+    copy_to_first,
+
+    /// The track is copied from the first database to the second
+    copy_to_second,
+
+    /// The track in the first database is updated from the second
+    update_first,
+
+    /// The track in the second database is updated from the first
+    update_second,
+
+    /// The tracks differ, but are left unchanged by the conflict policy
+    conflict_skipped,
+};
+
+/// The `library_sync_change` struct describes a change made, or to be made,
+/// to synchronise a track.
+struct library_sync_change
+{
+    /// Change made to the track
+    library_sync_action action;
+
+    /// ID of the track in the first database, if there is one, including a
+    /// track copied to the first database
+    stdx::optional<int64_t> first_track_id;
+
+    /// ID of the track in the second database, if there is one, including a
+    /// track copied to the second database
+    stdx::optional<int64_t> second_track_id;
+
+    /// Relative path of the track that is kept
+    std::string relative_path;
+
+    /// Whether the columns of the track's row differ
+    bool track_differs = false;
+
+    /// Whether the metadata of the track differs
+    bool metadata_differs = false;
+
+    /// Whether the performance data of the track differs
+    bool performance_data_differs = false;
+};
+
+/// The `library_sync_report` struct describes the synchronisation of two
+/// databases.
+struct library_sync_report
+{
+    /// Number of tracks in the first database matched to a track in the
+    /// second
+    int64_t matched_count = 0;
+
+    /// Number of matched tracks that do not differ
+    int64_t unchanged_count = 0;
+
+    /// Changes made, or to be made, in ascending order of the ID of the track
+    /// in the first database, followed by tracks only in the second
+    std::vector<library_sync_change> changes;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_LIBRARY_SYNC_HPP
@@ -0,0 +1,125 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef DJINTEROP_LIBRARY_WATCHER_HPP
+#define DJINTEROP_LIBRARY_WATCHER_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/track.hpp>
+
+namespace djinterop
+{
+class database;
+class library_watcher_impl;
+
+/// The `library_watcher_options` struct controls how a `library_watcher`
+/// responds to changes to music files.
+struct library_watcher_options
+{
+    /// File extensions, in lower case, of new files for which tracks are
+    /// created
+    std::vector<std::string> extensions{"aif", "aiff", "alac", "flac", "m4a",
+                                        "mp3", "mp4",  "ogg",  "wav"};
+
+    /// Time without further changes after which a batch of changes is applied
+    std::chrono::milliseconds settle_time{500};
+
+    /// Longest time for which changes are gathered into a single batch
+    std::chrono::milliseconds max_batch_time{10000};
+};
+
+/// The `library_watcher_update` struct describes a batch of changes applied
+/// to a database by a `library_watcher`.
+struct library_watcher_update
+{
+    /// Tracks created for new music files
+    std::vector<track> created_tracks;
+
+    /// Tracks whose music files were moved or renamed, and whose relative
+    /// paths have been changed to match
+    std::vector<track> relocated_tracks;
+
+    /// Tracks whose music files have been deleted, or moved out of the
+    /// watched directories
+    ///
+    /// These tracks are not removed, so as not to lose any performance data,
+    /// and it is up to the caller to decide what to do with them.
+    std::vector<track> deleted_tracks;
+
+    /// Directories that were renamed, as pairs of their former and new
+    /// relative paths, but whose tracks could not be relocated to match,
+    /// because tracks already exist at some of the new paths
+    ///
+    /// The tracks within such directories keep their former paths.
+    std::vector<std::pair<std::string, std::string> > failed_directory_renames;
+};
+
+/// A `library_watcher` object watches the directories containing the music
+/// files of the tracks in a database, and updates the database as files are
+/// added, moved, and deleted.
+///
+/// Changes are gathered into batches, so that many related changes, such as
+/// the copying of a whole folder, are applied in a single transaction.  New
+/// subdirectories of watched directories are also watched.
+///
+/// Watching is only supported on Linux, where it is implemented with
+/// inotify.  Changes are only applied upon calls to `poll()`, on the calling
+/// thread, and so the watcher can be driven by any event loop via its native
+/// handle.
+class DJINTEROP_PUBLIC library_watcher
+{
+public:
+    /// Returns the file descriptor that becomes readable when changes are
+    /// pending
+    int native_handle() const noexcept;
+
+    /// Waits up to a given time for changes, and then applies them
+    ///
+    /// Once a change is seen, further changes are gathered until none have
+    /// been seen for the settle time, or the maximum batch time has passed.
+    /// All changes are then applied in a single transaction.  If no change is
+    /// seen within the given time, then the returned update is empty.  If
+    /// applying the changes throws, then they are discarded rather than
+    /// retried by later calls.
+    library_watcher_update poll(std::chrono::milliseconds timeout) const;
+
+    /// Returns the number of directories being watched
+    size_t watched_directory_count() const;
+
+private:
+    library_watcher(std::shared_ptr<library_watcher_impl> pimpl) noexcept;
+
+    std::shared_ptr<library_watcher_impl> pimpl_;
+
+    friend class database;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_LIBRARY_WATCHER_HPP
@@ -0,0 +1,77 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef DJINTEROP_SIMILAR_TRACKS_HPP
+#define DJINTEROP_SIMILAR_TRACKS_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <djinterop/track.hpp>
+
+namespace djinterop
+{
+/// The `similar_tracks_options` struct controls how tracks are compared when
+/// searching for tracks that are likely to be duplicates of one another.
+struct similar_tracks_options
+{
+    /// Greatest difference in duration between two tracks that are compared
+    std::chrono::milliseconds duration_tolerance{2000};
+
+    /// Least score, between zero and one, of two tracks that are reported as
+    /// similar
+    double min_score = 0.8;
+
+    /// Maximum number of threads on which tracks are compared
+    size_t max_threads = 4;
+};
+
+/// The `similar_track_pair` struct describes two tracks within a group of
+/// similar tracks that are likely to be duplicates of one another.
+struct similar_track_pair
+{
+    /// Index of the first track within the group
+    size_t first;
+
+    /// Index of the second track within the group
+    size_t second;
+
+    /// Similarity of the two tracks, between zero and one
+    double score;
+};
+
+/// The `similar_track_group` struct describes a group of tracks that are
+/// connected by pairs of similar tracks.
+struct similar_track_group
+{
+    /// Tracks in the group, in ascending order of ID
+    std::vector<track> tracks;
+
+    /// Pairs of similar tracks in the group, in descending order of score
+    std::vector<similar_track_pair> pairs;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_SIMILAR_TRACKS_HPP
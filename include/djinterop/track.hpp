@@ -41,6 +41,7 @@ namespace djinterop
 {
 class database;
 class crate;
+class track_edit;
 class track_impl;
 
 /// The `track_import_info` struct holds information about a track in a
@@ -165,6 +166,13 @@ public:
     /// Returns the duration (metadata) of the track
     stdx::optional<std::chrono::milliseconds> duration() const;
 
+    /// Begins an edit of the track
+    ///
+    /// Changes recorded on the returned `track_edit` are written to the
+    /// database together when `track_edit::commit()` is called.  Note that
+    /// `<djinterop/track_edit.hpp>` must be included in order to use it.
+    track_edit edit() const;
+
     // TODO (mr-smidge): Add `file_bytes()` and `set_file_bytes()` methods.
 
     /// Returns the file extension part of `track::relative_path()`
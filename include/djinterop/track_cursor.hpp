@@ -0,0 +1,57 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_TRACK_CURSOR_HPP
+#define DJINTEROP_TRACK_CURSOR_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <memory>
+
+#include <djinterop/config.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/track.hpp>
+
+namespace djinterop
+{
+class database;
+class track_cursor_impl;
+
+/// A `track_cursor` object streams the results of a query over tracks, one
+/// track at a time, without loading all results into memory at once.
+///
+/// Copies of a `track_cursor` object share the same position in the results.
+class DJINTEROP_PUBLIC track_cursor
+{
+public:
+    /// Returns the next track, or `nullopt` if there are no more tracks
+    stdx::optional<track> next();
+
+private:
+    track_cursor(std::shared_ptr<track_cursor_impl> pimpl) noexcept;
+
+    std::shared_ptr<track_cursor_impl> pimpl_;
+
+    friend class database;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_CURSOR_HPP
@@ -0,0 +1,150 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_TRACK_EDIT_HPP
+#define DJINTEROP_TRACK_EDIT_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
+#include <djinterop/track.hpp>
+
+namespace djinterop
+{
+class track_impl;
+
+/// The `track_changes` struct holds a set of pending changes to a track.
+///
+/// Each field that is engaged will be written when the changes are committed,
+/// and each field that is disengaged will be left untouched.  For fields that
+/// may themselves be absent on a track, the inner optional holds the new
+/// value, which may be `nullopt` in order to clear the field.
+struct track_changes
+{
+    stdx::optional<std::vector<beatgrid_marker>> adjusted_beatgrid;
+    stdx::optional<double> adjusted_main_cue;
+    stdx::optional<stdx::optional<std::string>> album;
+    stdx::optional<stdx::optional<int64_t>> album_art_id;
+    stdx::optional<stdx::optional<std::string>> artist;
+    stdx::optional<stdx::optional<double>> average_loudness;
+    stdx::optional<stdx::optional<int64_t>> bitrate;
+    stdx::optional<stdx::optional<double>> bpm;
+    stdx::optional<stdx::optional<std::string>> comment;
+    stdx::optional<stdx::optional<std::string>> composer;
+    stdx::optional<std::vector<beatgrid_marker>> default_beatgrid;
+    stdx::optional<double> default_main_cue;
+    stdx::optional<stdx::optional<std::string>> genre;
+    std::array<stdx::optional<stdx::optional<hot_cue>>, 8> hot_cues;
+    stdx::optional<stdx::optional<track_import_info>> import_info;
+    stdx::optional<stdx::optional<musical_key>> key;
+    stdx::optional<stdx::optional<std::chrono::system_clock::time_point>>
+        last_accessed_at;
+    stdx::optional<stdx::optional<std::chrono::system_clock::time_point>>
+        last_modified_at;
+    stdx::optional<stdx::optional<std::chrono::system_clock::time_point>>
+        last_played_at;
+    std::array<stdx::optional<stdx::optional<loop>>, 8> loops;
+    stdx::optional<stdx::optional<std::string>> publisher;
+    stdx::optional<std::string> relative_path;
+    stdx::optional<stdx::optional<sampling_info>> sampling;
+    stdx::optional<stdx::optional<std::string>> title;
+    stdx::optional<stdx::optional<int32_t>> track_number;
+    stdx::optional<std::vector<waveform_entry>> waveform;
+    stdx::optional<stdx::optional<int32_t>> year;
+};
+
+/// A `track_edit` object records changes to a track, and writes them to the
+/// database together when `commit()` is called.
+///
+/// Setting many fields through a `track_edit` is considerably cheaper than
+/// calling the equivalent setters on `track` one at a time, as the changes are
+/// written with as few statements as possible, inside a single transaction.
+///
+/// Nothing is written to the database until `commit()` is called.  If the
+/// `track_edit` is destroyed without being committed, the recorded changes are
+/// discarded.
+class DJINTEROP_PUBLIC track_edit
+{
+public:
+    /// Returns the changes recorded so far
+    const track_changes& changes() const noexcept;
+
+    /// Writes all recorded changes to the database
+    ///
+    /// The recorded changes are cleared afterwards, so that the same
+    /// `track_edit` may be used again.
+    void commit();
+
+    track_edit& set_adjusted_beatgrid(std::vector<beatgrid_marker> beatgrid);
+    track_edit& set_adjusted_main_cue(double sample_offset);
+    track_edit& set_album(stdx::optional<std::string> album);
+    track_edit& set_album_art_id(stdx::optional<int64_t> album_art_id);
+    track_edit& set_artist(stdx::optional<std::string> artist);
+    track_edit& set_average_loudness(stdx::optional<double> average_loudness);
+    track_edit& set_bitrate(stdx::optional<int64_t> bitrate);
+    track_edit& set_bpm(stdx::optional<double> bpm);
+    track_edit& set_comment(stdx::optional<std::string> comment);
+    track_edit& set_composer(stdx::optional<std::string> composer);
+    track_edit& set_default_beatgrid(std::vector<beatgrid_marker> beatgrid);
+    track_edit& set_default_main_cue(double sample_offset);
+    track_edit& set_genre(stdx::optional<std::string> genre);
+    track_edit& set_hot_cue_at(int32_t index, stdx::optional<hot_cue> cue);
+    track_edit& set_hot_cues(std::array<stdx::optional<hot_cue>, 8> cues);
+    track_edit& set_import_info(
+        const stdx::optional<track_import_info>& import_info);
+    track_edit& set_key(stdx::optional<musical_key> key);
+    track_edit& set_last_accessed_at(
+        stdx::optional<std::chrono::system_clock::time_point> accessed_at);
+    track_edit& set_last_modified_at(
+        stdx::optional<std::chrono::system_clock::time_point> modified_at);
+    track_edit& set_last_played_at(
+        stdx::optional<std::chrono::system_clock::time_point> played_at);
+    track_edit& set_loop_at(int32_t index, stdx::optional<loop> l);
+    track_edit& set_loops(std::array<stdx::optional<loop>, 8> loops);
+    track_edit& set_publisher(stdx::optional<std::string> publisher);
+    track_edit& set_relative_path(std::string relative_path);
+    track_edit& set_sampling(stdx::optional<sampling_info> sampling);
+    track_edit& set_title(stdx::optional<std::string> title);
+    track_edit& set_track_number(stdx::optional<int32_t> track_number);
+    track_edit& set_waveform(std::vector<waveform_entry> waveform);
+    track_edit& set_year(stdx::optional<int32_t> year);
+
+private:
+    track_edit(std::shared_ptr<track_impl> pimpl) noexcept;
+
+    std::shared_ptr<track_impl> pimpl_;
+    track_changes changes_;
+
+    friend class track;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_EDIT_HPP
@@ -0,0 +1,204 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef DJINTEROP_TRACK_QUERY_HPP
+#define DJINTEROP_TRACK_QUERY_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/track.hpp>
+
+namespace djinterop
+{
+enum class musical_key;
+
+/// Fields of a track that can be filtered and ordered by in a `track_query`.
+enum class track_field
+{
+    album,
+    artist,
+    bitrate,
+    bpm,
+    comment,
+    composer,
+    duration,
+    file_extension,
+    filename,
+    genre,
+    key,
+    publisher,
+    relative_path,
+    title,
+    track_number,
+    year,
+};
+
+/// Returns whether the values of a field are text, rather than numbers
+DJINTEROP_PUBLIC bool is_text_field(track_field field) noexcept;
+
+/// A `track_query_value` object is a value to compare a field against.
+///
+/// It converts implicitly from integers, floating-point numbers, strings, and
+/// musical keys.
+class DJINTEROP_PUBLIC track_query_value
+{
+public:
+    using variant_type = std::variant<int64_t, double, std::string>;
+
+    track_query_value(int value) noexcept;
+    track_query_value(int64_t value) noexcept;
+    track_query_value(double value) noexcept;
+    track_query_value(const char* value);
+    track_query_value(std::string value) noexcept;
+    track_query_value(musical_key value) noexcept;
+
+    /// Returns whether the value is text, rather than a number
+    bool is_text() const noexcept;
+
+    /// Returns the underlying value
+    const variant_type& get() const noexcept;
+
+private:
+    variant_type value_;
+};
+
+/// A `track_query` object describes a query over tracks, consisting of
+/// predicates that must all hold, an ordering, and a limit on the number of
+/// results.
+///
+/// Queries are built by chaining calls, and executed by
+/// `database::query_tracks()`.  For example:
+///
+///     track_query{}
+///         .where_between(track_field::bpm, 124, 128)
+///         .where_in(track_field::key, {musical_key::a_minor,
+///                                      musical_key::e_minor})
+///         .where(track_field::genre, track_query::comparison::equal,
+///                "Techno")
+///         .order_by(track_field::bpm)
+///         .limit(100)
+///
+/// Text is compared exactly, and so is sensitive to case.  A track lacking a
+/// value for a field never satisfies a comparison on that field.
+class DJINTEROP_PUBLIC track_query
+{
+public:
+    /// The kind of comparison made by a predicate
+    enum class comparison
+    {
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+        between,
+        in,
+        missing,
+    };
+
+    /// A predicate over a single field
+    struct predicate
+    {
+        track_field field;
+        comparison op;
+
+        /// The values compared against, of which there are two for
+        /// `between`, any number for `in`, none for `missing`, and one
+        /// otherwise
+        std::vector<track_query_value> values;
+    };
+
+    /// A key by which results are ordered
+    struct sort_key
+    {
+        track_field field;
+        bool descending;
+    };
+
+    /// Adds a predicate that a field compares in a given way to a value
+    ///
+    /// The comparison must take a single value, and the value must be text if
+    /// and only if the field is a text field, or else `std::invalid_argument`
+    /// is thrown.
+    track_query& where(
+        track_field field, comparison op, track_query_value value);
+
+    /// Adds a predicate that a field lies within an inclusive range
+    track_query& where_between(
+        track_field field, track_query_value min, track_query_value max);
+
+    /// Adds a predicate that a field is equal to any of a set of values
+    ///
+    /// If the set is empty, then no track matches the query.
+    track_query& where_in(
+        track_field field, std::vector<track_query_value> values);
+
+    /// Adds a predicate that a track has no value for a field
+    track_query& where_missing(track_field field);
+
+    /// Orders results by a field, after any fields previously ordered by
+    ///
+    /// Tracks lacking a value for the field are ordered last, and ties are
+    /// finally broken by ascending track ID.
+    track_query& order_by(track_field field, bool descending = false);
+
+    /// Limits the number of results
+    track_query& limit(size_t max_results);
+
+    /// Returns the predicates of the query, in the order they were added
+    const std::vector<predicate>& predicates() const noexcept;
+
+    /// Returns the keys by which results are ordered, most significant first
+    const std::vector<sort_key>& sort_keys() const noexcept;
+
+    /// Returns the maximum number of results, if limited
+    stdx::optional<size_t> max_results() const noexcept;
+
+private:
+    std::vector<predicate> predicates_;
+    std::vector<sort_key> sort_keys_;
+    stdx::optional<size_t> max_results_;
+};
+
+/// The `track_page` struct describes a page of a listing of tracks, as
+/// returned by `database::list_tracks()`.
+struct track_page
+{
+    /// Tracks on the page, in order
+    std::vector<track> tracks;
+
+    /// Opaque token from which the listing continues on the next page, or
+    /// `nullopt` if there are no further tracks
+    stdx::optional<std::string> continuation_token;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_QUERY_HPP
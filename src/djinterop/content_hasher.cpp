@@ -0,0 +1,164 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <djinterop/content_hasher.hpp>
+
+#include <cstring>
+
+namespace djinterop
+{
+namespace
+{
+constexpr uint64_t prime_1 = 11400714785074694791ULL;
+constexpr uint64_t prime_2 = 14029467366897019727ULL;
+constexpr uint64_t prime_3 = 1609587929392839161ULL;
+constexpr uint64_t prime_4 = 9650029242287828579ULL;
+constexpr uint64_t prime_5 = 2870177450012600261ULL;
+
+uint64_t rotate_left(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/// Read a little-endian integer, regardless of the endianness of the host.
+template <typename T>
+T read_le(const unsigned char* bytes)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(bytes[i]) << (8 * i);
+    }
+
+    return value;
+}
+
+uint64_t round(uint64_t accumulator, uint64_t input)
+{
+    accumulator += input * prime_2;
+    accumulator = rotate_left(accumulator, 31);
+    return accumulator * prime_1;
+}
+
+uint64_t merge_round(uint64_t hash, uint64_t accumulator)
+{
+    hash ^= round(0, accumulator);
+    return hash * prime_1 + prime_4;
+}
+
+}  // namespace
+
+content_hasher::content_hasher(uint64_t seed) noexcept :
+    accumulators_{seed + prime_1 + prime_2, seed + prime_2, seed,
+                  seed - prime_1},
+    seed_{seed}
+{
+}
+
+void content_hasher::update(const void* data, size_t size) noexcept
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    total_size_ += size;
+
+    if (buffered_size_ + size < buffer_.size())
+    {
+        std::memcpy(buffer_.data() + buffered_size_, bytes, size);
+        buffered_size_ += size;
+        return;
+    }
+
+    auto consume_stripe = [this](const unsigned char* stripe) {
+        for (size_t i = 0; i < accumulators_.size(); ++i)
+        {
+            accumulators_[i] =
+                round(accumulators_[i], read_le<uint64_t>(stripe + 8 * i));
+        }
+    };
+
+    if (buffered_size_ > 0)
+    {
+        auto fill = buffer_.size() - buffered_size_;
+        std::memcpy(buffer_.data() + buffered_size_, bytes, fill);
+        consume_stripe(buffer_.data());
+        bytes += fill;
+        size -= fill;
+        buffered_size_ = 0;
+    }
+
+    for (; size >= buffer_.size(); size -= buffer_.size())
+    {
+        consume_stripe(bytes);
+        bytes += buffer_.size();
+    }
+
+    std::memcpy(buffer_.data(), bytes, size);
+    buffered_size_ = size;
+}
+
+uint64_t content_hasher::digest() const noexcept
+{
+    uint64_t hash;
+    if (total_size_ >= buffer_.size())
+    {
+        hash = rotate_left(accumulators_[0], 1) +
+               rotate_left(accumulators_[1], 7) +
+               rotate_left(accumulators_[2], 12) +
+               rotate_left(accumulators_[3], 18);
+        for (auto accumulator : accumulators_)
+        {
+            hash = merge_round(hash, accumulator);
+        }
+    }
+    else
+    {
+        hash = seed_ + prime_5;
+    }
+
+    hash += total_size_;
+
+    auto bytes = buffer_.data();
+    auto remaining = buffered_size_;
+    for (; remaining >= 8; bytes += 8, remaining -= 8)
+    {
+        hash ^= round(0, read_le<uint64_t>(bytes));
+        hash = rotate_left(hash, 27) * prime_1 + prime_4;
+    }
+
+    if (remaining >= 4)
+    {
+        hash ^= read_le<uint32_t>(bytes) * prime_1;
+        hash = rotate_left(hash, 23) * prime_2 + prime_3;
+        bytes += 4;
+        remaining -= 4;
+    }
+
+    for (; remaining > 0; ++bytes, --remaining)
+    {
+        hash ^= *bytes * prime_5;
+        hash = rotate_left(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime_2;
+    hash ^= hash >> 29;
+    hash *= prime_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}  // namespace djinterop
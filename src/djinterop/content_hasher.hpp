@@ -0,0 +1,51 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace djinterop
+{
+/// A streaming implementation of the 64-bit xxHash algorithm (XXH64), for
+/// hashing the content of music files.
+///
+/// Data may be given in chunks of any size, and the digest is the same as if
+/// all data had been given at once.
+class content_hasher
+{
+public:
+    explicit content_hasher(uint64_t seed = 0) noexcept;
+
+    /// Hash a further chunk of data.
+    void update(const void* data, size_t size) noexcept;
+
+    /// Get the hash of all data given so far.
+    uint64_t digest() const noexcept;
+
+private:
+    std::array<uint64_t, 4> accumulators_;
+    std::array<unsigned char, 32> buffer_;
+    size_t buffered_size_ = 0;
+    uint64_t total_size_ = 0;
+    uint64_t seed_;
+};
+
+}  // namespace djinterop
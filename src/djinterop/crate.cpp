@@ -40,6 +40,11 @@ void crate::add_track(track tr) const
     pimpl_->add_track(tr);
 }
 
+void crate::add_tracks(const std::vector<int64_t>& track_ids) const
+{
+    pimpl_->add_tracks(track_ids);
+}
+
 std::vector<crate> crate::children() const
 {
     return pimpl_->children();
@@ -100,6 +105,11 @@ void crate::set_parent(stdx::optional<crate> parent) const
     pimpl_->set_parent(parent);
 }
 
+void crate::set_tracks(const std::vector<int64_t>& track_ids) const
+{
+    pimpl_->set_tracks(track_ids);
+}
+
 stdx::optional<crate> crate::sub_crate_by_name(const std::string& name) const
 {
     return pimpl_->sub_crate_by_name(name);
@@ -112,4 +122,14 @@ std::vector<track> crate::tracks() const
 
 crate::crate(std::shared_ptr<crate_impl> pimpl) : pimpl_{std::move(pimpl)} {}
 
+int64_t crate::track_id_of(int64_t track_id) noexcept
+{
+    return track_id;
+}
+
+int64_t crate::track_id_of(const track& tr)
+{
+    return tr.id();
+}
+
 }  // namespace djinterop
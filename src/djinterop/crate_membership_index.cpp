@@ -0,0 +1,82 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate_membership_index.hpp>
+#include <djinterop/impl/crate_membership_index_impl.hpp>
+
+namespace djinterop
+{
+id_bitmap crate_membership_index::tracks_in(int64_t crate_id) const
+{
+    pimpl_->refresh();
+    auto tracks = pimpl_->find(crate_id);
+    return tracks ? *tracks : id_bitmap{};
+}
+
+id_bitmap crate_membership_index::tracks_in_all(
+    const std::vector<int64_t>& crate_ids) const
+{
+    pimpl_->refresh();
+    id_bitmap results;
+    for (auto iter = crate_ids.begin(); iter != crate_ids.end(); ++iter)
+    {
+        auto tracks = pimpl_->find(*iter);
+        if (!tracks)
+        {
+            return id_bitmap{};
+        }
+
+        if (iter == crate_ids.begin())
+        {
+            results = *tracks;
+        }
+        else
+        {
+            results &= *tracks;
+        }
+    }
+
+    return results;
+}
+
+id_bitmap crate_membership_index::tracks_in_any(
+    const std::vector<int64_t>& crate_ids) const
+{
+    pimpl_->refresh();
+    id_bitmap results;
+    for (auto crate_id : crate_ids)
+    {
+        auto tracks = pimpl_->find(crate_id);
+        if (tracks)
+        {
+            results |= *tracks;
+        }
+    }
+
+    return results;
+}
+
+crate_membership_index::crate_membership_index(
+    std::shared_ptr<crate_membership_index_impl> pimpl) :
+    pimpl_{std::move(pimpl)}
+{
+}
+
+}  // namespace djinterop
@@ -0,0 +1,102 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate_set_expr.hpp>
+
+namespace djinterop
+{
+struct crate_set_expr::node
+{
+    kind type;
+    int64_t crate_id;
+    bool include_descendants;
+
+    /// Operands of a union, intersection, or difference node
+    std::vector<crate_set_expr> operands;
+};
+
+crate_set_expr crate_set_expr::of(int64_t crate_id, bool include_descendants)
+{
+    return crate_set_expr{std::make_shared<const node>(
+        node{kind::crate, crate_id, include_descendants, {}})};
+}
+
+crate_set_expr::kind crate_set_expr::type() const noexcept
+{
+    return node_->type;
+}
+
+int64_t crate_set_expr::crate_id() const noexcept
+{
+    return node_->crate_id;
+}
+
+bool crate_set_expr::include_descendants() const noexcept
+{
+    return node_->include_descendants;
+}
+
+const crate_set_expr& crate_set_expr::left() const
+{
+    if (node_->operands.empty())
+    {
+        throw std::logic_error{"A crate expression has no operands"};
+    }
+
+    return node_->operands[0];
+}
+
+const crate_set_expr& crate_set_expr::right() const
+{
+    if (node_->operands.empty())
+    {
+        throw std::logic_error{"A crate expression has no operands"};
+    }
+
+    return node_->operands[1];
+}
+
+crate_set_expr::crate_set_expr(std::shared_ptr<const node> node) noexcept :
+    node_{std::move(node)}
+{
+}
+
+crate_set_expr operator|(const crate_set_expr& a, const crate_set_expr& b)
+{
+    return crate_set_expr{std::make_shared<const crate_set_expr::node>(
+        crate_set_expr::node{crate_set_expr::kind::unite, 0, false, {a, b}})};
+}
+
+crate_set_expr operator&(const crate_set_expr& a, const crate_set_expr& b)
+{
+    return crate_set_expr{std::make_shared<const crate_set_expr::node>(
+        crate_set_expr::node{
+            crate_set_expr::kind::intersect, 0, false, {a, b}})};
+}
+
+crate_set_expr operator-(const crate_set_expr& a, const crate_set_expr& b)
+{
+    return crate_set_expr{std::make_shared<const crate_set_expr::node>(
+        crate_set_expr::node{
+            crate_set_expr::kind::subtract, 0, false, {a, b}})};
+}
+
+}  // namespace djinterop
@@ -0,0 +1,164 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate_tree.hpp>
+#include <djinterop/impl/database_impl.hpp>
+
+namespace djinterop
+{
+const crate_tree_node* crate_tree::find(int64_t id) const
+{
+    auto iter = index_by_id_.find(id);
+    return iter != index_by_id_.end() ? &nodes_[iter->second] : nullptr;
+}
+
+const crate_tree_node* crate_tree::find_child(
+    stdx::optional<int64_t> parent_id, const std::string& name) const
+{
+    if (!parent_id)
+    {
+        auto iter = root_index_by_name_.find(name);
+        return iter != root_index_by_name_.end() ? &nodes_[iter->second]
+                                                 : nullptr;
+    }
+
+    auto iter = child_index_by_name_.find(std::make_pair(*parent_id, name));
+    return iter != child_index_by_name_.end() ? &nodes_[iter->second]
+                                              : nullptr;
+}
+
+std::vector<int64_t> crate_tree::descendant_ids(int64_t id) const
+{
+    std::vector<int64_t> results;
+    auto node = find(id);
+    if (!node)
+    {
+        return results;
+    }
+
+    // Iterative depth-first traversal, visiting children in ascending order.
+    // The number of nodes visited is bounded, so as to guard against cycles
+    // in an inconsistent database.
+    std::vector<const crate_tree_node*> stack{node};
+    while (!stack.empty() && results.size() < nodes_.size())
+    {
+        auto current = stack.back();
+        stack.pop_back();
+        if (current != node)
+        {
+            results.push_back(current->id);
+        }
+
+        for (auto iter = current->child_ids.rbegin();
+             iter != current->child_ids.rend(); ++iter)
+        {
+            stack.push_back(&nodes_[index_by_id_.at(*iter)]);
+        }
+    }
+
+    return results;
+}
+
+const std::vector<crate_tree_node>& crate_tree::nodes() const noexcept
+{
+    return nodes_;
+}
+
+bool crate_tree::refresh()
+{
+    if (pimpl_->crates_version() == version_)
+    {
+        return false;
+    }
+
+    load();
+    return true;
+}
+
+const std::vector<int64_t>& crate_tree::root_ids() const noexcept
+{
+    return root_ids_;
+}
+
+size_t crate_tree::child_key_hash::operator()(
+    const std::pair<int64_t, std::string>& key) const noexcept
+{
+    auto h1 = std::hash<int64_t>{}(key.first);
+    auto h2 = std::hash<std::string>{}(key.second);
+    return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+}
+
+crate_tree::crate_tree(std::shared_ptr<database_impl> pimpl) :
+    pimpl_{std::move(pimpl)}
+{
+    load();
+}
+
+void crate_tree::load()
+{
+    // The version is obtained before the nodes, so that any concurrent change
+    // will be picked up by the next refresh.  The snapshot is only replaced
+    // once it has been built in full, so that it is left unchanged, and will
+    // be reloaded by the next refresh, if loading fails.
+    auto version = pimpl_->crates_version();
+    auto nodes = pimpl_->crate_tree_nodes();
+
+    std::vector<int64_t> root_ids;
+    decltype(index_by_id_) index_by_id;
+    decltype(root_index_by_name_) root_index_by_name;
+    decltype(child_index_by_name_) child_index_by_name;
+    index_by_id.reserve(nodes.size());
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        index_by_id.emplace(nodes[i].id, i);
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto& node = nodes[i];
+        auto parent_iter = node.parent_id ? index_by_id.find(*node.parent_id)
+                                          : index_by_id.end();
+        if (parent_iter == index_by_id.end())
+        {
+            // A crate whose parent does not exist is treated as a root crate.
+            node.parent_id = stdx::nullopt;
+            root_ids.push_back(node.id);
+            root_index_by_name.emplace(node.name, i);
+        }
+        else
+        {
+            nodes[parent_iter->second].child_ids.push_back(node.id);
+            child_index_by_name.emplace(
+                std::make_pair(*node.parent_id, node.name), i);
+        }
+    }
+
+    version_ = version;
+    nodes_ = std::move(nodes);
+    root_ids_ = std::move(root_ids);
+    index_by_id_ = std::move(index_by_id);
+    root_index_by_name_ = std::move(root_index_by_name);
+    child_index_by_name_ = std::move(child_index_by_name);
+}
+
+}  // namespace djinterop
@@ -17,10 +17,15 @@
 
 #include <sqlite_modern_cpp.h>
 
+#include <djinterop/crate_membership_index.hpp>
+#include <djinterop/crate_set_expr.hpp>
+#include <djinterop/crate_tree.hpp>
 #include <djinterop/djinterop.hpp>
 #include <djinterop/enginelibrary/el_database_impl.hpp>
+#include <djinterop/impl/library_snapshot_impl.hpp>
 #include <djinterop/enginelibrary/schema/schema.hpp>
 #include <djinterop/impl/database_impl.hpp>
+#include <djinterop/impl/library_watcher_impl.hpp>
 #include <djinterop/transaction_guard.hpp>
 #include <djinterop/util.hpp>
 
@@ -32,11 +37,29 @@ database::~database() = default;
 
 database& database::operator=(const database& db) = default;
 
+std::vector<autocomplete_suggestion> database::autocomplete(
+    autocomplete_field field, const std::string& prefix, size_t limit) const
+{
+    return pimpl_->autocomplete(field, prefix, limit);
+}
+
 transaction_guard database::begin_transaction() const
 {
     return pimpl_->begin_transaction();
 }
 
+content_hash_result database::compute_content_hashes(
+    const content_hash_options& options) const
+{
+    return pimpl_->compute_content_hashes(options);
+}
+
+std::vector<track> database::copy_tracks(
+    const database& source, const std::vector<track>& tracks) const
+{
+    return pimpl_->copy_tracks(source, tracks);
+}
+
 stdx::optional<crate> database::crate_by_id(int64_t id) const
 {
     return pimpl_->crate_by_id(id);
@@ -67,11 +90,72 @@ std::string database::directory() const
     return pimpl_->directory();
 }
 
+std::vector<std::vector<track>> database::duplicate_tracks_by_content() const
+{
+    return pimpl_->duplicate_tracks_by_content();
+}
+
+std::vector<track> database::harmonic_candidates(
+    double bpm, musical_key key, double bpm_tolerance) const
+{
+    return pimpl_->harmonic_candidates(bpm, key, bpm_tolerance);
+}
+
 bool database::is_supported() const
 {
     return pimpl_->is_supported();
 }
 
+crate_tree database::load_crate_tree() const
+{
+    return crate_tree{pimpl_};
+}
+
+crate_membership_index database::load_crate_membership_index() const
+{
+    return crate_membership_index{pimpl_->load_crate_membership_index()};
+}
+
+track_page database::list_tracks(
+    const track_query& query, size_t page_size,
+    const stdx::optional<std::string>& continuation_token) const
+{
+    return pimpl_->list_tracks(query, page_size, continuation_token);
+}
+
+library_snapshot database::load_library_snapshot(bool include_track_data) const
+{
+    return library_snapshot{pimpl_->load_library_snapshot(include_track_data)};
+}
+
+track_cursor database::query_tracks(const track_query& query) const
+{
+    return track_cursor{pimpl_->query_tracks(query)};
+}
+
+int64_t database::relocate_tracks(
+    const std::string& old_prefix, const std::string& new_prefix) const
+{
+    return pimpl_->relocate_tracks(old_prefix, new_prefix);
+}
+
+file_scan_summary database::scan_files(const file_scan_options& options) const
+{
+    return pimpl_->scan_files(options);
+}
+
+void database::set_track_row_cache_policy(track_row_cache_policy policy) const
+{
+    pimpl_->set_track_row_cache_policy(policy);
+}
+
+library_watcher database::watch_library(
+    const library_watcher_options& options) const
+{
+    return library_watcher{std::make_shared<library_watcher_impl>(
+        *this, pimpl_->track_directories(), options)};
+}
+
 void database::verify() const
 {
     pimpl_->verify();
@@ -82,16 +166,45 @@ void database::remove_crate(crate cr) const
     pimpl_->remove_crate(cr);
 }
 
+void database::remove_crates(
+    const std::vector<int64_t>& crate_ids, bool recursive) const
+{
+    pimpl_->remove_crates(crate_ids, recursive);
+}
+
 void database::remove_track(track tr) const
 {
     pimpl_->remove_track(tr);
 }
 
+void database::remove_tracks(const std::vector<int64_t>& track_ids) const
+{
+    pimpl_->remove_tracks(track_ids);
+}
+
 std::vector<crate> database::root_crates() const
 {
     return pimpl_->root_crates();
 }
 
+std::vector<track> database::search_tracks(
+    const std::string& query, size_t limit) const
+{
+    return pimpl_->search_tracks(query, limit);
+}
+
+std::vector<similar_track_group> database::similar_tracks(
+    const similar_tracks_options& options) const
+{
+    return pimpl_->similar_tracks(options);
+}
+
+library_sync_report database::sync_library(
+    const database& other, const library_sync_options& options) const
+{
+    return pimpl_->sync_library(*other.pimpl_, options);
+}
+
 stdx::optional<crate> database::root_crate_by_name(
     const std::string& name) const
 {
@@ -103,17 +216,34 @@ stdx::optional<track> database::track_by_id(int64_t id) const
     return pimpl_->track_by_id(id);
 }
 
+std::vector<stdx::optional<track>> database::tracks_by_ids(
+    const std::vector<int64_t>& ids) const
+{
+    return pimpl_->tracks_by_ids(ids);
+}
+
 std::vector<track> database::tracks() const
 {
     return pimpl_->tracks();
 }
 
+track_cursor database::tracks_in_crates(const crate_set_expr& expr) const
+{
+    return track_cursor{pimpl_->tracks_in_crates(expr)};
+}
+
 std::vector<track> database::tracks_by_relative_path(
     const std::string& relative_path) const
 {
     return pimpl_->tracks_by_relative_path(relative_path);
 }
 
+std::vector<std::vector<track>> database::tracks_by_relative_paths(
+    const std::vector<std::string>& relative_paths) const
+{
+    return pimpl_->tracks_by_relative_paths(relative_paths);
+}
+
 std::string database::uuid() const
 {
     return pimpl_->uuid();
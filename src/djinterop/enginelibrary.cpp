@@ -21,6 +21,7 @@
 
 #include <djinterop/djinterop.hpp>
 #include "enginelibrary/el_database_impl.hpp"
+#include "enginelibrary/el_library_snapshot_cache.hpp"
 #include "enginelibrary/el_transaction_guard_impl.hpp"
 #include "enginelibrary/schema/schema.hpp"
 #include "util.hpp"
@@ -94,6 +95,46 @@ bool database_exists(const std::string& directory)
     return true;
 }
 
+std::string library_snapshot_cache_path(const std::string& directory)
+{
+    return directory + "/library_snapshot.cache";
+}
+
+stdx::optional<library_snapshot> load_cached_library_snapshot(
+    const std::string& directory, bool& stale)
+{
+    // The database is not opened, and so its UUID is not compared; the UUID
+    // recorded in the cache is taken to be current.
+    library_snapshot_cache_stamp cached_stamp;
+    auto snapshot = read_library_snapshot_cache(
+        library_snapshot_cache_path(directory), cached_stamp);
+    if (snapshot)
+    {
+        stale = !(
+            cached_stamp == current_library_snapshot_cache_stamp(
+                                cached_stamp.uuid, directory + "/m.db"));
+    }
+
+    return snapshot;
+}
+
+std::future<library_snapshot> rebuild_library_snapshot_cache(
+    const std::string& directory)
+{
+    return std::async(std::launch::async, [directory] {
+        auto db = load_database(directory);
+
+        // The stamp is taken before scanning, so that any change made during
+        // the scan causes the cache to be considered stale.
+        auto stamp =
+            current_library_snapshot_cache_stamp(db.uuid(), music_db_path(db));
+        auto snapshot = db.load_library_snapshot();
+        write_library_snapshot_cache(
+            library_snapshot_cache_path(directory), stamp, snapshot);
+        return snapshot;
+    });
+}
+
 database load_database(const std::string& directory)
 {
     auto storage = std::make_shared<el_storage>(directory);
@@ -0,0 +1,265 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <tuple>
+
+#include <djinterop/enginelibrary/el_autocomplete_index.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/text_folding.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// Metadata type of each field, in the order of `autocomplete_field`.
+constexpr std::array<metadata_str_type, 4> field_types{
+    metadata_str_type::album, metadata_str_type::artist,
+    metadata_str_type::genre, metadata_str_type::publisher};
+
+stdx::optional<size_t> field_of(metadata_str_type type)
+{
+    auto iter = std::find(field_types.begin(), field_types.end(), type);
+    if (iter == field_types.end())
+    {
+        return stdx::nullopt;
+    }
+
+    return static_cast<size_t>(iter - field_types.begin());
+}
+
+}  // namespace
+
+el_autocomplete_index::el_autocomplete_index(el_storage& storage) :
+    storage_{storage}
+{
+}
+
+int64_t el_autocomplete_index::change_count() const
+{
+    return storage_.change_count("MetaData");
+}
+
+void el_autocomplete_index::apply(
+    int64_t change_count_before, int64_t track_id,
+    const std::vector<
+        std::pair<metadata_str_type, stdx::optional<std::string> > >& changes)
+{
+    if (!loaded_ || change_count_before != change_count_)
+    {
+        return;
+    }
+
+    for (auto&& change : changes)
+    {
+        auto field = field_of(change.first);
+        if (!field)
+        {
+            continue;
+        }
+
+        auto& value_by_track = value_by_track_[*field];
+        auto iter = value_by_track.find(track_id);
+        auto text = change.second ? *change.second : std::string{};
+        if (iter != value_by_track.end())
+        {
+            if (iter->second == text)
+            {
+                continue;
+            }
+
+            remove_usage(*field, iter->second);
+            value_by_track.erase(iter);
+        }
+
+        if (!text.empty())
+        {
+            add_usage(*field, text);
+            value_by_track.emplace(track_id, std::move(text));
+        }
+    }
+
+    change_count_ = change_count();
+}
+
+void el_autocomplete_index::apply_removal(
+    int64_t change_count_before, const std::vector<int64_t>& track_ids)
+{
+    if (!loaded_ || change_count_before != change_count_)
+    {
+        return;
+    }
+
+    for (size_t field = 0; field < field_count; ++field)
+    {
+        for (auto track_id : track_ids)
+        {
+            auto iter = value_by_track_[field].find(track_id);
+            if (iter != value_by_track_[field].end())
+            {
+                remove_usage(field, iter->second);
+                value_by_track_[field].erase(iter);
+            }
+        }
+    }
+
+    change_count_ = change_count();
+}
+
+std::vector<autocomplete_suggestion> el_autocomplete_index::complete(
+    autocomplete_field field, const std::string& prefix, size_t limit)
+{
+    refresh();
+
+    // A trailing space is significant whilst typing, as it ends a word.
+    auto key = fold_text(prefix);
+    if (!key.empty() && prefix.back() == ' ')
+    {
+        key += ' ';
+    }
+
+    // No folded text contains the byte 0xFF, and so all keys starting with
+    // the prefix sort before the prefix followed by it.
+    auto& values = values_[static_cast<size_t>(field)];
+    auto by_key = [](const value_entry& entry, const std::string& key) {
+        return entry.key < key;
+    };
+    auto first = std::lower_bound(values.begin(), values.end(), key, by_key);
+    auto last = std::lower_bound(first, values.end(), key + '\xFF', by_key);
+
+    std::vector<const value_entry*> matches;
+    matches.reserve(last - first);
+    for (auto iter = first; iter != last; ++iter)
+    {
+        matches.push_back(&*iter);
+    }
+
+    auto count = std::min(limit, matches.size());
+    std::partial_sort(
+        matches.begin(), matches.begin() + count, matches.end(),
+        [](const value_entry* a, const value_entry* b) {
+            // Ties are broken by the order of the table, being sorted order.
+            return a->usage_count != b->usage_count
+                       ? a->usage_count > b->usage_count
+                       : a < b;
+        });
+
+    std::vector<autocomplete_suggestion> results;
+    results.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        results.push_back(
+            autocomplete_suggestion{matches[i]->text, matches[i]->usage_count});
+    }
+
+    return results;
+}
+
+void el_autocomplete_index::add_usage(size_t field, const std::string& text)
+{
+    auto key = fold_text(text);
+    auto& values = values_[field];
+    auto iter = std::lower_bound(
+        values.begin(), values.end(), std::tie(key, text),
+        [](const value_entry& entry,
+           const std::tuple<const std::string&, const std::string&>& value) {
+            return std::tie(entry.key, entry.text) < value;
+        });
+    if (iter != values.end() && iter->key == key && iter->text == text)
+    {
+        ++iter->usage_count;
+    }
+    else
+    {
+        values.insert(iter, value_entry{std::move(key), text, 1});
+    }
+}
+
+void el_autocomplete_index::load()
+{
+    change_count_ = change_count();
+    data_version_ = storage_.music_data_version();
+    loaded_ = true;
+
+    for (auto& value_by_track : value_by_track_)
+    {
+        value_by_track.clear();
+    }
+
+    storage_.db << "SELECT id, type, text FROM MetaData WHERE type IN "
+                   "(2, 3, 4, 6) AND text IS NOT NULL AND text != ''" >>
+        [&](int64_t id, int64_t type, std::string text) {
+            auto field = field_of(static_cast<metadata_str_type>(type));
+            value_by_track_[*field].emplace(id, std::move(text));
+        };
+
+    for (size_t field = 0; field < field_count; ++field)
+    {
+        std::unordered_map<std::string, int64_t> usage_by_text;
+        for (auto&& entry : value_by_track_[field])
+        {
+            ++usage_by_text[entry.second];
+        }
+
+        auto& values = values_[field];
+        values.clear();
+        values.reserve(usage_by_text.size());
+        for (auto&& entry : usage_by_text)
+        {
+            values.push_back(
+                value_entry{fold_text(entry.first), entry.first, entry.second});
+        }
+
+        std::sort(
+            values.begin(), values.end(),
+            [](const value_entry& a, const value_entry& b) {
+                return std::tie(a.key, a.text) < std::tie(b.key, b.text);
+            });
+    }
+}
+
+void el_autocomplete_index::refresh()
+{
+    if (!loaded_ || change_count() != change_count_ ||
+        storage_.music_data_version() != data_version_)
+    {
+        load();
+    }
+}
+
+void el_autocomplete_index::remove_usage(size_t field, const std::string& text)
+{
+    auto key = fold_text(text);
+    auto& values = values_[field];
+    auto iter = std::lower_bound(
+        values.begin(), values.end(), std::tie(key, text),
+        [](const value_entry& entry,
+           const std::tuple<const std::string&, const std::string&>& value) {
+            return std::tie(entry.key, entry.text) < value;
+        });
+    if (iter != values.end() && iter->key == key && iter->text == text &&
+        --iter->usage_count == 0)
+    {
+        values.erase(iter);
+    }
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
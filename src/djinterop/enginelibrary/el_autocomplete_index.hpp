@@ -0,0 +1,100 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <djinterop/autocomplete.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// An in-memory index of the distinct values of the album, artist, genre, and
+/// publisher of all tracks, for autocompleting them.
+///
+/// The values of each field are held in a table sorted by their folded form,
+/// as given by `fold_text()`, so that the values completing a prefix occupy a
+/// contiguous range, found by binary search.
+class el_autocomplete_index
+{
+public:
+    el_autocomplete_index(el_storage& storage);
+
+    /// Get the counter of changes to track metadata made via the storage's
+    /// connection.
+    int64_t change_count() const;
+
+    /// Apply changes to the metadata strings of a track that were made via the
+    /// storage's connection.
+    ///
+    /// The changes are only applied if the index was up to date just before
+    /// they were made, as given by the change counter at that time.
+    /// Otherwise, the index will be reloaded upon its next use.
+    void apply(
+        int64_t change_count_before, int64_t track_id,
+        const std::vector<
+            std::pair<metadata_str_type, stdx::optional<std::string> > >&
+            changes);
+
+    /// Apply the removal of tracks that was made via the storage's connection.
+    void apply_removal(
+        int64_t change_count_before, const std::vector<int64_t>& track_ids);
+
+    /// Get at most `limit` distinct values of a field that start with a given
+    /// prefix, ignoring case and diacritics, in descending order of usage.
+    std::vector<autocomplete_suggestion> complete(
+        autocomplete_field field, const std::string& prefix, size_t limit);
+
+private:
+    static constexpr size_t field_count = 4;
+
+    struct value_entry
+    {
+        std::string key;
+        std::string text;
+        int64_t usage_count;
+    };
+
+    void add_usage(size_t field, const std::string& text);
+    void load();
+    void refresh();
+    void remove_usage(size_t field, const std::string& text);
+
+    el_storage& storage_;
+    bool loaded_ = false;
+    int64_t change_count_ = 0;
+    int64_t data_version_ = 0;
+    std::array<std::vector<value_entry>, field_count> values_;
+    std::array<std::unordered_map<int64_t, std::string>, field_count>
+        value_by_track_;
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,192 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+#include <djinterop/content_hasher.hpp>
+#include <djinterop/enginelibrary/el_content_hash.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/parallel.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+struct file_closer
+{
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+
+/// Hash the content of a file, reading it in chunks the size of the given
+/// buffer, or return `nullopt` if it cannot be read.
+stdx::optional<uint64_t> hash_file(
+    const std::string& path, std::vector<char>& buffer)
+{
+    std::unique_ptr<std::FILE, file_closer> file{
+        std::fopen(path.c_str(), "rb")};
+    if (!file)
+    {
+        return stdx::nullopt;
+    }
+
+    // Reads are already large, and so are not buffered a second time.
+    std::setvbuf(file.get(), nullptr, _IONBF, 0);
+#if defined(__linux__)
+    posix_fadvise(fileno(file.get()), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    content_hasher hasher;
+    size_t size;
+    while ((size = std::fread(buffer.data(), 1, buffer.size(), file.get())) >
+           0)
+    {
+        hasher.update(buffer.data(), size);
+    }
+
+    if (std::ferror(file.get()))
+    {
+        return stdx::nullopt;
+    }
+
+    return hasher.digest();
+}
+
+}  // namespace
+
+content_hash_result compute_content_hashes(
+    const std::shared_ptr<el_storage>& storage,
+    const content_hash_options& options)
+{
+    if (options.max_concurrent_reads == 0 || options.read_size == 0)
+    {
+        throw std::invalid_argument{
+            "Concurrent reads and read size must be positive"};
+    }
+
+    std::vector<std::pair<int64_t, std::string> > files;
+    std::string sql = "SELECT id, path FROM Track";
+    if (!options.rehash)
+    {
+        sql +=
+            " WHERE NOT EXISTS (SELECT 1 FROM MetaDataInteger m "
+            "WHERE m.id = Track.id AND m.type = ? AND m.value IS NOT NULL)";
+    }
+
+    sql += " ORDER BY id";
+    auto query = storage->db << sql;
+    if (!options.rehash)
+    {
+        query << static_cast<int64_t>(metadata_int_type::hash);
+    }
+
+    query >> [&](int64_t id, std::string path) {
+        files.emplace_back(id, storage->directory + "/" + path);
+    };
+
+    std::vector<stdx::optional<uint64_t> > hashes(files.size());
+    auto thread_count = std::min(options.max_concurrent_reads, files.size());
+    std::vector<std::vector<char> > buffers(
+        thread_count, std::vector<char>(options.read_size));
+    for_each_in_parallel(
+        files.size(), thread_count, [&](size_t index, size_t thread) {
+            hashes[index] = hash_file(files[index].second, buffers[thread]);
+        });
+
+    content_hash_result result;
+    el_transaction_guard_impl trans{storage};
+    auto inserter =
+        storage->db
+        << "REPLACE INTO MetaDataInteger (id, type, value) VALUES (?, ?, ?)";
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        auto id = files[i].first;
+        if (!hashes[i])
+        {
+            result.unreadable_track_ids.push_back(id);
+            continue;
+        }
+
+        // The hash is stored as a signed integer with the same bits.
+        stdx::optional<int64_t> value = static_cast<int64_t>(*hashes[i]);
+        auto change_count = storage->change_count("MetaDataInteger");
+        inserter << id << static_cast<int64_t>(metadata_int_type::hash)
+                 << value;
+        inserter++;
+        storage->apply_metadata_int_changes(
+            change_count, id, {{metadata_int_type::hash, value}});
+        ++result.hashed_count;
+    }
+
+    trans.commit();
+    return result;
+}
+
+std::vector<std::vector<int64_t> > find_content_duplicates(
+    el_storage& storage)
+{
+    // Reading all hashes once and grouping them here is several times faster
+    // than probing `index_MetaDataInteger_value` for each hash, as each probe
+    // must then visit the table to check the type of each row.
+    std::vector<std::pair<int64_t, int64_t> > hashes;
+    storage.db << "SELECT value, id FROM MetaDataInteger "
+                  "WHERE type = ? AND value IS NOT NULL"
+               << static_cast<int64_t>(metadata_int_type::hash) >>
+        [&](int64_t hash, int64_t id) { hashes.emplace_back(hash, id); };
+
+    std::sort(hashes.begin(), hashes.end());
+
+    std::vector<std::vector<int64_t> > groups;
+    for (auto begin = hashes.begin(); begin != hashes.end();)
+    {
+        auto end = std::find_if(
+            begin, hashes.end(),
+            [&](const std::pair<int64_t, int64_t>& entry) {
+                return entry.first != begin->first;
+            });
+        if (end - begin > 1)
+        {
+            auto& group = groups.emplace_back();
+            for (auto iter = begin; iter != end; ++iter)
+            {
+                group.push_back(iter->second);
+            }
+        }
+
+        begin = end;
+    }
+
+    return groups;
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
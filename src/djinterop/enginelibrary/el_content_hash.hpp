@@ -0,0 +1,52 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <djinterop/content_hash.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// Hash the content of the music files of tracks, and store each hash as the
+/// `hash` metadata integer of its track.
+///
+/// Files are hashed on a number of worker threads, bounded by the maximum
+/// number of concurrent reads, with each thread reading one file at a time
+/// from start to end.  Hashes are written on the calling thread in a single
+/// transaction once all files have been read.
+content_hash_result compute_content_hashes(
+    const std::shared_ptr<el_storage>& storage,
+    const content_hash_options& options);
+
+/// Find groups of two or more tracks having the same content hash.
+///
+/// Groups are returned in ascending order of hash, and the IDs within each
+/// group in ascending order.
+std::vector<std::vector<int64_t> > find_content_duplicates(
+    el_storage& storage);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
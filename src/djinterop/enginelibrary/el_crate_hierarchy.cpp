@@ -0,0 +1,199 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/enginelibrary/el_crate_hierarchy.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_temporary_keys.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// Returns an SQL expression selecting all keys of a temporary table.
+std::string select_keys(const el_temporary_keys& keys)
+{
+    return "(SELECT key FROM " + keys.table() + ")";
+}
+
+}  // namespace
+
+void add_crate_descendants(el_storage& storage, el_temporary_keys& crate_ids)
+{
+    auto ids = select_keys(crate_ids);
+    storage.db << ("INSERT INTO " + crate_ids.table() +
+                   " (key) SELECT DISTINCT crateIdChild FROM CrateHierarchy "
+                   "WHERE crateId IN " + ids + " AND crateIdChild NOT IN " +
+                   ids);
+}
+
+void detach_crate_children(
+    el_storage& storage, const el_temporary_keys& crate_ids)
+{
+    auto ids = select_keys(crate_ids);
+
+    // Determine the crates that are about to lose their parent, along with
+    // their current paths.
+    el_temporary_keys orphans{
+        storage.shared_from_this(), std::vector<int64_t>{}};
+    auto orphan_ids = select_keys(orphans);
+    storage.db << ("INSERT INTO " + orphans.table() +
+                   " (key, value) SELECT c.id, c.path FROM Crate AS c "
+                   "JOIN CrateParentList AS p ON p.crateOriginId = c.id "
+                   "WHERE p.crateParentId IN " + ids + " AND c.id NOT IN " +
+                   ids + " AND p.crateOriginId <> p.crateParentId");
+
+    // Rewrite the path of each orphan and of each of its descendants, by
+    // replacing the former path of the orphan with just its own name.  Where
+    // orphans are nested within one another, the deepest one is the new root.
+    bool is_list = storage.version >= version_1_9_1;
+    std::string table = is_list ? "List" : "Crate";
+    std::string filter = is_list ? "type = 4 AND " : "";
+    storage.db << ("UPDATE " + table +
+                   " SET path = (SELECT c.title || ';' || substr(" + table +
+                   ".path, length(k.value) + 1) FROM " + orphans.table() +
+                   " AS k JOIN Crate AS c ON c.id = k.key WHERE k.key = " +
+                   table +
+                   ".id OR k.key IN (SELECT crateId FROM CrateHierarchy "
+                   "WHERE crateIdChild = " + table +
+                   ".id) ORDER BY length(k.value) DESC LIMIT 1) WHERE " +
+                   filter + "id IN (SELECT key FROM " + orphans.table() +
+                   " UNION SELECT crateIdChild FROM CrateHierarchy "
+                   "WHERE crateId IN " + orphan_ids + ")");
+
+    // Remove the links between each orphan's former ancestors and the orphan
+    // itself or any of its descendants.
+    if (is_list)
+    {
+        storage.db << ("DELETE FROM ListHierarchy WHERE listType = 4 AND "
+                       "listTypeChild = 4 AND EXISTS (SELECT 1 FROM " +
+                       orphans.table() +
+                       " AS k JOIN CrateHierarchy AS a ON a.crateIdChild = "
+                       "k.key WHERE a.crateId = ListHierarchy.listId AND "
+                       "(ListHierarchy.listIdChild = k.key OR "
+                       "ListHierarchy.listIdChild IN (SELECT crateIdChild "
+                       "FROM CrateHierarchy WHERE crateId = k.key)))");
+        storage.db << ("UPDATE ListParentList SET listParentId = "
+                       "listOriginId, listParentType = listOriginType "
+                       "WHERE listOriginType = 4 AND listOriginId IN " +
+                       orphan_ids);
+    }
+    else
+    {
+        storage.db << ("DELETE FROM CrateHierarchy WHERE EXISTS (SELECT 1 "
+                       "FROM " + orphans.table() +
+                       " AS k JOIN CrateHierarchy AS a ON a.crateIdChild = "
+                       "k.key WHERE a.crateId = CrateHierarchy.crateId AND "
+                       "(CrateHierarchy.crateIdChild = k.key OR "
+                       "CrateHierarchy.crateIdChild IN (SELECT crateIdChild "
+                       "FROM CrateHierarchy AS d WHERE d.crateId = k.key)))");
+        storage.db << ("UPDATE CrateParentList SET crateParentId = "
+                       "crateOriginId WHERE crateOriginId IN " + orphan_ids);
+    }
+}
+
+void move_crate_subtree(
+    el_storage& storage, int64_t crate_id, stdx::optional<int64_t> parent_id)
+{
+    // The subtree consists of the crate itself and all of its descendants,
+    // and its former ancestors are exactly the ancestors of the crate itself.
+    std::string subtree =
+        "(SELECT ? AS id UNION SELECT crateIdChild FROM CrateHierarchy "
+        "WHERE crateId = ?)";
+    std::string ancestors =
+        "(SELECT crateId FROM CrateHierarchy WHERE crateIdChild = ?)";
+    std::string new_ancestors =
+        "(SELECT ? AS id UNION SELECT crateId FROM CrateHierarchy "
+        "WHERE crateIdChild = ?)";
+
+    if (storage.version >= version_1_9_1)
+    {
+        storage.db << ("DELETE FROM ListHierarchy WHERE listType = 4 AND "
+                       "listTypeChild = 4 AND listIdChild IN " + subtree +
+                       " AND listId IN " + ancestors)
+                   << crate_id << crate_id << crate_id;
+        if (parent_id)
+        {
+            storage.db << ("INSERT INTO ListHierarchy (listId, listType, "
+                           "listIdChild, listTypeChild) SELECT a.id, 4, "
+                           "s.id, 4 FROM " + new_ancestors + " AS a, " +
+                           subtree + " AS s")
+                       << *parent_id << *parent_id << crate_id << crate_id;
+        }
+    }
+    else
+    {
+        storage.db << ("DELETE FROM CrateHierarchy WHERE crateIdChild IN " +
+                       subtree + " AND crateId IN " + ancestors)
+                   << crate_id << crate_id << crate_id;
+        if (parent_id)
+        {
+            storage.db << ("INSERT INTO CrateHierarchy (crateId, "
+                           "crateIdChild) SELECT a.id, s.id FROM " +
+                           new_ancestors + " AS a, " + subtree + " AS s")
+                       << *parent_id << *parent_id << crate_id << crate_id;
+        }
+    }
+}
+
+void replace_descendant_paths(
+    el_storage& storage, int64_t crate_id, const std::string& old_path,
+    const std::string& new_path)
+{
+    bool is_list = storage.version >= version_1_9_1;
+    std::string table = is_list ? "List" : "Crate";
+    std::string filter = is_list ? "type = 4 AND " : "";
+    storage.db << ("UPDATE " + table +
+                   " SET path = ? || substr(path, length(?) + 1) WHERE " +
+                   filter +
+                   "id IN (SELECT crateIdChild FROM CrateHierarchy WHERE "
+                   "crateId = ?) AND substr(path, 1, length(?)) = ?")
+               << new_path << old_path << crate_id << old_path << old_path;
+}
+
+void delete_crates(el_storage& storage, const el_temporary_keys& crate_ids)
+{
+    auto ids = select_keys(crate_ids);
+    if (storage.version >= version_1_9_1)
+    {
+        storage.db << ("DELETE FROM ListTrackList WHERE listType = 4 AND "
+                       "listId IN " + ids);
+        storage.db << ("DELETE FROM ListParentList WHERE listOriginType = 4 "
+                       "AND listOriginId IN " + ids);
+        storage.db << ("DELETE FROM ListHierarchy WHERE (listType = 4 AND "
+                       "listId IN " + ids + ") OR (listTypeChild = 4 AND "
+                       "listIdChild IN " + ids + ")");
+        storage.db << ("DELETE FROM List WHERE type = 4 AND id IN " + ids);
+    }
+    else
+    {
+        storage.db << ("DELETE FROM CrateTrackList WHERE crateId IN " + ids);
+        storage.db << ("DELETE FROM CrateParentList WHERE crateOriginId IN " +
+                       ids);
+        storage.db << ("DELETE FROM CrateHierarchy WHERE crateId IN " + ids +
+                       " OR crateIdChild IN " + ids);
+        storage.db << ("DELETE FROM Crate WHERE id IN " + ids);
+    }
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
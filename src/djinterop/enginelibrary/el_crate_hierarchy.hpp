@@ -0,0 +1,77 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+class el_temporary_keys;
+
+// The functions below operate on sets of crates at once, where each set is
+// given by the keys of a temporary table.  Crates are read via the `Crate*`
+// tables or views, but on schemas where those are views onto the `List*`
+// tables, writes go to the underlying tables directly, so as to avoid firing
+// a trigger for every affected row.
+
+/// Adds all descendants of the crates in a given set to the set.
+void add_crate_descendants(el_storage& storage, el_temporary_keys& crate_ids);
+
+/// Makes every crate whose parent is in a given set, but which is not itself
+/// in the set, into a root crate.
+///
+/// The `path` of each such crate and of all of its descendants is updated,
+/// and the links in the hierarchy between each such crate (and its
+/// descendants) and its former ancestors are removed.
+void detach_crate_children(
+    el_storage& storage, const el_temporary_keys& crate_ids);
+
+/// Moves a crate, along with all of its descendants, underneath a new parent
+/// crate in the flattened crate hierarchy, or to the root level if no parent
+/// is given.
+///
+/// The links between the crate (or its descendants) and its former ancestors
+/// are replaced by links to the new parent and its ancestors.  Neither the
+/// parent list nor any paths are modified, and the caller is responsible for
+/// ensuring that the new parent is not within the subtree.
+void move_crate_subtree(
+    el_storage& storage, int64_t crate_id, stdx::optional<int64_t> parent_id);
+
+/// Replaces the prefix `old_path` of the `path` of every descendant of a
+/// given crate with `new_path`.
+///
+/// The path of the crate itself is not modified.
+void replace_descendant_paths(
+    el_storage& storage, int64_t crate_id, const std::string& old_path,
+    const std::string& new_path);
+
+/// Deletes all crates in a given set, along with their track lists and their
+/// entries in the crate hierarchy.
+///
+/// Crates that are not in the set are not modified, and so any children of
+/// crates in the set should be detached or deleted as well.
+void delete_crates(el_storage& storage, const el_temporary_keys& crate_ids);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
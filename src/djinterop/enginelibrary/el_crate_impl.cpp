@@ -18,9 +18,12 @@
 #include <sqlite_modern_cpp.h>
 
 #include <djinterop/djinterop.hpp>
+#include <djinterop/enginelibrary/el_crate_hierarchy.hpp>
 #include <djinterop/enginelibrary/el_crate_impl.hpp>
+#include <djinterop/enginelibrary/el_crate_membership_index_impl.hpp>
 #include <djinterop/enginelibrary/el_database_impl.hpp>
 #include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_temporary_keys.hpp>
 #include <djinterop/enginelibrary/el_track_impl.hpp>
 #include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
 
@@ -54,18 +57,17 @@ using djinterop::track;
 //     relationship is not written to this table.
 namespace
 {
-void update_path(
-    sqlite::database& music_db, crate cr, const std::string& parent_path)
+void insert_missing_tracks(
+    sqlite::database& music_db, int64_t crate_id, const std::string& keys_table)
 {
-    // update path
-    std::string path = parent_path + cr.name() + ';';
-    music_db << "UPDATE Crate SET path = ? WHERE id = ?" << path << cr.id();
-
-    // recursive call in order to update the path of indirect descendants
-    for (crate cr2 : cr.children())
-    {
-        update_path(music_db, cr2, path);
-    }
+    // Tracks already in the crate keep their existing row, and duplicate keys
+    // are only inserted once.
+    music_db << ("INSERT INTO CrateTrackList (crateId, trackId) "
+                 "SELECT DISTINCT ?, k.key FROM " +
+                 keys_table +
+                 " k WHERE NOT EXISTS (SELECT 1 FROM CrateTrackList ctl "
+                 "WHERE ctl.crateId = ? AND ctl.trackId = k.key)")
+             << crate_id << crate_id;
 }
 
 void ensure_valid_name(const std::string& name)
@@ -92,6 +94,8 @@ el_crate_impl::el_crate_impl(std::shared_ptr<el_storage> storage, int64_t id) :
 void el_crate_impl::add_track(int64_t track_id)
 {
     el_transaction_guard_impl trans{storage_};
+    auto index = storage_->crate_membership_index.lock();
+    auto change_count = index ? index->change_count() : 0;
 
     storage_->db
         << "DELETE FROM CrateTrackList WHERE crateId = ? AND trackId = ?"
@@ -101,6 +105,11 @@ void el_crate_impl::add_track(int64_t track_id)
         << "INSERT INTO CrateTrackList (crateId, trackId) VALUES (?, ?)" << id()
         << track_id;
 
+    if (index)
+    {
+        index->apply(change_count, id(), {track_id}, {});
+    }
+
     trans.commit();
 }
 
@@ -109,6 +118,23 @@ void el_crate_impl::add_track(track tr)
     add_track(tr.id());
 }
 
+void el_crate_impl::add_tracks(const std::vector<int64_t>& track_ids)
+{
+    el_transaction_guard_impl trans{storage_};
+    auto index = storage_->crate_membership_index.lock();
+    auto change_count = index ? index->change_count() : 0;
+
+    el_temporary_keys keys{storage_, track_ids};
+    insert_missing_tracks(storage_->db, id(), keys.table());
+
+    if (index)
+    {
+        index->apply(change_count, id(), track_ids, {});
+    }
+
+    trans.commit();
+}
+
 std::vector<crate> el_crate_impl::children()
 {
     std::vector<crate> results;
@@ -116,7 +142,7 @@ std::vector<crate> el_crate_impl::children()
                  << id() >>
         [&](int64_t crate_id_child) {
             results.emplace_back(
-                std::make_shared<el_crate_impl>(storage_, crate_id_child));
+                storage_->make_crate_impl(crate_id_child));
         };
     return results;
 }
@@ -176,7 +202,7 @@ crate el_crate_impl::create_sub_crate(std::string name)
                     "SELECT ? AS crateId, ? AS crateIdChild"
                  << sub_id << id() << id() << sub_id;
 
-    crate cr{std::make_shared<el_crate_impl>(storage_, sub_id)};
+    crate cr{storage_->make_crate_impl(sub_id)};
 
     trans.commit();
 
@@ -197,7 +223,7 @@ std::vector<crate> el_crate_impl::descendants()
             << id() >>
         [&](int64_t descendant_id) {
             results.push_back(crate{
-                std::make_shared<el_crate_impl>(storage_, descendant_id)});
+                storage_->make_crate_impl(descendant_id)});
         };
     return results;
 }
@@ -253,7 +279,7 @@ stdx::optional<crate> el_crate_impl::parent()
             if (!parent)
             {
                 parent =
-                    crate{std::make_shared<el_crate_impl>(storage_, parent_id)};
+                    crate{storage_->make_crate_impl(parent_id)};
             }
             else
             {
@@ -266,9 +292,17 @@ stdx::optional<crate> el_crate_impl::parent()
 
 void el_crate_impl::remove_track(track tr)
 {
+    auto index = storage_->crate_membership_index.lock();
+    auto change_count = index ? index->change_count() : 0;
+
     storage_->db
         << "DELETE FROM CrateTrackList WHERE crateId = ? AND trackId = ?"
         << id() << tr.id();
+
+    if (index)
+    {
+        index->apply(change_count, id(), {}, {tr.id()});
+    }
 }
 
 void el_crate_impl::set_name(std::string name)
@@ -295,16 +329,22 @@ void el_crate_impl::set_name(std::string name)
             }
         };
 
+    // obtain own current `path`
+    stdx::optional<std::string> old_path;
+    storage_->db << "SELECT path FROM Crate WHERE id = ?" << id() >>
+        [&](std::string path) { old_path = std::move(path); };
+    if (!old_path)
+    {
+        throw crate_deleted{id()};
+    }
+
     // update name and path
     std::string path = std::move(parent_path) + name.data() + ';';
     storage_->db << "UPDATE Crate SET title = ?, path = ? WHERE id = ?"
                  << name.data() << path << id();
 
-    // call the lambda in order to update the path of direct children
-    for (crate cr : children())
-    {
-        update_path(storage_->db, cr, path);
-    }
+    // update the path of all descendants in one go
+    replace_descendant_paths(*storage_, id(), *old_path, path);
 
     trans.commit();
 }
@@ -313,6 +353,41 @@ void el_crate_impl::set_parent(stdx::optional<crate> parent)
 {
     el_transaction_guard_impl trans{storage_};
 
+    if (parent)
+    {
+        bool is_cycle = false;
+        storage_->db << "SELECT ? = ? OR EXISTS (SELECT 1 FROM CrateHierarchy "
+                        "WHERE crateId = ? AND crateIdChild = ?)"
+                     << id() << parent->id() << id() << parent->id() >>
+            is_cycle;
+        if (is_cycle)
+        {
+            throw crate_invalid_parent{
+                "Crate cannot be a descendant of itself", id(),
+                parent->id()};
+        }
+    }
+
+    // obtain own current `path` and the new parent's `path`
+    stdx::optional<std::string> old_path;
+    std::string title;
+    storage_->db << "SELECT title, path FROM Crate WHERE id = ?" << id() >>
+        [&](std::string title_val, std::string path_val) {
+            title = std::move(title_val);
+            old_path = std::move(path_val);
+        };
+    if (!old_path)
+    {
+        throw crate_deleted{id()};
+    }
+
+    std::string parent_path;
+    if (parent)
+    {
+        storage_->db << "SELECT path FROM Crate WHERE id = ?" << parent->id() >>
+            [&](std::string path_val) { parent_path = std::move(path_val); };
+    }
+
     storage_->db << "DELETE FROM CrateParentList WHERE crateOriginId = ?"
                  << id();
 
@@ -320,17 +395,33 @@ void el_crate_impl::set_parent(stdx::optional<crate> parent)
                     "crateParentId) VALUES (?, ?)"
                  << id() << (parent ? parent->id() : id());
 
-    storage_->db << "DELETE FROM CrateHierarchy WHERE crateIdChild = ?" << id();
-
+    stdx::optional<int64_t> parent_id;
     if (parent)
     {
-        storage_->db
-            << "INSERT INTO CrateHierarchy (crateId, crateIdChild) SELECT "
-               "crateId, ? FROM CrateHierarchy WHERE crateIdChild = ? UNION "
-               "SELECT ? AS crateId, ? AS crateIdChild"
-            << id() << parent->id() << parent->id() << id();
+        parent_id = parent->id();
     }
 
+    move_crate_subtree(*storage_, id(), parent_id);
+
+    // update path of this crate and all of its descendants
+    std::string path = parent_path + title + ';';
+    storage_->db << "UPDATE Crate SET path = ? WHERE id = ?" << path << id();
+    replace_descendant_paths(*storage_, id(), *old_path, path);
+
+    trans.commit();
+}
+
+void el_crate_impl::set_tracks(const std::vector<int64_t>& track_ids)
+{
+    el_transaction_guard_impl trans{storage_};
+    el_temporary_keys keys{storage_, track_ids};
+
+    storage_->db << ("DELETE FROM CrateTrackList WHERE crateId = ? AND "
+                     "trackId NOT IN (SELECT key FROM " +
+                     keys.table() + ")")
+                 << id();
+    insert_missing_tracks(storage_->db, id(), keys.table());
+
     trans.commit();
 }
 
@@ -344,7 +435,7 @@ stdx::optional<crate> el_crate_impl::sub_crate_by_name(const std::string& name)
                     "ORDER BY cr.id"
                  << name.data() << id() >>
         [&](int64_t id) {
-            cr = crate{std::make_shared<el_crate_impl>(storage_, id)};
+            cr = crate{storage_->make_crate_impl(id)};
         };
     return cr;
 }
@@ -356,7 +447,7 @@ std::vector<track> el_crate_impl::tracks()
                  << id() >>
         [&](int64_t track_id) {
             results.emplace_back(
-                std::make_shared<el_track_impl>(storage_, track_id));
+                storage_->make_track_impl(track_id));
         };
     return results;
 }
@@ -34,6 +34,7 @@ public:
 
     void add_track(int64_t track_id) override;
     void add_track(track tr) override;
+    void add_tracks(const std::vector<int64_t>& track_ids) override;
     std::vector<crate> children() override;
     void clear_tracks() override;
     crate create_sub_crate(std::string name) override;
@@ -45,6 +46,7 @@ public:
     void remove_track(track tr) override;
     void set_name(std::string name) override;
     void set_parent(stdx::optional<crate> parent) override;
+    void set_tracks(const std::vector<int64_t>& track_ids) override;
     stdx::optional<crate> sub_crate_by_name(const std::string& name) override;
     std::vector<track> tracks() override;
 
@@ -0,0 +1,107 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/enginelibrary/el_crate_membership_index_impl.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+el_crate_membership_index_impl::el_crate_membership_index_impl(
+    std::shared_ptr<el_storage> storage) :
+    storage_{std::move(storage)},
+    // Crate membership is held in a view onto `ListTrackList` in newer
+    // schemas, and so changes are recorded against the underlying table.
+    table_{storage_->version >= version_1_9_1 ? "ListTrackList"
+                                              : "CrateTrackList"}
+{
+    load();
+}
+
+const id_bitmap* el_crate_membership_index_impl::find(int64_t crate_id)
+{
+    auto iter = tracks_by_crate_.find(crate_id);
+    return iter != tracks_by_crate_.end() ? &iter->second : nullptr;
+}
+
+void el_crate_membership_index_impl::refresh()
+{
+    if (change_count() != change_count_ ||
+        storage_->music_data_version() != data_version_)
+    {
+        load();
+    }
+}
+
+int64_t el_crate_membership_index_impl::change_count() const
+{
+    return storage_->change_count(table_);
+}
+
+void el_crate_membership_index_impl::apply(
+    int64_t change_count_before, int64_t crate_id,
+    const std::vector<int64_t>& added_track_ids,
+    const std::vector<int64_t>& removed_track_ids)
+{
+    if (change_count_before != change_count_)
+    {
+        return;
+    }
+
+    auto& tracks = tracks_by_crate_[crate_id];
+    for (auto track_id : removed_track_ids)
+    {
+        tracks.remove(track_id);
+    }
+
+    for (auto track_id : added_track_ids)
+    {
+        tracks.add(track_id);
+    }
+
+    if (tracks.empty())
+    {
+        tracks_by_crate_.erase(crate_id);
+    }
+
+    change_count_ = change_count();
+}
+
+void el_crate_membership_index_impl::load()
+{
+    change_count_ = change_count();
+    data_version_ = storage_->music_data_version();
+
+    std::unordered_map<int64_t, std::vector<int64_t> > track_ids_by_crate;
+    storage_->db << "SELECT crateId, trackId FROM CrateTrackList" >>
+        [&](int64_t crate_id, int64_t track_id) {
+            track_ids_by_crate[crate_id].push_back(track_id);
+        };
+
+    tracks_by_crate_.clear();
+    for (auto&& entry : track_ids_by_crate)
+    {
+        tracks_by_crate_.emplace(entry.first, id_bitmap{std::move(entry.second)});
+    }
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
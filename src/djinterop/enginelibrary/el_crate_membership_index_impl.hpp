@@ -0,0 +1,68 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <djinterop/impl/crate_membership_index_impl.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+class el_crate_membership_index_impl : public crate_membership_index_impl
+{
+public:
+    el_crate_membership_index_impl(std::shared_ptr<el_storage> storage);
+
+    const id_bitmap* find(int64_t crate_id) override;
+    void refresh() override;
+
+    /// Get the counter of changes to crate membership made via the storage's
+    /// connection.
+    int64_t change_count() const;
+
+    /// Apply a change to the tracks of a crate that was made via the storage's
+    /// connection.
+    ///
+    /// The change is only applied if the index was up to date just before the
+    /// change was made, as given by the change counter at that time.
+    /// Otherwise, the index will be reloaded upon its next refresh.
+    void apply(
+        int64_t change_count_before, int64_t crate_id,
+        const std::vector<int64_t>& added_track_ids,
+        const std::vector<int64_t>& removed_track_ids);
+
+private:
+    void load();
+
+    std::shared_ptr<el_storage> storage_;
+    std::string table_;
+    int64_t change_count_ = 0;
+    int64_t data_version_ = 0;
+    std::unordered_map<int64_t, id_bitmap> tracks_by_crate_;
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
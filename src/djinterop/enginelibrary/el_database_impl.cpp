@@ -15,13 +15,33 @@
     along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
 #include <djinterop/djinterop.hpp>
+#include <djinterop/enginelibrary/el_autocomplete_index.hpp>
+#include <djinterop/enginelibrary/el_content_hash.hpp>
+#include <djinterop/enginelibrary/el_crate_hierarchy.hpp>
 #include <djinterop/enginelibrary/el_crate_impl.hpp>
+#include <djinterop/enginelibrary/el_crate_membership_index_impl.hpp>
 #include <djinterop/enginelibrary/el_database_impl.hpp>
+#include <djinterop/enginelibrary/el_file_scan.hpp>
+#include <djinterop/enginelibrary/el_harmonic_index.hpp>
+#include <djinterop/enginelibrary/el_library_sync.hpp>
+#include <djinterop/enginelibrary/el_similar_tracks.hpp>
 #include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_temporary_keys.hpp>
+#include <djinterop/enginelibrary/el_track_copy.hpp>
+#include <djinterop/enginelibrary/el_track_cursor_impl.hpp>
 #include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_track_query.hpp>
+#include <djinterop/enginelibrary/el_track_search_index.hpp>
 #include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/enginelibrary/performance_data_format.hpp>
 #include <djinterop/enginelibrary/schema/schema.hpp>
+#include <djinterop/impl/library_snapshot_impl.hpp>
+#include <djinterop/track_query.hpp>
 #include <djinterop/transaction_guard.hpp>
 #include <djinterop/util.hpp>
 
@@ -34,6 +54,37 @@ using djinterop::track;
 
 namespace
 {
+std::string compile_crate_set_expr(
+    const crate_set_expr& expr, std::vector<sql_parameter>& parameters)
+{
+    if (expr.type() == crate_set_expr::kind::crate)
+    {
+        parameters.emplace_back(expr.crate_id());
+        if (!expr.include_descendants())
+        {
+            return "SELECT trackId FROM CrateTrackList WHERE crateId = ?";
+        }
+
+        parameters.emplace_back(expr.crate_id());
+        return "SELECT trackId FROM CrateTrackList WHERE crateId = ? OR "
+               "crateId IN (SELECT crateIdChild FROM CrateHierarchy WHERE "
+               "crateId = ?)";
+    }
+
+    const char* op = expr.type() == crate_set_expr::kind::unite
+                         ? " UNION "
+                         : expr.type() == crate_set_expr::kind::intersect
+                               ? " INTERSECT "
+                               : " EXCEPT ";
+
+    // Compound operators in SQLite are left-associative and cannot be
+    // parenthesised, and so each operand is wrapped in a subquery instead.
+    auto left = compile_crate_set_expr(expr.left(), parameters);
+    auto right = compile_crate_set_expr(expr.right(), parameters);
+    return "SELECT trackId FROM (" + left + ")" + op +
+           "SELECT trackId FROM (" + right + ")";
+}
+
 void ensure_valid_crate_name(const std::string& name)
 {
     if (name == "")
@@ -55,12 +106,53 @@ el_database_impl::el_database_impl(std::shared_ptr<el_storage> storage) :
 {
 }
 
+std::vector<autocomplete_suggestion> el_database_impl::autocomplete(
+    autocomplete_field field, const std::string& prefix, size_t limit)
+{
+    if (!storage_->autocomplete_index)
+    {
+        storage_->autocomplete_index =
+            std::make_shared<el_autocomplete_index>(*storage_);
+    }
+
+    return storage_->autocomplete_index->complete(field, prefix, limit);
+}
+
 transaction_guard el_database_impl::begin_transaction()
 {
     return transaction_guard{
         std::make_unique<el_transaction_guard_impl>(storage_)};
 }
 
+content_hash_result el_database_impl::compute_content_hashes(
+    const content_hash_options& options)
+{
+    return enginelibrary::compute_content_hashes(storage_, options);
+}
+
+std::vector<track> el_database_impl::copy_tracks(
+    const database& source, const std::vector<track>& tracks)
+{
+    std::vector<int64_t> track_ids;
+    track_ids.reserve(tracks.size());
+    for (auto&& t : tracks)
+    {
+        track_ids.push_back(t.id());
+    }
+
+    auto copied_ids = enginelibrary::copy_tracks(
+        storage_, source.directory(), source.uuid(), track_ids);
+
+    std::vector<track> results;
+    results.reserve(copied_ids.size());
+    for (auto id : copied_ids)
+    {
+        results.push_back(track{storage_->make_track_impl(id)});
+    }
+
+    return results;
+}
+
 stdx::optional<crate> el_database_impl::crate_by_id(int64_t id)
 {
     stdx::optional<crate> cr;
@@ -68,7 +160,7 @@ stdx::optional<crate> el_database_impl::crate_by_id(int64_t id)
         [&](int64_t count) {
             if (count == 1)
             {
-                cr = crate{std::make_shared<el_crate_impl>(storage_, id)};
+                cr = crate{storage_->make_crate_impl(id)};
             }
             else if (count > 1)
             {
@@ -83,7 +175,7 @@ std::vector<crate> el_database_impl::crates()
 {
     std::vector<crate> results;
     storage_->db << "SELECT id FROM Crate ORDER BY id" >> [&](int64_t id) {
-        results.push_back(crate{std::make_shared<el_crate_impl>(storage_, id)});
+        results.push_back(crate{storage_->make_crate_impl(id)});
     };
     return results;
 }
@@ -95,11 +187,54 @@ std::vector<crate> el_database_impl::crates_by_name(const std::string& name)
                  << name.data() >>
         [&](int64_t id) {
             results.push_back(
-                crate{std::make_shared<el_crate_impl>(storage_, id)});
+                crate{storage_->make_crate_impl(id)});
         };
     return results;
 }
 
+std::vector<crate_tree_node> el_database_impl::crate_tree_nodes()
+{
+    std::vector<crate_tree_node> results;
+    storage_->db << "SELECT c.id, c.title, cpl.crateParentId FROM Crate c "
+                    "LEFT JOIN CrateParentList cpl ON cpl.crateOriginId = c.id "
+                    "ORDER BY c.id" >>
+        [&](int64_t id, std::string title,
+            stdx::optional<int64_t> parent_id) {
+            if (parent_id == id)
+            {
+                parent_id = stdx::nullopt;
+            }
+
+            if (!results.empty() && results.back().id == id)
+            {
+                throw crate_database_inconsistency{
+                    "More than one parent crate for the same crate", id};
+            }
+
+            results.push_back(
+                crate_tree_node{id, std::move(title), parent_id, {}});
+        };
+    return results;
+}
+
+int64_t el_database_impl::crates_version()
+{
+    // Changes made via this connection are counted by the storage, whereas
+    // the data version only changes upon commits by other connections.
+    auto tables = storage_->version >= version_1_9_1
+                      ? std::array<const char*, 3>{"List", "ListParentList",
+                                                   "ListHierarchy"}
+                      : std::array<const char*, 3>{"Crate", "CrateParentList",
+                                                   "CrateHierarchy"};
+    int64_t version = storage_->music_data_version();
+    for (auto&& table : tables)
+    {
+        version += storage_->change_count(table);
+    }
+
+    return version;
+}
+
 crate el_database_impl::create_root_crate(std::string name)
 {
     ensure_valid_crate_name(name);
@@ -129,7 +264,7 @@ crate el_database_impl::create_root_crate(std::string name)
                     "crateParentId) VALUES (?, ?)"
                  << id << id;
 
-    crate cr{std::make_shared<el_crate_impl>(storage_, id)};
+    crate cr{storage_->make_crate_impl(id)};
 
     trans.commit();
 
@@ -146,6 +281,7 @@ track el_database_impl::create_track(std::string relative_path)
     el_transaction_guard_impl trans{storage_};
 
     // Insert a new entry in the track table
+    auto track_change_count = storage_->change_count("Track");
     storage_->db << "INSERT INTO Track (path, filename, trackType, "
                     "isExternalTrack, idAlbumArt) VALUES (?,?,?,?,?)"
                  << relative_path.data()   //
@@ -161,7 +297,11 @@ track el_database_impl::create_track(std::string relative_path)
         storage_->db << "UPDATE Track SET pdbImportKey = 0 WHERE id = ?" << id;
     }
 
+    // The BPM of the new track is not set yet.
+    storage_->apply_track_row_changes(track_change_count, id, stdx::nullopt);
+
     {
+        auto change_count = storage_->change_count("MetaData");
         auto extension = get_file_extension(filename);
         auto metadata_str_inserter =
             storage_->db
@@ -191,9 +331,13 @@ track el_database_impl::create_track(std::string relative_path)
             metadata_str_inserter << id << type << text;
             metadata_str_inserter++;
         }
+
+        // None of the indexed metadata of the new track is set yet.
+        storage_->apply_metadata_str_changes(change_count, id, {});
     }
 
     {
+        auto change_count = storage_->change_count("MetaDataInteger");
         auto metadata_int_inserter = storage_->db
                                      << "REPLACE INTO MetaDataInteger (id, "
                                         "type, value) VALUES (?, ?, ?)";
@@ -211,9 +355,12 @@ track el_database_impl::create_track(std::string relative_path)
             metadata_int_inserter << id << type << value;
             metadata_int_inserter++;
         }
+
+        // The key of the new track is not set yet.
+        storage_->apply_metadata_int_changes(change_count, id, {});
     }
 
-    track tr{std::make_shared<el_track_impl>(storage_, id)};
+    track tr{storage_->make_track_impl(id)};
 
     trans.commit();
 
@@ -225,11 +372,159 @@ std::string el_database_impl::directory()
     return storage_->directory;
 }
 
+std::vector<std::vector<track>> el_database_impl::duplicate_tracks_by_content()
+{
+    std::vector<std::vector<track>> groups;
+    for (auto&& ids : find_content_duplicates(*storage_))
+    {
+        auto& group = groups.emplace_back();
+        for (auto id : ids)
+        {
+            group.push_back(track{storage_->make_track_impl(id)});
+        }
+    }
+
+    return groups;
+}
+
+std::vector<track> el_database_impl::harmonic_candidates(
+    double bpm, musical_key key, double bpm_tolerance)
+{
+    if (!storage_->harmonic_index)
+    {
+        storage_->harmonic_index =
+            std::make_shared<el_harmonic_index>(*storage_);
+    }
+
+    std::vector<track> results;
+    for (auto id :
+         storage_->harmonic_index->find_candidates(bpm, key, bpm_tolerance))
+    {
+        results.push_back(track{storage_->make_track_impl(id)});
+    }
+
+    return results;
+}
+
 bool el_database_impl::is_supported()
 {
     return schema::is_supported(version());
 }
 
+std::shared_ptr<crate_membership_index_impl>
+el_database_impl::load_crate_membership_index()
+{
+    auto index = storage_->crate_membership_index.lock();
+    if (!index)
+    {
+        index = std::make_shared<el_crate_membership_index_impl>(storage_);
+        storage_->crate_membership_index = index;
+    }
+
+    return index;
+}
+
+std::shared_ptr<library_snapshot_impl> el_database_impl::load_library_snapshot(
+    bool include_track_data)
+{
+    auto snapshot = std::make_shared<library_snapshot_impl>();
+    storage_->db << "SELECT id, bpmAnalyzed, length, year, bitrate FROM Track "
+                    "ORDER BY id" >>
+        [&](int64_t id, stdx::optional<double> bpm,
+            stdx::optional<int64_t> length, stdx::optional<int32_t> year,
+            stdx::optional<int64_t> bitrate) {
+            auto row = snapshot->add_row(id);
+            snapshot->bpms[row] = bpm;
+            if (length)
+            {
+                snapshot->durations[row] = std::chrono::seconds{*length};
+            }
+            snapshot->years[row] = year;
+            snapshot->bitrates[row] = bitrate;
+        };
+
+    auto find_row = [&](int64_t id) -> stdx::optional<size_t> {
+        auto iter = snapshot->row_by_id.find(id);
+        if (iter == snapshot->row_by_id.end())
+        {
+            return stdx::nullopt;
+        }
+
+        return iter->second;
+    };
+
+    storage_->db << "SELECT id, type, text FROM MetaData WHERE type IN "
+                    "(?, ?, ?, ?) AND text IS NOT NULL"
+                 << static_cast<int64_t>(metadata_str_type::title)
+                 << static_cast<int64_t>(metadata_str_type::artist)
+                 << static_cast<int64_t>(metadata_str_type::album)
+                 << static_cast<int64_t>(metadata_str_type::genre) >>
+        [&](int64_t id, int64_t type, const std::string& text) {
+            auto row = find_row(id);
+            if (!row)
+            {
+                return;
+            }
+
+            auto ref = snapshot->intern(text);
+            switch (static_cast<metadata_str_type>(type))
+            {
+                case metadata_str_type::title:
+                    snapshot->titles[*row] = ref;
+                    break;
+                case metadata_str_type::artist:
+                    snapshot->artists[*row] = ref;
+                    break;
+                case metadata_str_type::album:
+                    snapshot->albums[*row] = ref;
+                    break;
+                default:
+                    snapshot->genres[*row] = ref;
+                    break;
+            }
+        };
+
+    storage_->db << "SELECT id, value FROM MetaDataInteger WHERE type = ? AND "
+                    "value IS NOT NULL"
+                 << static_cast<int64_t>(metadata_int_type::musical_key) >>
+        [&](int64_t id, int64_t value) {
+            auto row = find_row(id);
+            if (row)
+            {
+                snapshot->keys[*row] = static_cast<musical_key>(value);
+            }
+        };
+
+    if (include_track_data)
+    {
+        storage_->db << "SELECT id, trackData FROM PerformanceData" >>
+            [&](int64_t id, const std::vector<char>& encoded_data) {
+                auto row = find_row(id);
+                if (!row || encoded_data.empty())
+                {
+                    return;
+                }
+
+                auto data = track_data::decode(encoded_data);
+                if (data.sampling)
+                {
+                    double secs =
+                        data.sampling->sample_count / data.sampling->sample_rate;
+                    snapshot->durations[*row] =
+                        std::chrono::milliseconds{
+                            static_cast<int64_t>(1000 * secs)};
+                }
+                if (!snapshot->keys[*row])
+                {
+                    snapshot->keys[*row] = data.key;
+                }
+            };
+    }
+
+    snapshot->rank_texts();
+    return snapshot;
+}
+
 void el_database_impl::verify()
 {
     auto schema_creator_validator =
@@ -239,14 +534,219 @@ void el_database_impl::verify()
 
 void el_database_impl::remove_crate(crate cr)
 {
-    storage_->db << "DELETE FROM Crate WHERE id = ?" << cr.id();
+    remove_crates({cr.id()}, false);
+}
+
+void el_database_impl::remove_crates(
+    const std::vector<int64_t>& crate_ids, bool recursive)
+{
+    el_transaction_guard_impl trans{storage_};
+    el_temporary_keys keys{storage_, crate_ids};
+
+    if (recursive)
+    {
+        add_crate_descendants(*storage_, keys);
+    }
+    else
+    {
+        detach_crate_children(*storage_, keys);
+    }
+
+    delete_crates(*storage_, keys);
+
+    storage_->db << ("SELECT key FROM " + keys.table()) >>
+        [&](int64_t id) { storage_->forget_crate_impl(id); };
+
+    trans.commit();
 }
 
 void el_database_impl::remove_track(track tr)
 {
-    storage_->db << "DELETE FROM Track WHERE id = ?" << tr.id();
-    // All other references to the track should automatically be cleared by
-    // "ON DELETE CASCADE"
+    remove_tracks({tr.id()});
+}
+
+void el_database_impl::remove_tracks(const std::vector<int64_t>& track_ids)
+{
+    el_transaction_guard_impl trans{storage_};
+    el_temporary_keys keys{storage_, track_ids};
+    auto ids = "(SELECT key FROM " + keys.table() + ")";
+
+    // Foreign key constraints are not enforced, and so all references to the
+    // tracks must be deleted explicitly, rather than by "ON DELETE CASCADE".
+    if (storage_->version >= version_1_9_1)
+    {
+        storage_->db << ("DELETE FROM ListTrackList WHERE trackId IN " + ids);
+    }
+    else
+    {
+        for (auto&& table :
+             {"CrateTrackList", "PlaylistTrackList", "PreparelistTrackList",
+              "HistorylistTrackList"})
+        {
+            storage_->db << (std::string{"DELETE FROM "} + table +
+                             " WHERE trackId IN " + ids);
+        }
+    }
+
+    storage_->db << ("DELETE FROM CopiedTrack WHERE trackId IN " + ids);
+    auto metadata_change_count = storage_->change_count("MetaData");
+    auto metadata_int_change_count = storage_->change_count("MetaDataInteger");
+    auto track_change_count = storage_->change_count("Track");
+    storage_->db << ("DELETE FROM MetaData WHERE id IN " + ids);
+    storage_->db << ("DELETE FROM MetaDataInteger WHERE id IN " + ids);
+    storage_->db << ("DELETE FROM PerformanceData WHERE id IN " + ids);
+    storage_->db << ("DELETE FROM Track WHERE id IN " + ids);
+    storage_->apply_track_removal(
+        metadata_change_count, metadata_int_change_count, track_change_count,
+        track_ids);
+
+    for (auto id : track_ids)
+    {
+        storage_->forget_track_impl(id);
+    }
+
+    trans.commit();
+}
+
+track_page el_database_impl::list_tracks(
+    const track_query& query, size_t page_size,
+    const stdx::optional<std::string>& continuation_token)
+{
+    return fetch_track_page(storage_, query, page_size, continuation_token);
+}
+
+std::shared_ptr<track_cursor_impl> el_database_impl::query_tracks(
+    const track_query& query)
+{
+    std::vector<sql_parameter> parameters;
+    auto sql = compile_track_query(query, parameters);
+    return std::make_shared<el_track_cursor_impl>(
+        storage_, std::move(sql), parameters);
+}
+
+int64_t el_database_impl::relocate_tracks(
+    const std::string& old_prefix, const std::string& new_prefix)
+{
+    if (old_prefix == new_prefix)
+    {
+        return 0;
+    }
+
+    // Paths beginning with the prefix are found by a range scan of the path
+    // index, and then compared exactly.
+    auto upper_bound = prefix_upper_bound(old_prefix);
+    std::string condition =
+        "path >= ?1 AND substr(path, 1, length(?1)) = ?1" +
+        std::string{upper_bound ? " AND path < ?2" : ""};
+
+    el_transaction_guard_impl trans{storage_};
+
+    // Track paths are only unique by constraint in later schema versions, and
+    // so clashes are checked for explicitly, before anything is changed.
+    {
+        bool clash = false;
+        auto query = storage_->db
+                     << "SELECT EXISTS (SELECT 1 FROM Track WHERE " +
+                            condition +
+                            " AND ?3 || substr(path, length(?1) + 1) IN "
+                            "(SELECT path FROM Track))"
+                     << old_prefix;
+        query << (upper_bound ? *upper_bound : std::string{}) << new_prefix;
+        query >> clash;
+        if (clash)
+        {
+            throw std::runtime_error{
+                "A relocated track path is already that of another track"};
+        }
+    }
+
+    // Filenames only change where the prefix ends within the filename, and
+    // so only those tracks are changed individually.
+    struct renamed_track
+    {
+        int64_t id;
+        std::string filename;
+        stdx::optional<std::string> file_extension;
+    };
+    std::vector<renamed_track> renamed_tracks;
+    {
+        auto query =
+            storage_->db << "SELECT id, path FROM Track WHERE " + condition +
+                                " AND instr(substr(path, length(?1) + 1), "
+                                "'/') = 0"
+                         << old_prefix;
+        if (upper_bound)
+        {
+            query << *upper_bound;
+        }
+
+        query >> [&](int64_t id, std::string path) {
+            auto new_path = new_prefix + path.substr(old_prefix.size());
+            auto filename = get_filename(new_path);
+            if (filename != get_filename(path))
+            {
+                renamed_tracks.push_back(renamed_track{
+                    id, std::move(filename), get_file_extension(new_path)});
+            }
+        };
+    }
+
+    {
+        auto query = storage_->db
+                     << "UPDATE Track SET path = ?3 || substr(path, length(?1) "
+                        "+ 1) WHERE " +
+                            condition
+                     << old_prefix;
+        query << (upper_bound ? *upper_bound : std::string{}) << new_prefix;
+        query++;
+    }
+
+    int64_t count = sqlite3_changes(storage_->db.connection().get());
+
+    for (auto&& renamed : renamed_tracks)
+    {
+        storage_->db << "UPDATE Track SET filename = ? WHERE id = ?"
+                     << renamed.filename << renamed.id;
+        auto change_count = storage_->change_count("MetaData");
+        storage_->db
+            << "REPLACE INTO MetaData (id, type, text) VALUES (?, ?, ?)"
+            << renamed.id
+            << static_cast<int64_t>(metadata_str_type::file_extension)
+            << renamed.file_extension;
+        storage_->apply_metadata_str_changes(
+            change_count, renamed.id,
+            {{metadata_str_type::file_extension, renamed.file_extension}});
+    }
+
+    trans.commit();
+    return count;
+}
+
+file_scan_summary el_database_impl::scan_files(
+    const file_scan_options& options)
+{
+    return enginelibrary::scan_files(*storage_, options);
+}
+
+void el_database_impl::set_track_row_cache_policy(track_row_cache_policy policy)
+{
+    storage_->track_row_cache = policy;
+}
+
+std::vector<std::string> el_database_impl::track_directories()
+{
+    std::vector<std::string> results;
+    storage_->db << "SELECT path FROM Track WHERE path IS NOT NULL" >>
+        [&](const std::string& path) {
+            auto slash = path.rfind('/');
+            results.push_back(
+                slash == std::string::npos ? std::string{}
+                                           : path.substr(0, slash));
+        };
+
+    std::sort(results.begin(), results.end());
+    results.erase(std::unique(results.begin(), results.end()), results.end());
+    return results;
 }
 
 std::vector<crate> el_database_impl::root_crates()
@@ -257,7 +757,7 @@ std::vector<crate> el_database_impl::root_crates()
                "= crateOriginId ORDER BY crateOriginId" >>
         [&](int64_t id) {
             results.push_back(
-                crate{std::make_shared<el_crate_impl>(storage_, id)});
+                crate{storage_->make_crate_impl(id)});
         };
     return results;
 }
@@ -273,11 +773,61 @@ stdx::optional<crate> el_database_impl::root_crate_by_name(
                     "ORDER BY cr.id"
                  << name.data() >>
         [&](int64_t id) {
-            cr = crate{std::make_shared<el_crate_impl>(storage_, id)};
+            cr = crate{storage_->make_crate_impl(id)};
         };
     return cr;
 }
 
+std::vector<track> el_database_impl::search_tracks(
+    const std::string& query, size_t limit)
+{
+    if (!storage_->track_search_index)
+    {
+        storage_->track_search_index =
+            std::make_shared<el_track_search_index>(*storage_);
+    }
+
+    std::vector<track> results;
+    for (auto id : storage_->track_search_index->search(query, limit))
+    {
+        results.push_back(track{storage_->make_track_impl(id)});
+    }
+
+    return results;
+}
+
+std::vector<similar_track_group> el_database_impl::similar_tracks(
+    const similar_tracks_options& options)
+{
+    std::vector<similar_track_group> groups;
+    for (auto&& id_group : find_similar_tracks(*storage_, options))
+    {
+        auto& group = groups.emplace_back();
+        for (auto id : id_group.track_ids)
+        {
+            group.tracks.push_back(track{storage_->make_track_impl(id)});
+        }
+
+        group.pairs = std::move(id_group.pairs);
+    }
+
+    return groups;
+}
+
+library_sync_report el_database_impl::sync_library(
+    database_impl& other, const library_sync_options& options)
+{
+    auto el_other = dynamic_cast<el_database_impl*>(&other);
+    if (el_other == nullptr)
+    {
+        throw std::invalid_argument{
+            "Only Engine Library databases can be synchronised with one "
+            "another"};
+    }
+
+    return enginelibrary::sync_library(storage_, el_other->storage_, options);
+}
+
 stdx::optional<track> el_database_impl::track_by_id(int64_t id)
 {
     stdx::optional<track> tr;
@@ -285,7 +835,7 @@ stdx::optional<track> el_database_impl::track_by_id(int64_t id)
         [&](int64_t count) {
             if (count == 1)
             {
-                tr = track{std::make_shared<el_track_impl>(storage_, id)};
+                tr = track{storage_->make_track_impl(id)};
             }
             else if (count > 1)
             {
@@ -296,15 +846,40 @@ stdx::optional<track> el_database_impl::track_by_id(int64_t id)
     return tr;
 }
 
+std::vector<stdx::optional<track>> el_database_impl::tracks_by_ids(
+    const std::vector<int64_t>& ids)
+{
+    std::vector<stdx::optional<track>> results(ids.size());
+    el_transaction_guard_impl trans{storage_};
+    el_temporary_keys keys{storage_, ids};
+    storage_->db << ("SELECT k.position, t.id FROM " + keys.table() +
+                     " AS k JOIN Track AS t ON t.id = k.key") >>
+        [&](int64_t position, int64_t id) {
+            results[position] = track{storage_->make_track_impl(id)};
+        };
+    trans.commit();
+    return results;
+}
+
 std::vector<track> el_database_impl::tracks()
 {
     std::vector<track> results;
     storage_->db << "SELECT id FROM Track ORDER BY id" >> [&](int64_t id) {
-        results.push_back(track{std::make_shared<el_track_impl>(storage_, id)});
+        results.push_back(track{storage_->make_track_impl(id)});
     };
     return results;
 }
 
+std::shared_ptr<track_cursor_impl> el_database_impl::tracks_in_crates(
+    const crate_set_expr& expr)
+{
+    std::vector<sql_parameter> parameters;
+    auto sql = "SELECT id FROM Track WHERE id IN (" +
+               compile_crate_set_expr(expr, parameters) + ") ORDER BY id";
+    return std::make_shared<el_track_cursor_impl>(
+        storage_, std::move(sql), parameters);
+}
+
 std::vector<track> el_database_impl::tracks_by_relative_path(
     const std::string& relative_path)
 {
@@ -312,12 +887,27 @@ std::vector<track> el_database_impl::tracks_by_relative_path(
     storage_->db << "SELECT id FROM Track WHERE path = ? ORDER BY id"
                  << relative_path.data() >>
         [&](int64_t id) {
-            results.push_back(
-                track{std::make_shared<el_track_impl>(storage_, id)});
+            results.push_back(track{storage_->make_track_impl(id)});
         };
     return results;
 }
 
+std::vector<std::vector<track>> el_database_impl::tracks_by_relative_paths(
+    const std::vector<std::string>& relative_paths)
+{
+    std::vector<std::vector<track>> results(relative_paths.size());
+    el_transaction_guard_impl trans{storage_};
+    el_temporary_keys keys{storage_, relative_paths};
+    storage_->db << ("SELECT k.position, t.id FROM " + keys.table() +
+                     " AS k JOIN Track AS t ON t.path = k.key "
+                     "ORDER BY k.position, t.id") >>
+        [&](int64_t position, int64_t id) {
+            results[position].push_back(track{storage_->make_track_impl(id)});
+        };
+    trans.commit();
+    return results;
+}
+
 std::string el_database_impl::uuid()
 {
     std::string uuid;
@@ -31,25 +31,66 @@ class el_database_impl : public database_impl
 public:
     el_database_impl(std::shared_ptr<el_storage> storage);
 
+    std::vector<autocomplete_suggestion> autocomplete(
+        autocomplete_field field, const std::string& prefix,
+        size_t limit) override;
     transaction_guard begin_transaction() override;
+    content_hash_result compute_content_hashes(
+        const content_hash_options& options) override;
+    std::vector<track> copy_tracks(
+        const database& source, const std::vector<track>& tracks) override;
     stdx::optional<djinterop::crate> crate_by_id(int64_t id) override;
     std::vector<djinterop::crate> crates() override;
     std::vector<djinterop::crate> crates_by_name(
         const std::string& name) override;
+    std::vector<crate_tree_node> crate_tree_nodes() override;
+    int64_t crates_version() override;
     djinterop::crate create_root_crate(std::string name) override;
     track create_track(std::string relative_path) override;
     std::string directory() override;
+    std::vector<std::vector<track>> duplicate_tracks_by_content() override;
+    std::vector<track> harmonic_candidates(
+        double bpm, musical_key key, double bpm_tolerance) override;
     bool is_supported() override;
+    std::shared_ptr<crate_membership_index_impl> load_crate_membership_index()
+        override;
+    track_page list_tracks(
+        const track_query& query, size_t page_size,
+        const stdx::optional<std::string>& continuation_token) override;
+    std::shared_ptr<library_snapshot_impl> load_library_snapshot(
+        bool include_track_data) override;
+    std::shared_ptr<track_cursor_impl> query_tracks(
+        const track_query& query) override;
+    int64_t relocate_tracks(
+        const std::string& old_prefix, const std::string& new_prefix) override;
+    file_scan_summary scan_files(const file_scan_options& options) override;
+    void set_track_row_cache_policy(track_row_cache_policy policy) override;
+    std::vector<std::string> track_directories() override;
     void verify() override;
     void remove_crate(djinterop::crate cr) override;
+    void remove_crates(
+        const std::vector<int64_t>& crate_ids, bool recursive) override;
     void remove_track(djinterop::track tr) override;
+    void remove_tracks(const std::vector<int64_t>& track_ids) override;
     std::vector<djinterop::crate> root_crates() override;
     stdx::optional<djinterop::crate> root_crate_by_name(
         const std::string& name) override;
+    std::vector<djinterop::track> search_tracks(
+        const std::string& query, size_t limit) override;
+    std::vector<similar_track_group> similar_tracks(
+        const similar_tracks_options& options) override;
+    library_sync_report sync_library(
+        database_impl& other, const library_sync_options& options) override;
     stdx::optional<djinterop::track> track_by_id(int64_t id) override;
+    std::vector<stdx::optional<djinterop::track>> tracks_by_ids(
+        const std::vector<int64_t>& ids) override;
     std::vector<djinterop::track> tracks() override;
+    std::shared_ptr<track_cursor_impl> tracks_in_crates(
+        const crate_set_expr& expr) override;
     std::vector<djinterop::track> tracks_by_relative_path(
         const std::string& relative_path) override;
+    std::vector<std::vector<djinterop::track>> tracks_by_relative_paths(
+        const std::vector<std::string>& relative_paths) override;
     std::string uuid() override;
     semantic_version version() override;
     std::string version_name() override;
@@ -0,0 +1,157 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/enginelibrary/el_file_scan.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/parallel.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+struct scanned_track
+{
+    int64_t id;
+    std::string relative_path;
+    stdx::optional<int64_t> recorded_size;
+    stdx::optional<file_scan_status> status;
+    stdx::optional<int64_t> actual_size;
+};
+
+void scan_file(const std::string& directory, scanned_track& track)
+{
+    struct stat buf;
+    auto path = directory + "/" + track.relative_path;
+    if (stat(path.c_str(), &buf) != 0)
+    {
+        track.status = errno == ENOENT || errno == ENOTDIR
+                           ? file_scan_status::missing
+                           : file_scan_status::inaccessible;
+        return;
+    }
+
+    track.actual_size = static_cast<int64_t>(buf.st_size);
+    if (track.recorded_size && *track.recorded_size > 0 &&
+        *track.recorded_size != *track.actual_size)
+    {
+        track.status = file_scan_status::size_changed;
+    }
+}
+
+}  // namespace
+
+file_scan_summary scan_files(
+    el_storage& storage, const file_scan_options& options)
+{
+    if (options.parallelism == 0 || options.batch_size == 0)
+    {
+        throw std::invalid_argument{
+            "Parallelism and batch size must be positive"};
+    }
+
+    // File sizes are only recorded by later schema versions.
+    std::string sql =
+        storage.version >= version_1_15_0
+            ? "SELECT id, path, fileBytes FROM Track "
+            : "SELECT id, path, NULL FROM Track ";
+    sql += "WHERE id > ? AND path IS NOT NULL ORDER BY id LIMIT ?";
+
+    int64_t total_count;
+    storage.db << "SELECT COUNT(*) FROM Track WHERE path IS NOT NULL" >>
+        total_count;
+
+    file_scan_summary summary;
+    std::vector<scanned_track> batch;
+    int64_t last_id = 0;
+    do
+    {
+        // Each batch is read with a fresh query, so that no statement is
+        // active while the callbacks run.
+        batch.clear();
+        storage.db << sql << last_id
+                   << static_cast<int64_t>(options.batch_size) >>
+            [&](int64_t id, std::string relative_path,
+                stdx::optional<int64_t> recorded_size) {
+                batch.push_back(scanned_track{
+                    id, std::move(relative_path), recorded_size,
+                    stdx::nullopt, stdx::nullopt});
+            };
+
+        for_each_in_parallel(
+            batch.size(), options.parallelism, [&](size_t index, size_t) {
+                scan_file(storage.directory, batch[index]);
+            });
+
+        for (auto&& track : batch)
+        {
+            ++summary.scanned_count;
+            if (!track.status)
+            {
+                continue;
+            }
+
+            switch (*track.status)
+            {
+                case file_scan_status::missing:
+                    ++summary.missing_count;
+                    break;
+                case file_scan_status::inaccessible:
+                    ++summary.inaccessible_count;
+                    break;
+                case file_scan_status::size_changed:
+                    ++summary.size_changed_count;
+                    break;
+            }
+
+            if (options.on_entry)
+            {
+                options.on_entry(file_scan_entry{
+                    track.id, track.relative_path, *track.status,
+                    track.recorded_size, track.actual_size});
+            }
+        }
+
+        if (!batch.empty())
+        {
+            last_id = batch.back().id;
+            if (options.on_progress)
+            {
+                options.on_progress(
+                    summary.scanned_count,
+                    std::max(total_count, summary.scanned_count));
+            }
+        }
+    } while (batch.size() == options.batch_size);
+
+    return summary;
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,39 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <djinterop/file_scan.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// Check that the music file of each track exists, and that its size is as
+/// recorded in the database, where the schema records it.
+///
+/// Tracks are read from the database in batches, in ascending order of ID.
+/// The files of each batch are checked on a number of worker threads, and
+/// then reported on the calling thread.
+file_scan_summary scan_files(
+    el_storage& storage, const file_scan_options& options);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,316 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <djinterop/enginelibrary/el_harmonic_index.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+bool is_major(int64_t key)
+{
+    return key % 2 == 0;
+}
+
+/// Get the number, from 0 to 11, of a key on the Camelot wheel, where 0 is 1A
+/// or 1B.
+int camelot_number(int64_t key)
+{
+    auto pair_index = static_cast<int>((key - 1) / 2);
+    return is_major(key) ? (pair_index + 8) % 12 : (pair_index + 7) % 12;
+}
+
+/// Get the key at a given number on the Camelot wheel, which may lie outside
+/// the range 0 to 11.
+int64_t key_at(int number, bool major)
+{
+    number = (number % 12 + 12) % 12;
+    auto pair_index = major ? (number + 4) % 12 : (number + 5) % 12;
+    return 2 * pair_index + (major ? 2 : 1);
+}
+
+bool is_indexable(
+    const stdx::optional<double>& bpm, const stdx::optional<int64_t>& key)
+{
+    return bpm && *bpm > 0 && key && *key >= 1 && *key <= 24;
+}
+
+}  // namespace
+
+el_harmonic_index::el_harmonic_index(el_storage& storage) : storage_{storage}
+{
+}
+
+void el_harmonic_index::apply_track_row(
+    int64_t change_count_before, int64_t track_id,
+    const stdx::optional<stdx::optional<double> >& bpm)
+{
+    if (!loaded_ || change_count_before != track_change_count_)
+    {
+        return;
+    }
+
+    if (bpm)
+    {
+        auto iter = entries_by_track_.find(track_id);
+        auto entry =
+            iter != entries_by_track_.end() ? iter->second : track_entry{};
+        entry.bpm = *bpm;
+        update_track(track_id, entry);
+    }
+
+    track_change_count_ = storage_.change_count("Track");
+}
+
+void el_harmonic_index::apply_metadata_ints(
+    int64_t change_count_before, int64_t track_id,
+    const std::vector<std::pair<metadata_int_type, stdx::optional<int64_t> > >&
+        changes)
+{
+    if (!loaded_ || change_count_before != metadata_int_change_count_)
+    {
+        return;
+    }
+
+    for (auto&& change : changes)
+    {
+        if (change.first == metadata_int_type::musical_key)
+        {
+            auto iter = entries_by_track_.find(track_id);
+            auto entry =
+                iter != entries_by_track_.end() ? iter->second : track_entry{};
+            entry.key = change.second;
+            update_track(track_id, entry);
+        }
+    }
+
+    metadata_int_change_count_ = storage_.change_count("MetaDataInteger");
+}
+
+void el_harmonic_index::apply_removal(
+    int64_t metadata_int_change_count_before,
+    int64_t track_change_count_before, const std::vector<int64_t>& track_ids)
+{
+    if (!loaded_ ||
+        metadata_int_change_count_before != metadata_int_change_count_ ||
+        track_change_count_before != track_change_count_)
+    {
+        return;
+    }
+
+    for (auto track_id : track_ids)
+    {
+        update_track(track_id, track_entry{});
+    }
+
+    metadata_int_change_count_ = storage_.change_count("MetaDataInteger");
+    track_change_count_ = storage_.change_count("Track");
+}
+
+std::vector<int64_t> el_harmonic_index::find_candidates(
+    double bpm, musical_key key, double bpm_tolerance)
+{
+    auto key_num = static_cast<int64_t>(key);
+    if (!(bpm > 0) || std::isinf(bpm))
+    {
+        throw std::invalid_argument{"BPM must be positive"};
+    }
+
+    // Beyond a third, the half-, normal- and double-time ranges would overlap.
+    if (!(bpm_tolerance >= 0 && bpm_tolerance < 1.0 / 3))
+    {
+        throw std::invalid_argument{
+            "BPM tolerance must be at least zero and less than one third"};
+    }
+
+    if (key_num < 1 || key_num > static_cast<int64_t>(key_count))
+    {
+        throw std::invalid_argument{"Invalid musical key"};
+    }
+
+    refresh();
+
+    // Compatible keys are the same key, those either side of it on the wheel,
+    // and its relative major or minor.
+    auto number = camelot_number(key_num);
+    auto major = is_major(key_num);
+    const std::array<int64_t, 4> compatible_keys{
+        key_num, key_at(number - 1, major), key_at(number + 1, major),
+        key_at(number, !major)};
+
+    std::vector<std::pair<double, int64_t> > matches;
+    for (auto multiple : {0.5, 1.0, 2.0})
+    {
+        auto target = bpm * multiple;
+        auto low = target * (1 - bpm_tolerance);
+        auto high = target * (1 + bpm_tolerance);
+        for (auto compatible_key : compatible_keys)
+        {
+            auto& b = buckets_[compatible_key - 1];
+            auto begin = std::lower_bound(b.bpms.begin(), b.bpms.end(), low);
+            auto end = std::upper_bound(begin, b.bpms.end(), high);
+            for (auto iter = begin; iter != end; ++iter)
+            {
+                matches.emplace_back(
+                    std::abs(*iter / target - 1),
+                    b.track_ids[iter - b.bpms.begin()]);
+            }
+        }
+    }
+
+    std::sort(matches.begin(), matches.end());
+
+    std::vector<int64_t> results;
+    results.reserve(matches.size());
+    for (auto&& match : matches)
+    {
+        results.push_back(match.second);
+    }
+
+    return results;
+}
+
+void el_harmonic_index::index_track(int64_t track_id, const track_entry& entry)
+{
+    if (!is_indexable(entry.bpm, entry.key))
+    {
+        return;
+    }
+
+    auto& b = buckets_[*entry.key - 1];
+    auto pos = std::lower_bound(b.bpms.begin(), b.bpms.end(), *entry.bpm) -
+               b.bpms.begin();
+    while (static_cast<size_t>(pos) < b.bpms.size() &&
+           b.bpms[pos] == *entry.bpm && b.track_ids[pos] < track_id)
+    {
+        ++pos;
+    }
+
+    b.bpms.insert(b.bpms.begin() + pos, *entry.bpm);
+    b.track_ids.insert(b.track_ids.begin() + pos, track_id);
+}
+
+void el_harmonic_index::load()
+{
+    metadata_int_change_count_ = storage_.change_count("MetaDataInteger");
+    track_change_count_ = storage_.change_count("Track");
+    data_version_ = storage_.music_data_version();
+    loaded_ = true;
+
+    entries_by_track_.clear();
+    storage_.db << "SELECT id, bpmAnalyzed FROM Track "
+                   "WHERE bpmAnalyzed IS NOT NULL" >>
+        [&](int64_t id, double bpm) { entries_by_track_[id].bpm = bpm; };
+    storage_.db << "SELECT id, value FROM MetaDataInteger "
+                   "WHERE type = ? AND value IS NOT NULL"
+                << static_cast<int64_t>(metadata_int_type::musical_key) >>
+        [&](int64_t id, int64_t key) { entries_by_track_[id].key = key; };
+
+    std::array<std::vector<std::pair<double, int64_t> >, key_count> entries;
+    for (auto&& entry : entries_by_track_)
+    {
+        auto& bpm = entry.second.bpm;
+        auto& key = entry.second.key;
+        if (is_indexable(bpm, key))
+        {
+            entries[*key - 1].emplace_back(*bpm, entry.first);
+        }
+    }
+
+    for (size_t i = 0; i < key_count; ++i)
+    {
+        std::sort(entries[i].begin(), entries[i].end());
+        auto& b = buckets_[i];
+        b.bpms.clear();
+        b.track_ids.clear();
+        b.bpms.reserve(entries[i].size());
+        b.track_ids.reserve(entries[i].size());
+        for (auto&& entry : entries[i])
+        {
+            b.bpms.push_back(entry.first);
+            b.track_ids.push_back(entry.second);
+        }
+    }
+}
+
+void el_harmonic_index::refresh()
+{
+    if (!loaded_ ||
+        storage_.change_count("MetaDataInteger") !=
+            metadata_int_change_count_ ||
+        storage_.change_count("Track") != track_change_count_ ||
+        storage_.music_data_version() != data_version_)
+    {
+        load();
+    }
+}
+
+void el_harmonic_index::unindex_track(
+    int64_t track_id, const track_entry& entry)
+{
+    if (!is_indexable(entry.bpm, entry.key))
+    {
+        return;
+    }
+
+    auto& b = buckets_[*entry.key - 1];
+    auto pos = std::lower_bound(b.bpms.begin(), b.bpms.end(), *entry.bpm) -
+               b.bpms.begin();
+    while (static_cast<size_t>(pos) < b.bpms.size() &&
+           b.bpms[pos] == *entry.bpm)
+    {
+        if (b.track_ids[pos] == track_id)
+        {
+            b.bpms.erase(b.bpms.begin() + pos);
+            b.track_ids.erase(b.track_ids.begin() + pos);
+            return;
+        }
+
+        ++pos;
+    }
+}
+
+void el_harmonic_index::update_track(
+    int64_t track_id, const track_entry& entry)
+{
+    auto iter = entries_by_track_.find(track_id);
+    if (iter != entries_by_track_.end())
+    {
+        unindex_track(track_id, iter->second);
+    }
+
+    index_track(track_id, entry);
+    if (entry.bpm || entry.key)
+    {
+        entries_by_track_[track_id] = entry;
+    }
+    else if (iter != entries_by_track_.end())
+    {
+        entries_by_track_.erase(iter);
+    }
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
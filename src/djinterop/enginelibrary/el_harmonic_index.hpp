@@ -0,0 +1,116 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// An in-memory index of the BPM and musical key of all tracks, for finding
+/// tracks that mix harmonically with a given track.
+///
+/// Tracks having both a BPM and a key are held in one bucket per key, sorted
+/// by BPM, so that the tracks of a key within a range of BPMs occupy a
+/// contiguous range of a bucket, found by binary search.
+class el_harmonic_index
+{
+public:
+    el_harmonic_index(el_storage& storage);
+
+    /// Apply a change to the `Track` row of a track that was made via the
+    /// storage's connection, where `bpm` is engaged if the BPM was changed.
+    ///
+    /// The change is only applied if the index was up to date just before it
+    /// was made, as given by the change counter of the `Track` table at that
+    /// time.  Otherwise, the index will be reloaded upon its next use.
+    void apply_track_row(
+        int64_t change_count_before, int64_t track_id,
+        const stdx::optional<stdx::optional<double> >& bpm);
+
+    /// Apply changes to the metadata integers of a track that were made via
+    /// the storage's connection.
+    ///
+    /// The changes are only applied if the index was up to date just before
+    /// they were made, as given by the change counter of the `MetaDataInteger`
+    /// table at that time.
+    void apply_metadata_ints(
+        int64_t change_count_before, int64_t track_id,
+        const std::vector<
+            std::pair<metadata_int_type, stdx::optional<int64_t> > >& changes);
+
+    /// Apply the removal of tracks that was made via the storage's connection.
+    void apply_removal(
+        int64_t metadata_int_change_count_before,
+        int64_t track_change_count_before,
+        const std::vector<int64_t>& track_ids);
+
+    /// Find the IDs of tracks whose BPM is within a relative tolerance of the
+    /// given BPM, or of half or double it, and whose key is compatible with
+    /// the given key on the Camelot wheel.
+    ///
+    /// Track IDs are returned in ascending order of the relative difference in
+    /// BPM, and then in ascending order.
+    std::vector<int64_t> find_candidates(
+        double bpm, musical_key key, double bpm_tolerance);
+
+private:
+    static constexpr size_t key_count = 24;
+
+    struct track_entry
+    {
+        stdx::optional<double> bpm;
+        stdx::optional<int64_t> key;
+    };
+
+    /// The tracks of a single key, in ascending order of BPM and then ID.
+    struct bucket
+    {
+        std::vector<double> bpms;
+        std::vector<int64_t> track_ids;
+    };
+
+    void index_track(int64_t track_id, const track_entry& entry);
+    void load();
+    void refresh();
+    void unindex_track(int64_t track_id, const track_entry& entry);
+    void update_track(int64_t track_id, const track_entry& entry);
+
+    el_storage& storage_;
+    bool loaded_ = false;
+    int64_t metadata_int_change_count_ = 0;
+    int64_t track_change_count_ = 0;
+    int64_t data_version_ = 0;
+    std::unordered_map<int64_t, track_entry> entries_by_track_;
+    std::array<bucket, key_count> buckets_;
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,191 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <djinterop/enginelibrary/el_library_snapshot_cache.hpp>
+#include <djinterop/mapped_file.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+constexpr char cache_magic[8] = {'D', 'J', 'I', 'S', 'N', 'A', 'P', '1'};
+
+template <typename T>
+void write_value(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+template <typename T>
+bool read_value(const char*& ptr, const char* end, T& value)
+{
+    if (static_cast<size_t>(end - ptr) < sizeof value)
+    {
+        return false;
+    }
+
+    std::memcpy(&value, ptr, sizeof value);
+    ptr += sizeof value;
+    return true;
+}
+
+/// Returns a name for a temporary file beside a given path that is unique
+/// among all writers, whether in this process or another.
+std::string unique_temp_path(const std::string& path)
+{
+    static std::atomic<uint64_t> counter{0};
+#if defined(_WIN32)
+    auto pid = _getpid();
+#else
+    auto pid = getpid();
+#endif
+    return path + "." + std::to_string(pid) + "." +
+           std::to_string(counter++) + ".tmp";
+}
+
+}  // namespace
+
+library_snapshot_cache_stamp current_library_snapshot_cache_stamp(
+    std::string uuid, const std::string& music_db_path)
+{
+    library_snapshot_cache_stamp stamp;
+    stamp.uuid = std::move(uuid);
+
+#if defined(_WIN32)
+    struct _stat64 buf;
+    if (_stat64(music_db_path.c_str(), &buf) == 0)
+    {
+        stamp.music_db_size = buf.st_size;
+        stamp.music_db_modified_ns =
+            static_cast<int64_t>(buf.st_mtime) * 1000000000;
+    }
+#else
+    struct stat buf;
+    if (stat(music_db_path.c_str(), &buf) == 0)
+    {
+        stamp.music_db_size = buf.st_size;
+#if defined(__APPLE__)
+        auto& modified = buf.st_mtimespec;
+#else
+        auto& modified = buf.st_mtim;
+#endif
+        stamp.music_db_modified_ns =
+            static_cast<int64_t>(modified.tv_sec) * 1000000000 +
+            modified.tv_nsec;
+    }
+#endif
+
+    return stamp;
+}
+
+stdx::optional<library_snapshot> read_library_snapshot_cache(
+    const std::string& path, library_snapshot_cache_stamp& stamp)
+{
+    struct stat buf;
+    if (stat(path.c_str(), &buf) != 0)
+    {
+        return stdx::nullopt;
+    }
+
+    try
+    {
+        mapped_file file{path};
+        auto ptr = file.data();
+        auto end = ptr + file.size();
+        if (file.size() < sizeof cache_magic ||
+            std::memcmp(ptr, cache_magic, sizeof cache_magic) != 0)
+        {
+            return stdx::nullopt;
+        }
+
+        ptr += sizeof cache_magic;
+        uint32_t uuid_size;
+        if (!read_value(ptr, end, stamp.music_db_size) ||
+            !read_value(ptr, end, stamp.music_db_modified_ns) ||
+            !read_value(ptr, end, uuid_size) ||
+            static_cast<size_t>(end - ptr) < uuid_size)
+        {
+            return stdx::nullopt;
+        }
+
+        stamp.uuid.assign(ptr, uuid_size);
+        ptr += uuid_size;
+        return library_snapshot::decode(ptr, end - ptr);
+    }
+    catch (const std::invalid_argument&)
+    {
+        return stdx::nullopt;
+    }
+    catch (const std::runtime_error&)
+    {
+        return stdx::nullopt;
+    }
+}
+
+void write_library_snapshot_cache(
+    const std::string& path, const library_snapshot_cache_stamp& stamp,
+    const library_snapshot& snapshot)
+{
+    // The cache is written to a temporary file and then moved into place, so
+    // that readers never observe a partially-written cache.  Concurrent
+    // rebuilds each write their own temporary file, and the last to finish
+    // replaces the cache.
+    auto temp_path = unique_temp_path(path);
+    {
+        std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+        out.write(cache_magic, sizeof cache_magic);
+        write_value(out, stamp.music_db_size);
+        write_value(out, stamp.music_db_modified_ns);
+        write_value(out, static_cast<uint32_t>(stamp.uuid.size()));
+        out.write(stamp.uuid.data(), stamp.uuid.size());
+        auto encoded = snapshot.encode();
+        out.write(encoded.data(), encoded.size());
+        if (!out.flush())
+        {
+            throw std::runtime_error{"Failed to write library snapshot cache"};
+        }
+    }
+
+#if defined(_WIN32)
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error{"Failed to replace library snapshot cache"};
+    }
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
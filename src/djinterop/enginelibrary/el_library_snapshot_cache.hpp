@@ -0,0 +1,64 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <djinterop/library_snapshot.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+/// Identifies the state of a database from which a cached library snapshot
+/// was loaded.
+struct library_snapshot_cache_stamp
+{
+    std::string uuid;
+    int64_t music_db_size = 0;
+    int64_t music_db_modified_ns = 0;
+
+    friend bool operator==(
+        const library_snapshot_cache_stamp& first,
+        const library_snapshot_cache_stamp& second) noexcept
+    {
+        return first.uuid == second.uuid &&
+               first.music_db_size == second.music_db_size &&
+               first.music_db_modified_ns == second.music_db_modified_ns;
+    }
+};
+
+/// Get the current stamp of a database, given its UUID and the path to its
+/// music database file.
+library_snapshot_cache_stamp current_library_snapshot_cache_stamp(
+    std::string uuid, const std::string& music_db_path);
+
+/// Read a library snapshot cache file, returning `nullopt` if the file is
+/// missing or is not a valid cache file.
+stdx::optional<library_snapshot> read_library_snapshot_cache(
+    const std::string& path, library_snapshot_cache_stamp& stamp);
+
+/// Write a library snapshot cache file, replacing any existing file.
+void write_library_snapshot_cache(
+    const std::string& path, const library_snapshot_cache_stamp& stamp,
+    const library_snapshot& snapshot);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,557 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <zlib.h>
+
+#include <djinterop/content_hasher.hpp>
+#include <djinterop/enginelibrary/el_library_sync.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_track_copy.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// Columns of the `Track` table that are particular to each database, and so
+/// are neither compared nor synchronised.
+const std::set<std::string> local_track_columns{
+    "filename",
+    "id",
+    "idAlbumArt",
+    "idTrackInExternalDatabase",
+    "isExternalTrack",
+    "path",
+    "pdbImportKey",
+    "uri",
+    "uuidOfExternalDatabase",
+};
+
+struct track_fingerprint
+{
+    int64_t id;
+    std::string relative_path;
+    stdx::optional<int64_t> content_hash;
+    stdx::optional<int64_t> last_modified;
+    uint64_t track = 0;
+    uint64_t metadata = 0;
+    uint64_t performance_data = 0;
+};
+
+struct track_update
+{
+    int64_t target_id;
+    int64_t source_id;
+    bool track;
+    bool metadata;
+    bool performance_data;
+};
+
+std::vector<std::string> column_names(
+    el_storage& storage, const std::string& schema, const std::string& table)
+{
+    std::vector<std::string> names;
+    storage.db << "SELECT name FROM pragma_table_info(?, ?)" << table
+               << schema >>
+        [&](std::string name) { names.push_back(std::move(name)); };
+    return names;
+}
+
+/// Returns the columns of a table that are present in both storages, other
+/// than those excluded, in the order of the first storage.
+std::vector<std::string> shared_columns(
+    el_storage& first, el_storage& second, const std::string& schema,
+    const std::string& table, const std::set<std::string>& excluded)
+{
+    auto second_names = column_names(second, schema, table);
+    std::vector<std::string> columns;
+    for (auto&& name : column_names(first, schema, table))
+    {
+        if (excluded.count(name) == 0 &&
+            std::find(second_names.begin(), second_names.end(), name) !=
+                second_names.end())
+        {
+            columns.push_back(name);
+        }
+    }
+
+    return columns;
+}
+
+std::string column_list(
+    const std::vector<std::string>& columns, const std::string& prefix = {})
+{
+    std::string result;
+    for (auto&& column : columns)
+    {
+        result += (result.empty() ? "" : ", ") + prefix + "[" + column + "]";
+    }
+
+    return result;
+}
+
+template <typename Function>
+void for_each_row(
+    el_storage& storage, const std::string& sql, Function function)
+{
+    sqlite3_stmt* raw_stmt = nullptr;
+    auto rc = sqlite3_prepare_v2(
+        storage.db.connection().get(), sql.c_str(), -1, &raw_stmt, nullptr);
+    std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> stmt{
+        raw_stmt, &sqlite3_finalize};
+    if (rc != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(rc, sql);
+    }
+
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW)
+    {
+        function(stmt.get());
+    }
+
+    if (rc != SQLITE_DONE)
+    {
+        sqlite::errors::throw_sqlite_error(rc, sql);
+    }
+}
+
+/// Returns a digest of the columns of a row after the first, where blobs are
+/// represented by their length and CRC-32.
+uint64_t row_digest(sqlite3_stmt* stmt)
+{
+    content_hasher hasher;
+    auto column_count = sqlite3_column_count(stmt);
+    for (int i = 1; i < column_count; ++i)
+    {
+        auto type = static_cast<unsigned char>(sqlite3_column_type(stmt, i));
+        hasher.update(&type, sizeof type);
+        if (type == SQLITE_INTEGER)
+        {
+            auto value = sqlite3_column_int64(stmt, i);
+            hasher.update(&value, sizeof value);
+        }
+        else if (type == SQLITE_FLOAT)
+        {
+            auto value = sqlite3_column_double(stmt, i);
+            hasher.update(&value, sizeof value);
+        }
+        else if (type == SQLITE_TEXT || type == SQLITE_BLOB)
+        {
+            auto data = sqlite3_column_blob(stmt, i);
+            int64_t size = sqlite3_column_bytes(stmt, i);
+            hasher.update(&size, sizeof size);
+            if (type == SQLITE_BLOB)
+            {
+                uint32_t crc = crc32(
+                    0L, static_cast<const Bytef*>(data),
+                    static_cast<uInt>(size));
+                hasher.update(&crc, sizeof crc);
+            }
+            else if (size > 0)
+            {
+                hasher.update(data, static_cast<size_t>(size));
+            }
+        }
+    }
+
+    return hasher.digest();
+}
+
+/// Calls a function with each row of a query whose first column is a track
+/// ID, along with the fingerprint of that track.
+template <typename Function>
+void for_each_track_row(
+    el_storage& storage, const std::string& sql,
+    std::vector<track_fingerprint>& tracks, Function function)
+{
+    // Tables are scanned in storage order, rather than sorted by ID, and so
+    // rows are combined into digests by addition, which is independent of
+    // their order.  Rows of a track are usually stored together, and so the
+    // previous track is tried before searching for another.
+    auto iter = tracks.begin();
+    for_each_row(storage, sql, [&](sqlite3_stmt* stmt) {
+        auto id = sqlite3_column_int64(stmt, 0);
+        if (iter == tracks.end() || iter->id != id)
+        {
+            iter = std::lower_bound(
+                tracks.begin(), tracks.end(), id,
+                [](const track_fingerprint& track, int64_t id) {
+                    return track.id < id;
+                });
+        }
+
+        if (iter != tracks.end() && iter->id == id)
+        {
+            function(*iter, stmt);
+        }
+    });
+}
+
+std::vector<track_fingerprint> fingerprint_tracks(
+    el_storage& storage, const std::vector<std::string>& track_columns,
+    const std::vector<std::string>& performance_data_columns)
+{
+    std::vector<track_fingerprint> tracks;
+    for_each_row(
+        storage,
+        "SELECT id, path" +
+            (track_columns.empty() ? "" : ", " + column_list(track_columns)) +
+            " FROM Track WHERE path IS NOT NULL ORDER BY id",
+        [&](sqlite3_stmt* stmt) {
+            track_fingerprint track;
+            track.id = sqlite3_column_int64(stmt, 0);
+            track.relative_path = reinterpret_cast<const char*>(
+                sqlite3_column_text(stmt, 1));
+            track.track = row_digest(stmt);
+            tracks.push_back(std::move(track));
+        });
+
+    for_each_track_row(
+        storage, "SELECT id, type, text FROM MetaData", tracks,
+        [](track_fingerprint& track, sqlite3_stmt* stmt) {
+            track.metadata += row_digest(stmt);
+        });
+
+    for_each_track_row(
+        storage, "SELECT id, type, value FROM MetaDataInteger", tracks,
+        [](track_fingerprint& track, sqlite3_stmt* stmt) {
+            track.metadata += row_digest(stmt);
+            if (sqlite3_column_type(stmt, 2) == SQLITE_NULL)
+            {
+                return;
+            }
+
+            auto type = static_cast<metadata_int_type>(
+                sqlite3_column_int64(stmt, 1));
+            auto value = sqlite3_column_int64(stmt, 2);
+            if (type == metadata_int_type::hash)
+            {
+                track.content_hash = value;
+            }
+            else if (type == metadata_int_type::last_modified_ts)
+            {
+                track.last_modified = value;
+            }
+        });
+
+    if (!performance_data_columns.empty())
+    {
+        for_each_track_row(
+            storage,
+            "SELECT id, " + column_list(performance_data_columns) +
+                " FROM PerformanceData",
+            tracks, [](track_fingerprint& track, sqlite3_stmt* stmt) {
+                track.performance_data += row_digest(stmt);
+            });
+    }
+
+    return tracks;
+}
+
+library_sync_action resolve_conflict(
+    library_sync_conflict_policy policy, const track_fingerprint& first,
+    const track_fingerprint& second)
+{
+    switch (policy)
+    {
+        case library_sync_conflict_policy::prefer_first:
+            return library_sync_action::update_second;
+        case library_sync_conflict_policy::prefer_second:
+            return library_sync_action::update_first;
+        case library_sync_conflict_policy::prefer_newer:
+            if (first.last_modified.value_or(0) >
+                second.last_modified.value_or(0))
+            {
+                return library_sync_action::update_second;
+            }
+            else if (
+                second.last_modified.value_or(0) >
+                first.last_modified.value_or(0))
+            {
+                return library_sync_action::update_first;
+            }
+
+            return library_sync_action::conflict_skipped;
+        default: return library_sync_action::conflict_skipped;
+    }
+}
+
+std::string uuid_of(el_storage& storage)
+{
+    std::string uuid;
+    storage.db << "SELECT uuid FROM Information" >> uuid;
+    return uuid;
+}
+
+/// Apply copies and updates to a target storage from a source storage, and
+/// return the IDs of the copies.
+std::vector<int64_t> apply_changes(
+    const std::shared_ptr<el_storage>& target, el_storage& source,
+    const std::vector<int64_t>& copy_ids,
+    const std::vector<track_update>& updates,
+    const std::vector<std::string>& track_columns,
+    const std::vector<std::string>& performance_data_columns)
+{
+    if (copy_ids.empty() && updates.empty())
+    {
+        return {};
+    }
+
+    auto source_uuid = uuid_of(source);
+    el_attached_source attached{*target, source.directory};
+    el_transaction_guard_impl trans{target};
+    auto copied_ids = copy_attached_tracks(target, source_uuid, copy_ids);
+
+    // Statements are prepared once, and reused for every track.
+    auto update_track =
+        target->db << "UPDATE music.Track SET (" + column_list(track_columns) +
+                          ") = (SELECT " + column_list(track_columns) +
+                          " FROM source_music.Track WHERE id = ?) WHERE id = ?";
+    auto delete_metadata =
+        target->db << "DELETE FROM music.MetaData WHERE id = ?";
+    auto insert_metadata =
+        target->db << "INSERT INTO music.MetaData (id, type, text) SELECT ?, "
+                      "type, text FROM source_music.MetaData WHERE id = ?";
+    auto delete_metadata_int =
+        target->db << "DELETE FROM music.MetaDataInteger WHERE id = ?";
+    auto insert_metadata_int =
+        target->db << "INSERT INTO music.MetaDataInteger (id, type, value) "
+                      "SELECT ?, type, value FROM source_music.MetaDataInteger "
+                      "WHERE id = ?";
+    auto delete_performance_data =
+        target->db << "DELETE FROM perfdata.PerformanceData WHERE id = ?";
+    auto insert_performance_data =
+        target->db << "INSERT INTO perfdata.PerformanceData (id, " +
+                          column_list(performance_data_columns) +
+                          ") SELECT ?, " +
+                          column_list(performance_data_columns) +
+                          " FROM source_perfdata.PerformanceData WHERE id = ?";
+
+    for (auto&& update : updates)
+    {
+        if (update.track)
+        {
+            update_track << update.source_id << update.target_id;
+            update_track.execute();
+        }
+
+        if (update.metadata)
+        {
+            delete_metadata << update.target_id;
+            delete_metadata.execute();
+            insert_metadata << update.target_id << update.source_id;
+            insert_metadata.execute();
+            delete_metadata_int << update.target_id;
+            delete_metadata_int.execute();
+            insert_metadata_int << update.target_id << update.source_id;
+            insert_metadata_int.execute();
+        }
+
+        if (update.performance_data)
+        {
+            delete_performance_data << update.target_id;
+            delete_performance_data.execute();
+            insert_performance_data << update.target_id << update.source_id;
+            insert_performance_data.execute();
+        }
+    }
+
+    update_track.used(true);
+    delete_metadata.used(true);
+    insert_metadata.used(true);
+    delete_metadata_int.used(true);
+    insert_metadata_int.used(true);
+    delete_performance_data.used(true);
+    insert_performance_data.used(true);
+
+    trans.commit();
+    return copied_ids;
+}
+
+}  // namespace
+
+library_sync_report sync_library(
+    const std::shared_ptr<el_storage>& first,
+    const std::shared_ptr<el_storage>& second,
+    const library_sync_options& options)
+{
+    auto track_columns = shared_columns(
+        *first, *second, "music", "Track", local_track_columns);
+    auto performance_data_columns =
+        shared_columns(*first, *second, "perfdata", "PerformanceData", {"id"});
+    auto first_tracks =
+        fingerprint_tracks(*first, track_columns, performance_data_columns);
+    auto second_tracks =
+        fingerprint_tracks(*second, track_columns, performance_data_columns);
+
+    // Tracks are matched by relative path, and then by content hash.
+    std::vector<stdx::optional<size_t> > matches(first_tracks.size());
+    std::vector<bool> is_matched(second_tracks.size());
+    {
+        std::unordered_map<std::string, size_t> second_by_path;
+        for (size_t i = 0; i < second_tracks.size(); ++i)
+        {
+            second_by_path.emplace(second_tracks[i].relative_path, i);
+        }
+
+        for (size_t i = 0; i < first_tracks.size(); ++i)
+        {
+            auto iter = second_by_path.find(first_tracks[i].relative_path);
+            if (iter != second_by_path.end())
+            {
+                matches[i] = iter->second;
+                is_matched[iter->second] = true;
+            }
+        }
+
+        std::unordered_multimap<int64_t, size_t> second_by_hash;
+        for (size_t i = 0; i < second_tracks.size(); ++i)
+        {
+            if (!is_matched[i] && second_tracks[i].content_hash)
+            {
+                second_by_hash.emplace(*second_tracks[i].content_hash, i);
+            }
+        }
+
+        for (size_t i = 0; i < first_tracks.size(); ++i)
+        {
+            if (matches[i] || !first_tracks[i].content_hash)
+            {
+                continue;
+            }
+
+            auto iter = second_by_hash.find(*first_tracks[i].content_hash);
+            if (iter != second_by_hash.end())
+            {
+                matches[i] = iter->second;
+                is_matched[iter->second] = true;
+                second_by_hash.erase(iter);
+            }
+        }
+    }
+
+    library_sync_report report;
+    std::vector<int64_t> copies_to_first;
+    std::vector<int64_t> copies_to_second;
+    std::vector<size_t> copy_to_first_changes;
+    std::vector<size_t> copy_to_second_changes;
+    std::vector<track_update> first_updates;
+    std::vector<track_update> second_updates;
+    for (size_t i = 0; i < first_tracks.size(); ++i)
+    {
+        auto& first_track = first_tracks[i];
+        if (!matches[i])
+        {
+            if (options.copy_unmatched)
+            {
+                copy_to_second_changes.push_back(report.changes.size());
+                copies_to_second.push_back(first_track.id);
+                report.changes.push_back(library_sync_change{
+                    library_sync_action::copy_to_second, first_track.id,
+                    stdx::nullopt, first_track.relative_path});
+            }
+
+            continue;
+        }
+
+        ++report.matched_count;
+        auto& second_track = second_tracks[*matches[i]];
+        library_sync_change change{
+            library_sync_action::conflict_skipped, first_track.id,
+            second_track.id, first_track.relative_path,
+            first_track.track != second_track.track,
+            first_track.metadata != second_track.metadata,
+            first_track.performance_data != second_track.performance_data};
+        if (!change.track_differs && !change.metadata_differs &&
+            !change.performance_data_differs)
+        {
+            ++report.unchanged_count;
+            continue;
+        }
+
+        change.action = resolve_conflict(
+            options.conflict_policy, first_track, second_track);
+        if (change.action == library_sync_action::update_first)
+        {
+            change.relative_path = second_track.relative_path;
+            first_updates.push_back(track_update{
+                first_track.id, second_track.id, change.track_differs,
+                change.metadata_differs, change.performance_data_differs});
+        }
+        else if (change.action == library_sync_action::update_second)
+        {
+            second_updates.push_back(track_update{
+                second_track.id, first_track.id, change.track_differs,
+                change.metadata_differs, change.performance_data_differs});
+        }
+
+        report.changes.push_back(std::move(change));
+    }
+
+    for (size_t i = 0; i < second_tracks.size(); ++i)
+    {
+        if (!is_matched[i] && options.copy_unmatched)
+        {
+            copy_to_first_changes.push_back(report.changes.size());
+            copies_to_first.push_back(second_tracks[i].id);
+            report.changes.push_back(library_sync_change{
+                library_sync_action::copy_to_first, stdx::nullopt,
+                second_tracks[i].id, second_tracks[i].relative_path});
+        }
+    }
+
+    if (options.dry_run)
+    {
+        return report;
+    }
+
+    // The plan was made before either storage is changed, and each side only
+    // reads tracks of the other that it does not change, so the order in
+    // which the sides are changed does not matter.
+    auto copied_to_first = apply_changes(
+        first, *second, copies_to_first, first_updates, track_columns,
+        performance_data_columns);
+    auto copied_to_second = apply_changes(
+        second, *first, copies_to_second, second_updates, track_columns,
+        performance_data_columns);
+    for (size_t i = 0; i < copied_to_first.size(); ++i)
+    {
+        report.changes[copy_to_first_changes[i]].first_track_id =
+            copied_to_first[i];
+    }
+
+    for (size_t i = 0; i < copied_to_second.size(); ++i)
+    {
+        report.changes[copy_to_second_changes[i]].second_track_id =
+            copied_to_second[i];
+    }
+
+    return report;
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,44 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <djinterop/library_sync.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// Synchronise the tracks of two storages.
+///
+/// Tracks are matched by relative path, and then by content hash.  Each
+/// storage is read once to compute cheap fingerprints of every track, being
+/// digests of its `Track` row, of its metadata, and of its performance data,
+/// where the digest of each blob is its length and CRC-32.  Only the tracks,
+/// and the parts of each track, whose fingerprints differ are then copied,
+/// with a single transaction on each storage.
+library_sync_report sync_library(
+    const std::shared_ptr<el_storage>& first,
+    const std::shared_ptr<el_storage>& second,
+    const library_sync_options& options);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,391 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <djinterop/enginelibrary/el_similar_tracks.hpp>
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/parallel.hpp>
+#include <djinterop/text_folding.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// Words that are often added to or removed from artists and titles when
+/// tracks are re-tagged, and so are ignored when comparing them.
+constexpr std::array<std::string_view, 7> ignored_words{
+    "and", "feat", "featuring", "ft", "mix", "original", "the"};
+
+constexpr double title_weight = 0.5;
+constexpr double artist_weight = 0.3;
+constexpr double length_weight = 0.2;
+
+struct candidate
+{
+    int64_t id;
+    int64_t length_ms;
+    std::string artist;
+    std::string title;
+    std::vector<std::string> artist_words;
+    std::vector<std::string> title_words;
+    std::vector<uint64_t> block_keys;
+};
+
+/// Split folded text into its distinct words, in ascending order, where a
+/// word is a run of ASCII letters and digits or non-ASCII characters.
+std::vector<std::string> words_of(const std::string& text)
+{
+    std::vector<std::string> words;
+    std::string word;
+    auto end_word = [&] {
+        if (!word.empty() &&
+            std::find(ignored_words.begin(), ignored_words.end(), word) ==
+                ignored_words.end())
+        {
+            words.push_back(word);
+        }
+
+        word.clear();
+    };
+
+    for (auto c : fold_text(text))
+    {
+        auto byte = static_cast<unsigned char>(c);
+        if (byte >= 0x80 || (byte >= '0' && byte <= '9') ||
+            (byte >= 'a' && byte <= 'z'))
+        {
+            word.push_back(c);
+        }
+        else
+        {
+            end_word();
+        }
+    }
+
+    end_word();
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+/// Get the cosine similarity of two sets of words, or zero if either is empty.
+double word_similarity(
+    const std::vector<std::string>& a, const std::vector<std::string>& b)
+{
+    if (a.empty() || b.empty())
+    {
+        return 0;
+    }
+
+    size_t common = 0;
+    for (auto i = a.begin(), j = b.begin(); i != a.end() && j != b.end();)
+    {
+        if (*i < *j)
+        {
+            ++i;
+        }
+        else if (*j < *i)
+        {
+            ++j;
+        }
+        else
+        {
+            ++common;
+            ++i;
+            ++j;
+        }
+    }
+
+    return common / std::sqrt(static_cast<double>(a.size()) * b.size());
+}
+
+/// Add the key of the block of a given field, grid, and length bucket having
+/// the given words in that field, unless there are no words.
+///
+/// Keys are hashed, and so distinct blocks may rarely share a key, which only
+/// costs some needless comparisons.
+void add_block_key(
+    std::vector<uint64_t>& keys, char field, int grid, int64_t bucket,
+    const std::vector<std::string>& words)
+{
+    if (words.empty())
+    {
+        return;
+    }
+
+    std::string key{field, static_cast<char>('0' + grid)};
+    key += std::to_string(bucket);
+    for (auto&& word : words)
+    {
+        key += ' ';
+        key += word;
+    }
+
+    keys.push_back(std::hash<std::string>{}(key));
+}
+
+size_t find_root(std::vector<size_t>& parents, size_t index)
+{
+    while (parents[index] != index)
+    {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+
+    return index;
+}
+
+}  // namespace
+
+std::vector<similar_track_id_group> find_similar_tracks(
+    el_storage& storage, const similar_tracks_options& options)
+{
+    auto tolerance_ms = options.duration_tolerance.count();
+    if (tolerance_ms < 0 || !(options.min_score > 0) ||
+        options.min_score > 1 || options.max_threads == 0)
+    {
+        throw std::invalid_argument{
+            "Duration tolerance must not be negative, minimum score must be "
+            "in (0, 1], and maximum threads must be positive"};
+    }
+
+    std::vector<candidate> candidates;
+    storage.db << "SELECT t.id, t.length, a.text, ti.text FROM Track t "
+                  "LEFT JOIN MetaData a ON a.id = t.id AND a.type = ? "
+                  "LEFT JOIN MetaData ti ON ti.id = t.id AND ti.type = ? "
+                  "WHERE t.length IS NOT NULL ORDER BY t.id"
+               << static_cast<int64_t>(metadata_str_type::artist)
+               << static_cast<int64_t>(metadata_str_type::title) >>
+        [&](int64_t id, int64_t length, stdx::optional<std::string> artist,
+            stdx::optional<std::string> title) {
+            candidates.push_back(candidate{
+                id, length * 1000, artist.value_or(std::string{}),
+                title.value_or(std::string{}), {}, {}, {}});
+        };
+
+    // Lengths are bucketed on two grids offset by half a bucket, so that any
+    // two lengths within the tolerance share a bucket on at least one grid.
+    auto step = tolerance_ms + 1;
+    for_each_in_parallel(
+        candidates.size(), options.max_threads, [&](size_t index, size_t) {
+            auto& c = candidates[index];
+            c.artist_words = words_of(c.artist);
+            c.title_words = words_of(c.title);
+            for (int grid = 0; grid < 2; ++grid)
+            {
+                auto bucket = (c.length_ms + grid * step) / (2 * step);
+                add_block_key(c.block_keys, 'a', grid, bucket, c.artist_words);
+                add_block_key(c.block_keys, 't', grid, bucket, c.title_words);
+            }
+        });
+
+    std::vector<std::pair<uint64_t, uint32_t> > keyed_candidates;
+    for (uint32_t index = 0; index < candidates.size(); ++index)
+    {
+        for (auto key : candidates[index].block_keys)
+        {
+            keyed_candidates.emplace_back(key, index);
+        }
+    }
+
+    std::sort(keyed_candidates.begin(), keyed_candidates.end());
+
+    std::vector<std::vector<uint32_t> > blocks;
+    for (auto begin = keyed_candidates.begin();
+         begin != keyed_candidates.end();)
+    {
+        auto end = std::find_if(
+            begin, keyed_candidates.end(),
+            [&](const std::pair<uint64_t, uint32_t>& entry) {
+                return entry.first != begin->first;
+            });
+        if (end - begin > 1)
+        {
+            auto& block = blocks.emplace_back();
+            for (auto iter = begin; iter != end; ++iter)
+            {
+                block.push_back(iter->second);
+            }
+        }
+
+        begin = end;
+    }
+
+    // The largest blocks are compared first, so that they are not left to
+    // run on a single thread at the end.
+    std::sort(
+        blocks.begin(), blocks.end(),
+        [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+            return a.size() > b.size();
+        });
+
+    auto thread_count = std::min(options.max_threads, blocks.size());
+    std::vector<std::vector<similar_track_pair> > pairs_by_thread(
+        thread_count);
+    for_each_in_parallel(
+        blocks.size(), thread_count, [&](size_t index, size_t thread) {
+            auto& block = blocks[index];
+            for (size_t i = 0; i < block.size(); ++i)
+            {
+                auto& a = candidates[block[i]];
+                for (size_t j = i + 1; j < block.size(); ++j)
+                {
+                    auto& b = candidates[block[j]];
+                    auto length_difference =
+                        std::abs(a.length_ms - b.length_ms);
+                    if (block[i] == block[j] ||
+                        length_difference > tolerance_ms)
+                    {
+                        continue;
+                    }
+
+                    auto score =
+                        title_weight *
+                            word_similarity(a.title_words, b.title_words) +
+                        artist_weight *
+                            word_similarity(a.artist_words, b.artist_words) +
+                        length_weight *
+                            (tolerance_ms == 0
+                                 ? 1
+                                 : 1 - static_cast<double>(length_difference) /
+                                           tolerance_ms);
+                    if (score >= options.min_score)
+                    {
+                        pairs_by_thread[thread].push_back(similar_track_pair{
+                            std::min(block[i], block[j]),
+                            std::max(block[i], block[j]), score});
+                    }
+                }
+            }
+        });
+
+    // A pair may be found in more than one block.
+    std::vector<similar_track_pair> pairs;
+    for (auto&& thread_pairs : pairs_by_thread)
+    {
+        pairs.insert(pairs.end(), thread_pairs.begin(), thread_pairs.end());
+    }
+
+    auto same_tracks = [](const similar_track_pair& a,
+                          const similar_track_pair& b) {
+        return a.first == b.first && a.second == b.second;
+    };
+    std::sort(
+        pairs.begin(), pairs.end(),
+        [](const similar_track_pair& a, const similar_track_pair& b) {
+            return a.first != b.first ? a.first < b.first
+                                      : a.second < b.second;
+        });
+    pairs.erase(
+        std::unique(pairs.begin(), pairs.end(), same_tracks), pairs.end());
+
+    // Group the candidates connected by pairs.
+    std::vector<size_t> parents(candidates.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (auto&& pair : pairs)
+    {
+        parents[find_root(parents, pair.first)] =
+            find_root(parents, pair.second);
+    }
+
+    std::unordered_map<size_t, size_t> group_by_root;
+    std::vector<std::vector<size_t> > members_by_group;
+    std::vector<std::vector<similar_track_pair> > pairs_by_group;
+    for (auto&& pair : pairs)
+    {
+        auto root = find_root(parents, pair.first);
+        auto iter = group_by_root.emplace(root, members_by_group.size()).first;
+        if (iter->second == members_by_group.size())
+        {
+            members_by_group.emplace_back();
+            pairs_by_group.emplace_back();
+        }
+
+        members_by_group[iter->second].push_back(pair.first);
+        members_by_group[iter->second].push_back(pair.second);
+        pairs_by_group[iter->second].push_back(pair);
+    }
+
+    std::vector<similar_track_id_group> groups(members_by_group.size());
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        auto& members = members_by_group[g];
+        std::sort(members.begin(), members.end());
+        members.erase(
+            std::unique(members.begin(), members.end()), members.end());
+
+        auto local_index = [&](size_t index) {
+            return static_cast<size_t>(
+                std::lower_bound(members.begin(), members.end(), index) -
+                members.begin());
+        };
+
+        auto& group = groups[g];
+        for (auto member : members)
+        {
+            group.track_ids.push_back(candidates[member].id);
+        }
+
+        for (auto&& pair : pairs_by_group[g])
+        {
+            group.pairs.push_back(similar_track_pair{
+                local_index(pair.first), local_index(pair.second),
+                pair.score});
+        }
+
+        std::sort(
+            group.pairs.begin(), group.pairs.end(),
+            [](const similar_track_pair& a, const similar_track_pair& b) {
+                if (a.score != b.score)
+                {
+                    return a.score > b.score;
+                }
+
+                return a.first != b.first ? a.first < b.first
+                                          : a.second < b.second;
+            });
+    }
+
+    std::sort(
+        groups.begin(), groups.end(),
+        [](const similar_track_id_group& a, const similar_track_id_group& b) {
+            auto a_score = a.pairs.front().score;
+            auto b_score = b.pairs.front().score;
+            return a_score != b_score ? a_score > b_score
+                                      : a.track_ids.front() <
+                                            b.track_ids.front();
+        });
+
+    return groups;
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,53 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <djinterop/similar_tracks.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// A group of tracks connected by pairs of similar tracks, identified by ID.
+struct similar_track_id_group
+{
+    std::vector<int64_t> track_ids;
+    std::vector<similar_track_pair> pairs;
+};
+
+/// Find groups of tracks whose artist, title, and length are similar enough
+/// that they are likely to be duplicates of one another.
+///
+/// Tracks are only compared within blocks of tracks having the same folded
+/// artist or title words and a similar length, so that the number of
+/// comparisons grows with the size of the blocks rather than the square of
+/// the number of tracks.  Blocks are compared on a number of worker threads.
+///
+/// Groups are returned in descending order of their best pair score, and then
+/// in ascending order of their first track ID.
+std::vector<similar_track_id_group> find_similar_tracks(
+    el_storage& storage, const similar_tracks_options& options);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
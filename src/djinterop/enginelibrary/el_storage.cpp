@@ -17,7 +17,14 @@
 
 #include "el_storage.hpp"
 
+#include <algorithm>
+
 #include <djinterop/database.hpp>
+#include <djinterop/enginelibrary/el_autocomplete_index.hpp>
+#include <djinterop/enginelibrary/el_crate_impl.hpp>
+#include <djinterop/enginelibrary/el_harmonic_index.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_track_search_index.hpp>
 #include <djinterop/exceptions.hpp>
 
 #include "../util.hpp"
@@ -96,6 +103,9 @@ el_storage::el_storage(const std::string& directory) :
     version{get_version(db)},
     schema_creator_validator{schema::make_schema_creator_validator(version)}
 {
+    sqlite3_update_hook(db.connection().get(), &el_storage::on_update, this);
+    sqlite3_rollback_hook(db.connection().get(), &el_storage::on_rollback, this);
+    sqlite3_commit_hook(db.connection().get(), &el_storage::on_commit, this);
 }
 
 el_storage::el_storage(const std::string& directory, semantic_version version) :
@@ -105,6 +115,210 @@ el_storage::el_storage(const std::string& directory, semantic_version version) :
 {
     // Create the desired schema on the new database.
     schema_creator_validator->create(db);
+    sqlite3_update_hook(db.connection().get(), &el_storage::on_update, this);
+    sqlite3_rollback_hook(db.connection().get(), &el_storage::on_rollback, this);
+    sqlite3_commit_hook(db.connection().get(), &el_storage::on_commit, this);
+}
+
+el_storage::~el_storage()
+{
+    sqlite3_update_hook(db.connection().get(), nullptr, nullptr);
+    sqlite3_rollback_hook(db.connection().get(), nullptr, nullptr);
+    sqlite3_commit_hook(db.connection().get(), nullptr, nullptr);
+}
+
+int64_t el_storage::change_count(std::string_view table) const
+{
+    auto iter = change_counts_.find(table);
+    auto count = iter != change_counts_.end() ? iter->second : 0;
+    return count + rollback_count_;
+}
+
+int64_t el_storage::music_data_version()
+{
+    // The version may be read before every read of a cached row, and so the
+    // statement is prepared only once.
+    const char* sql = "PRAGMA music.data_version";
+    if (!data_version_stmt_)
+    {
+        sqlite3_stmt* raw_stmt = nullptr;
+        auto rc = sqlite3_prepare_v2(
+            db.connection().get(), sql, -1, &raw_stmt, nullptr);
+        data_version_stmt_.reset(raw_stmt);
+        if (rc != SQLITE_OK)
+        {
+            sqlite::errors::throw_sqlite_error(rc, sql);
+        }
+    }
+
+    auto rc = sqlite3_step(data_version_stmt_.get());
+    if (rc != SQLITE_ROW)
+    {
+        sqlite3_reset(data_version_stmt_.get());
+        sqlite::errors::throw_sqlite_error(rc, sql);
+    }
+
+    auto version = sqlite3_column_int64(data_version_stmt_.get(), 0);
+    sqlite3_reset(data_version_stmt_.get());
+    return version;
+}
+
+int64_t el_storage::current_transaction() const
+{
+    if (sqlite3_get_autocommit(db.connection().get()))
+    {
+        return 0;
+    }
+
+    // Every transaction ends with either a commit or a rollback, and so the
+    // number of transactions ended so far identifies the open one.
+    return commit_count_ + rollback_count_ + 1;
+}
+
+void el_storage::notify_rollback()
+{
+    ++rollback_count_;
+}
+
+void el_storage::apply_metadata_str_changes(
+    int64_t change_count_before, int64_t track_id,
+    const std::vector<
+        std::pair<metadata_str_type, stdx::optional<std::string> > >& changes)
+{
+    if (autocomplete_index)
+    {
+        autocomplete_index->apply(change_count_before, track_id, changes);
+    }
+
+    if (track_search_index)
+    {
+        track_search_index->apply(change_count_before, track_id, changes);
+    }
+}
+
+void el_storage::apply_metadata_int_changes(
+    int64_t change_count_before, int64_t track_id,
+    const std::vector<std::pair<metadata_int_type, stdx::optional<int64_t> > >&
+        changes)
+{
+    if (harmonic_index)
+    {
+        harmonic_index->apply_metadata_ints(
+            change_count_before, track_id, changes);
+    }
+}
+
+void el_storage::apply_track_row_changes(
+    int64_t change_count_before, int64_t track_id,
+    const stdx::optional<stdx::optional<double> >& bpm)
+{
+    if (harmonic_index)
+    {
+        harmonic_index->apply_track_row(change_count_before, track_id, bpm);
+    }
+}
+
+void el_storage::apply_track_removal(
+    int64_t metadata_change_count_before,
+    int64_t metadata_int_change_count_before,
+    int64_t track_change_count_before, const std::vector<int64_t>& track_ids)
+{
+    if (autocomplete_index)
+    {
+        autocomplete_index->apply_removal(
+            metadata_change_count_before, track_ids);
+    }
+
+    if (harmonic_index)
+    {
+        harmonic_index->apply_removal(
+            metadata_int_change_count_before, track_change_count_before,
+            track_ids);
+    }
+
+    if (track_search_index)
+    {
+        track_search_index->apply_removal(
+            metadata_change_count_before, track_ids);
+    }
+}
+
+template <typename Impl>
+std::shared_ptr<Impl> el_storage::make_impl(impl_kind kind, int64_t id)
+{
+    auto& entry = impls_[impl_key{kind, id}];
+    auto impl = std::static_pointer_cast<Impl>(entry.lock());
+    if (impl)
+    {
+        return impl;
+    }
+
+    impl = std::make_shared<Impl>(shared_from_this(), id);
+    entry = impl;
+
+    // Entries for impl objects that are no longer referenced are swept from
+    // time to time, so that the map does not grow without bound.
+    if (impls_.size() > impls_sweep_threshold_)
+    {
+        for (auto iter = impls_.begin(); iter != impls_.end();)
+        {
+            iter = iter->second.expired() ? impls_.erase(iter) : ++iter;
+        }
+        impls_sweep_threshold_ = std::max<size_t>(64, 2 * impls_.size());
+    }
+
+    return impl;
+}
+
+std::shared_ptr<el_crate_impl> el_storage::make_crate_impl(int64_t id)
+{
+    return make_impl<el_crate_impl>(impl_kind::crate, id);
+}
+
+std::shared_ptr<el_track_impl> el_storage::make_track_impl(int64_t id)
+{
+    return make_impl<el_track_impl>(impl_kind::track, id);
+}
+
+void el_storage::forget_crate_impl(int64_t id)
+{
+    impls_.erase(impl_key{impl_kind::crate, id});
+}
+
+void el_storage::forget_track_impl(int64_t id)
+{
+    impls_.erase(impl_key{impl_kind::track, id});
+}
+
+void el_storage::on_update(
+    void* self, int, const char* db_name, const char* table, sqlite3_int64)
+{
+    // Temporary tables are private to the library, and are never cached.
+    if (std::string_view{db_name} == "temp")
+    {
+        return;
+    }
+
+    auto& change_counts = static_cast<el_storage*>(self)->change_counts_;
+    auto iter = change_counts.find(std::string_view{table});
+    if (iter == change_counts.end())
+    {
+        iter = change_counts.emplace(table, 0).first;
+    }
+    ++iter->second;
+}
+
+void el_storage::on_rollback(void* self)
+{
+    static_cast<el_storage*>(self)->notify_rollback();
+}
+
+int el_storage::on_commit(void* self)
+{
+    ++static_cast<el_storage*>(self)->commit_count_;
+
+    // Returning zero allows the commit to proceed.
+    return 0;
 }
 
 }  // namespace djinterop::enginelibrary
@@ -17,17 +17,35 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <sqlite_modern_cpp.h>
 
+#include <djinterop/database.hpp>
+#include <djinterop/optional.hpp>
 #include <djinterop/semantic_version.hpp>
 
 #include "schema/schema.hpp"
 
 namespace djinterop::enginelibrary
 {
-class el_storage
+class el_autocomplete_index;
+class el_crate_impl;
+class el_crate_membership_index_impl;
+class el_harmonic_index;
+class el_track_impl;
+class el_track_search_index;
+enum class metadata_int_type;
+enum class metadata_str_type;
+
+class el_storage : public std::enable_shared_from_this<el_storage>
 {
 public:
     /// Construct by loading from an existing DB directory.
@@ -36,6 +54,102 @@ public:
     /// Construct by making a new, empty DB of a given version.
     el_storage(const std::string& directory, semantic_version version);
 
+    el_storage(const el_storage&) = delete;
+    el_storage& operator=(const el_storage&) = delete;
+
+    ~el_storage();
+
+    /// Get a counter of changes made to rows of a given table.
+    ///
+    /// The counter is incremented whenever a row of the table is inserted,
+    /// updated, or deleted, and also whenever a transaction or savepoint is
+    /// rolled back, as the rollback may have undone earlier changes.  It is
+    /// therefore suitable for detecting whether a cached copy of a row may be
+    /// stale.
+    int64_t change_count(std::string_view table) const;
+
+    /// Get the data version of the music database.
+    ///
+    /// The data version changes whenever another connection commits a change
+    /// to the music database, and so, together with the change counters, it
+    /// is suitable for detecting whether a cached copy of a row may be stale.
+    int64_t music_data_version();
+
+    /// Get an identifier of the transaction currently open on this storage's
+    /// connection, or zero if no transaction is open.
+    ///
+    /// The identifier differs between transactions, and so it is suitable for
+    /// performing a check at most once per transaction.
+    int64_t current_transaction() const;
+
+    /// Notify that a savepoint has been rolled back.
+    ///
+    /// SQLite does not report `ROLLBACK TO` statements via its rollback hook,
+    /// and so any code that rolls back to a savepoint must call this method.
+    void notify_rollback();
+
+    /// Apply changes to the metadata strings of a track, made via this
+    /// storage's connection, to any indexes of track metadata.
+    ///
+    /// The change counter of the `MetaData` table must be given as it was
+    /// just before the changes were made.
+    void apply_metadata_str_changes(
+        int64_t change_count_before, int64_t track_id,
+        const std::vector<
+            std::pair<metadata_str_type, stdx::optional<std::string> > >&
+            changes);
+
+    /// Apply changes to the metadata integers of a track, made via this
+    /// storage's connection, to any indexes of track metadata.
+    ///
+    /// The change counter of the `MetaDataInteger` table must be given as it
+    /// was just before the changes were made.
+    void apply_metadata_int_changes(
+        int64_t change_count_before, int64_t track_id,
+        const std::vector<
+            std::pair<metadata_int_type, stdx::optional<int64_t> > >& changes);
+
+    /// Apply changes to the `Track` row of a track, made via this storage's
+    /// connection, to any indexes of track metadata, where `bpm` is engaged if
+    /// the BPM was among the changes.
+    ///
+    /// The change counter of the `Track` table must be given as it was just
+    /// before the changes were made.
+    void apply_track_row_changes(
+        int64_t change_count_before, int64_t track_id,
+        const stdx::optional<stdx::optional<double> >& bpm);
+
+    /// Apply the removal of tracks, made via this storage's connection, to any
+    /// indexes of track metadata.
+    ///
+    /// The change counters of the `MetaData`, `MetaDataInteger`, and `Track`
+    /// tables must be given as they were just before the tracks were removed.
+    void apply_track_removal(
+        int64_t metadata_change_count_before,
+        int64_t metadata_int_change_count_before,
+        int64_t track_change_count_before,
+        const std::vector<int64_t>& track_ids);
+
+    /// Get the impl object for a given crate.
+    ///
+    /// If an impl object for the crate is still referenced elsewhere, the
+    /// same object is returned, so that any state cached within it is shared.
+    /// Otherwise, a new impl object is created.
+    std::shared_ptr<el_crate_impl> make_crate_impl(int64_t id);
+
+    /// Get the impl object for a given track.
+    ///
+    /// If an impl object for the track is still referenced elsewhere, the
+    /// same object is returned, so that any state cached within it is shared.
+    /// Otherwise, a new impl object is created.
+    std::shared_ptr<el_track_impl> make_track_impl(int64_t id);
+
+    /// Forget the impl object for a crate that has been removed.
+    void forget_crate_impl(int64_t id);
+
+    /// Forget the impl object for a track that has been removed.
+    void forget_track_impl(int64_t id);
+
     const std::string directory;
     // TODO - don't expose mutable SQLite connection - allow txn guard to be
     // obtained from el_storage by other EL classes.
@@ -45,6 +159,50 @@ public:
     const std::unique_ptr<schema::schema_creator_validator> schema_creator_validator;
 
     int64_t last_savepoint = 0;
+    int64_t last_temporary_table = 0;
+
+    /// How tracks cache their rows of the `Track` table.
+    track_row_cache_policy track_row_cache =
+        track_row_cache_policy::all_connections;
+
+    /// The crate membership index, if one has been loaded and is still
+    /// referenced elsewhere, to which changes to crate membership are applied.
+    std::weak_ptr<el_crate_membership_index_impl> crate_membership_index;
+
+    /// The indexes of track metadata, if they have been built, to which
+    /// changes to track metadata are applied.  They are kept for the lifetime
+    /// of the storage, as they are costly to build.
+    std::shared_ptr<el_autocomplete_index> autocomplete_index;
+    std::shared_ptr<el_harmonic_index> harmonic_index;
+    std::shared_ptr<el_track_search_index> track_search_index;
+
+private:
+    enum class impl_kind
+    {
+        crate,
+        track,
+    };
+
+    using impl_key = std::pair<impl_kind, int64_t>;
+
+    template <typename Impl>
+    std::shared_ptr<Impl> make_impl(impl_kind kind, int64_t id);
+
+    static void on_update(
+        void* self, int operation, const char* db_name, const char* table,
+        sqlite3_int64 row_id);
+    static void on_rollback(void* self);
+    static int on_commit(void* self);
+
+    std::map<std::string, int64_t, std::less<> > change_counts_;
+    int64_t rollback_count_ = 0;
+    int64_t commit_count_ = 0;
+
+    std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)>
+        data_version_stmt_{nullptr, &sqlite3_finalize};
+
+    std::map<impl_key, std::weak_ptr<void> > impls_;
+    size_t impls_sweep_threshold_ = 64;
 };
 
 }  // namespace djinterop::enginelibrary
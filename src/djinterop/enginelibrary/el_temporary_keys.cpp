@@ -0,0 +1,74 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_temporary_keys.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+el_temporary_keys::el_temporary_keys(
+    std::shared_ptr<el_storage> storage, const std::vector<int64_t>& keys) :
+    storage_{std::move(storage)},
+    table_{"temp.keys_" + std::to_string(++storage_->last_temporary_table)}
+{
+    fill(keys);
+}
+
+el_temporary_keys::el_temporary_keys(
+    std::shared_ptr<el_storage> storage,
+    const std::vector<std::string>& keys) :
+    storage_{std::move(storage)},
+    table_{"temp.keys_" + std::to_string(++storage_->last_temporary_table)}
+{
+    fill(keys);
+}
+
+el_temporary_keys::~el_temporary_keys()
+{
+    try
+    {
+        storage_->db << ("DROP TABLE IF EXISTS " + table_);
+    }
+    catch (...)
+    {
+        // The exception is intentionally swallowed, as the temporary table
+        // will in any case be dropped when the connection is closed.
+    }
+}
+
+template <typename T>
+void el_temporary_keys::fill(const std::vector<T>& keys)
+{
+    storage_->db
+        << ("CREATE TABLE " + table_ + " (position INTEGER PRIMARY KEY, key, value)");
+
+    // A single prepared statement is reused for every key.
+    auto insert = storage_->db
+                  << ("INSERT INTO " + table_ +
+                      " (position, key) VALUES (?, ?)");
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        insert << static_cast<int64_t>(i) << keys[i];
+        insert.execute();
+    }
+    insert.used(true);
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
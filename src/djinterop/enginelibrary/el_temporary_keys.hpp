@@ -0,0 +1,62 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// The `el_temporary_keys` class manages a temporary table holding a list of
+/// keys, so that many keys can be resolved in a single set-based query.
+///
+/// The table has three columns: `position`, which is the index of each key in
+/// the list it was constructed from, `key`, and `value`, which is initially
+/// null and may be used to hold data associated with each key.  The table is
+/// dropped when the object is destroyed.
+class el_temporary_keys
+{
+public:
+    el_temporary_keys(
+        std::shared_ptr<el_storage> storage, const std::vector<int64_t>& keys);
+    el_temporary_keys(
+        std::shared_ptr<el_storage> storage,
+        const std::vector<std::string>& keys);
+    el_temporary_keys(const el_temporary_keys&) = delete;
+    el_temporary_keys& operator=(const el_temporary_keys&) = delete;
+    ~el_temporary_keys();
+
+    /// Returns the qualified name of the temporary table
+    const std::string& table() const noexcept { return table_; }
+
+private:
+    template <typename T>
+    void fill(const std::vector<T>& keys);
+
+    std::shared_ptr<el_storage> storage_;
+    std::string table_;
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,293 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_temporary_keys.hpp>
+#include <djinterop/enginelibrary/el_track_copy.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// Returns the columns of a table other than `id` that are present in both
+/// a target schema and a source schema, in the order of the target schema.
+std::vector<std::string> common_columns(
+    el_storage& storage, const std::string& table,
+    const std::string& target_schema, const std::string& source_schema)
+{
+    std::set<std::string> source_columns;
+    storage.db << "SELECT name FROM pragma_table_info(?, ?)" << table
+               << source_schema >>
+        [&](std::string name) { source_columns.insert(std::move(name)); };
+
+    std::vector<std::string> columns;
+    storage.db << "SELECT name FROM pragma_table_info(?, ?)" << table
+               << target_schema >>
+        [&](std::string name) {
+            if (name != "id" && source_columns.count(name) != 0)
+            {
+                columns.push_back(std::move(name));
+            }
+        };
+
+    return columns;
+}
+
+}  // namespace
+
+el_attached_source::el_attached_source(
+    el_storage& storage, const std::string& directory) :
+    storage_{storage}
+{
+    storage_.db << "ATTACH ? AS source_music" << (directory + "/m.db");
+    try
+    {
+        storage_.db << "ATTACH ? AS source_perfdata" << (directory + "/p.db");
+    }
+    catch (...)
+    {
+        storage_.db << "DETACH source_music";
+        throw;
+    }
+}
+
+el_attached_source::~el_attached_source()
+{
+    try
+    {
+        storage_.db << "DETACH source_perfdata";
+        storage_.db << "DETACH source_music";
+    }
+    catch (...)
+    {
+        // The exception is intentionally swallowed, as the databases will in
+        // any case be detached when the connection is closed.
+    }
+}
+
+std::vector<int64_t> copy_attached_tracks(
+    const std::shared_ptr<el_storage>& storage, const std::string& source_uuid,
+    const std::vector<int64_t>& track_ids)
+{
+    if (track_ids.empty())
+    {
+        return {};
+    }
+
+    std::vector<int64_t> unique_ids;
+    {
+        std::set<int64_t> seen;
+        for (auto id : track_ids)
+        {
+            if (seen.insert(id).second)
+            {
+                unique_ids.push_back(id);
+            }
+        }
+    }
+
+    el_transaction_guard_impl trans{storage};
+    el_temporary_keys keys{storage, unique_ids};
+
+    stdx::optional<int64_t> missing_id;
+    storage->db << "SELECT k.key FROM " + keys.table() +
+                       " k WHERE NOT EXISTS (SELECT 1 FROM "
+                       "source_music.Track t WHERE t.id = k.key) LIMIT 1" >>
+        [&](int64_t id) { missing_id = id; };
+    if (missing_id)
+    {
+        throw track_deleted{*missing_id};
+    }
+
+    // Track paths are only unique by constraint in later schema versions, and
+    // so clashes are checked for explicitly, before anything is copied.
+    bool clash = false;
+    storage->db << "SELECT EXISTS (SELECT 1 FROM " + keys.table() +
+                       " k JOIN source_music.Track s ON s.id = k.key JOIN "
+                       "music.Track t ON t.path = s.path)" >>
+        clash;
+    if (clash)
+    {
+        throw std::runtime_error{
+            "A copied track path is already that of another track"};
+    }
+
+    // The copies are given consecutive IDs beyond any ever used, in the order
+    // of the tracks copied.
+    int64_t has_sequence;
+    storage->db << "SELECT COUNT(*) FROM music.sqlite_master WHERE name = "
+                   "'sqlite_sequence'" >>
+        has_sequence;
+    int64_t last_id;
+    storage->db << std::string{"SELECT max(coalesce((SELECT max(id) FROM "
+                               "music.Track), 0), "} +
+                       (has_sequence != 0
+                            ? "coalesce((SELECT seq FROM music.sqlite_sequence "
+                              "WHERE name = 'Track'), 0))"
+                            : "0)") >>
+        last_id;
+    storage->db << "UPDATE " + keys.table() + " SET value = ? + position + 1"
+                << last_id;
+
+    // Album art is shared between tracks, and so an identical row is reused
+    // where the target already has one.  An ID of one means no album art.
+    std::vector<int64_t> album_art_ids;
+    storage->db << "SELECT DISTINCT t.idAlbumArt FROM " + keys.table() +
+                       " k JOIN source_music.Track t ON t.id = k.key WHERE "
+                       "t.idAlbumArt IS NOT NULL" >>
+        [&](int64_t id) { album_art_ids.push_back(id); };
+    el_temporary_keys album_art_keys{storage, album_art_ids};
+    for (auto id : album_art_ids)
+    {
+        int64_t target_id = 1;
+        bool exists_in_source = false;
+        storage->db << "SELECT 1 FROM source_music.AlbumArt WHERE id = ?"
+                    << id >>
+            [&](int64_t) { exists_in_source = true; };
+        if (id > 1 && exists_in_source)
+        {
+            bool found = false;
+            storage->db << "SELECT d.id FROM music.AlbumArt d, "
+                           "source_music.AlbumArt s WHERE s.id = ? AND "
+                           "d.id > 1 AND d.hash IS s.hash AND "
+                           "d.albumArt IS s.albumArt ORDER BY d.id LIMIT 1"
+                        << id >>
+                [&](int64_t existing_id) {
+                    target_id = existing_id;
+                    found = true;
+                };
+            if (!found)
+            {
+                storage->db << "INSERT INTO music.AlbumArt (id, hash, "
+                               "albumArt) SELECT (SELECT max(coalesce(max(id), "
+                               "0), 1) + 1 FROM music.AlbumArt), hash, "
+                               "albumArt FROM source_music.AlbumArt WHERE "
+                               "id = ?"
+                            << id;
+                target_id = storage->db.last_insert_rowid();
+            }
+        }
+
+        storage->db << "UPDATE " + album_art_keys.table() +
+                           " SET value = ? WHERE key = ?"
+                    << target_id << id;
+    }
+
+    // Copy the track rows, remapping IDs via the temporary tables.
+    {
+        std::string columns = "id";
+        std::string values = "k.value";
+        for (auto&& column :
+             common_columns(*storage, "Track", "music", "source_music"))
+        {
+            columns += ", [" + column + "]";
+            values += column == "idAlbumArt"
+                          ? ", (SELECT a.value FROM " + album_art_keys.table() +
+                                " a WHERE a.key = t.idAlbumArt)"
+                          : ", t.[" + column + "]";
+        }
+
+        storage->db << "INSERT INTO music.Track (" + columns + ") SELECT " +
+                           values + " FROM " + keys.table() +
+                           " k JOIN source_music.Track t ON t.id = k.key "
+                           "ORDER BY k.position";
+    }
+
+    for (auto&& table : {"MetaData", "MetaDataInteger"})
+    {
+        std::string columns = "id";
+        std::string values = "k.value";
+        for (auto&& column :
+             common_columns(*storage, table, "music", "source_music"))
+        {
+            columns += ", [" + column + "]";
+            values += ", m.[" + column + "]";
+        }
+
+        storage->db << "INSERT INTO music." + std::string{table} + " (" +
+                           columns + ") SELECT " + values + " FROM " +
+                           keys.table() + " k JOIN source_music." + table +
+                           " m ON m.id = k.key";
+    }
+
+    {
+        std::string columns = "id";
+        std::string values = "k.value";
+        for (auto&& column : common_columns(
+                 *storage, "PerformanceData", "perfdata", "source_perfdata"))
+        {
+            columns += ", [" + column + "]";
+            values += ", p.[" + column + "]";
+        }
+
+        storage->db << "INSERT INTO perfdata.PerformanceData (" + columns +
+                           ") SELECT " + values + " FROM " + keys.table() +
+                           " k JOIN source_perfdata.PerformanceData p ON "
+                           "p.id = k.key";
+    }
+
+    // Every supported schema records where tracks were copied from.
+    storage->db << "INSERT INTO music.CopiedTrack (trackId, "
+                   "uuidOfSourceDatabase, idOfTrackInSourceDatabase) SELECT "
+                   "value, ?, key FROM " +
+                       keys.table()
+                << source_uuid;
+
+    std::unordered_map<int64_t, int64_t> copied_ids;
+    storage->db << "SELECT key, value FROM " + keys.table() >>
+        [&](int64_t id, int64_t copied_id) { copied_ids[id] = copied_id; };
+
+    trans.commit();
+
+    std::vector<int64_t> results;
+    results.reserve(track_ids.size());
+    for (auto id : track_ids)
+    {
+        results.push_back(copied_ids.at(id));
+    }
+
+    return results;
+}
+
+std::vector<int64_t> copy_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& source_directory, const std::string& source_uuid,
+    const std::vector<int64_t>& track_ids)
+{
+    if (track_ids.empty())
+    {
+        return {};
+    }
+
+    // Databases cannot be attached within a transaction, and so the source
+    // is attached first.
+    el_attached_source source{*storage, source_directory};
+    return copy_attached_tracks(storage, source_uuid, track_ids);
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
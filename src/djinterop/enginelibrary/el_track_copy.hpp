@@ -0,0 +1,67 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// Attaches the databases in another directory to a storage's connection, as
+/// the schemas `source_music` and `source_perfdata`, for the lifetime of the
+/// object.
+///
+/// Databases cannot be attached within a transaction.
+class el_attached_source
+{
+public:
+    el_attached_source(el_storage& storage, const std::string& directory);
+    el_attached_source(const el_attached_source&) = delete;
+    el_attached_source& operator=(const el_attached_source&) = delete;
+    ~el_attached_source();
+
+private:
+    el_storage& storage_;
+};
+
+/// Copy tracks from an attached source database into a storage, returning
+/// the IDs of the copies in the same order as the IDs of the tracks copied.
+///
+/// All rows of the tracks are copied by set-based `INSERT ... SELECT`
+/// statements, with performance data blobs copied verbatim.  Columns absent
+/// from either schema are not copied.
+std::vector<int64_t> copy_attached_tracks(
+    const std::shared_ptr<el_storage>& storage, const std::string& source_uuid,
+    const std::vector<int64_t>& track_ids);
+
+/// Copy tracks from the Engine Library database in another directory into a
+/// storage, returning the IDs of the copies in the same order as the IDs of
+/// the tracks copied.
+std::vector<int64_t> copy_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& source_directory, const std::string& source_uuid,
+    const std::vector<int64_t>& track_ids);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
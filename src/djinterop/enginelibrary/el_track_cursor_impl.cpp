@@ -0,0 +1,113 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_track_cursor_impl.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+el_track_cursor_impl::el_track_cursor_impl(
+    std::shared_ptr<el_storage> storage, std::string sql,
+    const std::vector<sql_parameter>& parameters) :
+    storage_{std::move(storage)},
+    sql_{std::move(sql)}, stmt_{nullptr, &sqlite3_finalize}
+{
+    sqlite3_stmt* raw_stmt = nullptr;
+    auto rc = sqlite3_prepare_v2(
+        storage_->db.connection().get(), sql_.c_str(), -1, &raw_stmt, nullptr);
+    stmt_.reset(raw_stmt);
+    if (rc != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(rc, sql_);
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        auto index = static_cast<int>(i + 1);
+        auto& parameter = parameters[i];
+        if (auto value = std::get_if<int64_t>(&parameter))
+        {
+            rc = sqlite3_bind_int64(stmt_.get(), index, *value);
+        }
+        else if (auto value = std::get_if<double>(&parameter))
+        {
+            rc = sqlite3_bind_double(stmt_.get(), index, *value);
+        }
+        else
+        {
+            auto& text = std::get<std::string>(parameter);
+            rc = sqlite3_bind_text(
+                stmt_.get(), index, text.data(), static_cast<int>(text.size()),
+                SQLITE_TRANSIENT);
+        }
+
+        if (rc != SQLITE_OK)
+        {
+            sqlite::errors::throw_sqlite_error(rc, sql_);
+        }
+    }
+}
+
+stdx::optional<track> el_track_cursor_impl::next()
+{
+    if (done_)
+    {
+        return stdx::nullopt;
+    }
+
+    auto rc = sqlite3_step(stmt_.get());
+    if (rc == SQLITE_DONE)
+    {
+        // Finalise early, so that the statement does not hold a read lock on
+        // the database for the remaining lifetime of the cursor.
+        done_ = true;
+        stmt_.reset();
+        return stdx::nullopt;
+    }
+    else if (rc != SQLITE_ROW)
+    {
+        sqlite::errors::throw_sqlite_error(rc, sql_);
+    }
+
+    auto id = sqlite3_column_int64(stmt_.get(), 0);
+    return track{storage_->make_track_impl(id)};
+}
+
+stdx::optional<sql_parameter> el_track_cursor_impl::column(int index) const
+{
+    switch (sqlite3_column_type(stmt_.get(), index))
+    {
+        case SQLITE_INTEGER: return sqlite3_column_int64(stmt_.get(), index);
+        case SQLITE_FLOAT: return sqlite3_column_double(stmt_.get(), index);
+        case SQLITE_NULL: return stdx::nullopt;
+        default:
+        {
+            auto text = reinterpret_cast<const char*>(
+                sqlite3_column_text(stmt_.get(), index));
+            auto size = sqlite3_column_bytes(stmt_.get(), index);
+            return std::string{text, static_cast<size_t>(size)};
+        }
+    }
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
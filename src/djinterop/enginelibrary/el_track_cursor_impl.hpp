@@ -0,0 +1,62 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/impl/track_cursor_impl.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// A value to be bound to a parameter of an SQL statement.
+using sql_parameter = std::variant<int64_t, double, std::string>;
+
+class el_track_cursor_impl : public djinterop::track_cursor_impl
+{
+public:
+    /// Prepare a query whose first result column is a track id, binding the
+    /// given parameters in order.
+    el_track_cursor_impl(
+        std::shared_ptr<el_storage> storage, std::string sql,
+        const std::vector<sql_parameter>& parameters);
+
+    stdx::optional<track> next() override;
+
+    /// Get the value of a column of the row of the track last returned by
+    /// `next()`, or `nullopt` if the value is null.
+    stdx::optional<sql_parameter> column(int index) const;
+
+private:
+    std::shared_ptr<el_storage> storage_;
+    std::string sql_;
+    std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> stmt_;
+    bool done_ = false;
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -16,14 +16,17 @@
  */
 
 #include <cmath>
+#include <functional>
 #include <iomanip>
 #include <sstream>
+#include <utility>
 
 #include <djinterop/djinterop.hpp>
 #include <djinterop/enginelibrary/el_crate_impl.hpp>
 #include <djinterop/enginelibrary/el_database_impl.hpp>
 #include <djinterop/enginelibrary/el_track_impl.hpp>
 #include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/track_edit.hpp>
 #include <djinterop/util.hpp>
 
 namespace djinterop
@@ -82,6 +85,148 @@ int64_t calculate_overview_waveform_samples_per_entry(
     return ((sample_count / qn) * qn) / 1024;
 }
 
+/// Calculate the integral BPM stored in the `bpm` column of the Track table.
+stdx::optional<int64_t> ceil_bpm(stdx::optional<double> bpm)
+{
+    stdx::optional<int64_t> ceiled_bpm;
+    if (bpm)
+    {
+        ceiled_bpm = static_cast<int64_t>(std::ceil(*bpm));
+    }
+    return ceiled_bpm;
+}
+
+/// Ceil a timestamp to the midnight at the end of the day.
+int64_t ceil_to_end_of_day(int64_t timestamp)
+{
+    auto secs_per_day = 86400;
+    timestamp += secs_per_day - 1;
+    timestamp -= timestamp % secs_per_day;
+    return timestamp;
+}
+
+/// Format a length in seconds as "MM:SS", as stored in the duration metadata.
+std::string format_duration_mm_ss(int64_t secs)
+{
+    std::ostringstream oss;
+    oss << std::setw(2) << std::setfill('0');
+    oss << (secs / 60);
+    oss << ":";
+    oss << (secs % 60);
+    return oss.str();
+}
+
+/// Calculate the overview waveform for a given high-resolution waveform.
+///
+/// Note that the overview waveform always has 1024 entries in it.
+overview_waveform_data make_overview_waveform_data(
+    const std::vector<waveform_entry>& waveform, int64_t sample_rate,
+    int64_t sample_count)
+{
+    overview_waveform_data overview_waveform_d;
+    overview_waveform_d.samples_per_entry =
+        calculate_overview_waveform_samples_per_entry(
+            sample_rate, sample_count);
+    overview_waveform_d.waveform.reserve(1024);
+    for (int32_t i = 0; i < 1024; ++i)
+    {
+        auto entry = waveform[waveform.size() * (2 * i + 1) / 2048];
+        overview_waveform_d.waveform.push_back(entry);
+    }
+    return overview_waveform_d;
+}
+
+/// Set the opacity of all overview waveform entries to 255.
+///
+/// As the overview waveform does not store opacity, it is defaulted to 255
+/// when read back.  If we also set it to 255 before writing, a round-trip
+/// encode/decode gives the same data.
+void normalise_overview_opacity(overview_waveform_data& data)
+{
+    for (auto&& entry : data.waveform)
+    {
+        entry.low.opacity = 255;
+        entry.mid.opacity = 255;
+        entry.high.opacity = 255;
+    }
+}
+
+/// A column assignment in an `UPDATE` statement, along with a function that
+/// binds the value to be assigned.
+struct column_assignment
+{
+    std::string column;
+    std::function<void(sqlite::database_binder&)> bind;
+};
+
+template <typename T>
+column_assignment assign(std::string column, T value)
+{
+    return column_assignment{
+        std::move(column),
+        [value = std::move(value)](sqlite::database_binder& binder) {
+            binder << value;
+        }};
+}
+
+/// Execute a single `UPDATE` statement for the row with the given ID,
+/// assigning all of the given columns at once.
+void update_row(
+    sqlite::database& db, const char* table,
+    const std::vector<column_assignment>& assignments, int64_t id)
+{
+    if (assignments.empty())
+    {
+        return;
+    }
+
+    std::string sql = std::string{"UPDATE "} + table + " SET ";
+    for (size_t i = 0; i < assignments.size(); ++i)
+    {
+        if (i != 0)
+        {
+            sql += ", ";
+        }
+        sql += assignments[i].column + " = ?";
+    }
+    sql += " WHERE id = ?";
+
+    auto binder = db << sql;
+    for (auto&& assignment : assignments)
+    {
+        assignment.bind(binder);
+    }
+    binder << id;
+    binder.execute();
+}
+
+/// Execute a single multi-row `REPLACE` statement into a metadata table, with
+/// one row per type/value pair.
+template <typename Type, typename Value>
+void replace_metadata(
+    sqlite::database& db, const char* table, const char* value_column,
+    const std::vector<std::pair<Type, Value> >& rows, int64_t id)
+{
+    if (rows.empty())
+    {
+        return;
+    }
+
+    std::string sql = std::string{"REPLACE INTO "} + table + " (id, type, " +
+                      value_column + ") VALUES ";
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        sql += i == 0 ? "(?, ?, ?)" : ", (?, ?, ?)";
+    }
+
+    auto binder = db << sql;
+    for (auto&& row : rows)
+    {
+        binder << id << static_cast<int64_t>(row.first) << row.second;
+    }
+    binder.execute();
+}
+
 }  // namespace
 
 el_track_impl::el_track_impl(std::shared_ptr<el_storage> storage, int64_t id) :
@@ -89,6 +234,144 @@ el_track_impl::el_track_impl(std::shared_ptr<el_storage> storage, int64_t id) :
 {
 }
 
+el_track_impl::row_cache_batch::row_cache_batch(el_track_impl& track) :
+    track_{track}
+{
+    track_.row_cache_batch_ = true;
+    track_.row_cache_checked_in_ = -1;
+}
+
+el_track_impl::row_cache_batch::~row_cache_batch()
+{
+    track_.row_cache_batch_ = false;
+}
+
+bool el_track_impl::row_cache_fresh(int64_t change_count)
+{
+    auto policy = storage_->track_row_cache;
+    if (!row_cache_ || policy == track_row_cache_policy::disabled ||
+        row_cache_change_count_ != change_count)
+    {
+        return false;
+    }
+
+    if (policy == track_row_cache_policy::this_connection)
+    {
+        return true;
+    }
+
+    // The row may also have been changed by another connection, such as
+    // Engine itself.  Another connection cannot change what is read within a
+    // transaction once it has started reading, and so the check need only be
+    // made once per transaction, or once per batch of reads outside of one.
+    auto transaction = storage_->current_transaction();
+    if (row_cache_checked_in_ == transaction &&
+        (transaction != 0 || row_cache_batch_))
+    {
+        return true;
+    }
+
+    row_cache_checked_in_ = transaction;
+    return row_cache_data_version_ == storage_->music_data_version();
+}
+
+sqlite3_value* el_track_impl::cell(const char* column_name)
+{
+    auto change_count = storage_->change_count("Track");
+    if (!row_cache_fresh(change_count))
+    {
+        row_cache_.reset();
+
+        // The data version is read before the row, so that a change committed
+        // by another connection in between is noticed on the next read.
+        int64_t data_version = 0;
+        if (storage_->track_row_cache ==
+            track_row_cache_policy::all_connections)
+        {
+            data_version = storage_->music_data_version();
+            row_cache_checked_in_ = storage_->current_transaction();
+        }
+
+        auto sql = "SELECT * FROM Track WHERE id = ?";
+        sqlite3_stmt* raw_stmt = nullptr;
+        auto rc = sqlite3_prepare_v2(
+            storage_->db.connection().get(), sql, -1, &raw_stmt, nullptr);
+        std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> stmt{
+            raw_stmt, &sqlite3_finalize};
+        if (rc != SQLITE_OK)
+        {
+            sqlite::errors::throw_sqlite_error(rc, sql);
+        }
+
+        sqlite3_bind_int64(stmt.get(), 1, id());
+        rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_DONE)
+        {
+            throw track_deleted{id()};
+        }
+        else if (rc != SQLITE_ROW)
+        {
+            sqlite::errors::throw_sqlite_error(rc, sql);
+        }
+
+        std::vector<cached_cell> row;
+        auto column_count = sqlite3_column_count(stmt.get());
+        row.reserve(column_count);
+        for (int i = 0; i < column_count; ++i)
+        {
+            row.push_back(cached_cell{
+                sqlite3_column_name(stmt.get(), i),
+                {sqlite3_value_dup(sqlite3_column_value(stmt.get(), i)),
+                 &sqlite3_value_free}});
+        }
+
+        if (sqlite3_step(stmt.get()) == SQLITE_ROW)
+        {
+            throw track_database_inconsistency{
+                "More than one track with the same ID", id()};
+        }
+
+        row_cache_ = std::move(row);
+        row_cache_change_count_ = change_count;
+        row_cache_data_version_ = data_version;
+    }
+
+    for (auto&& c : *row_cache_)
+    {
+        if (c.column_name == column_name)
+        {
+            return c.value.get();
+        }
+    }
+
+    throw std::invalid_argument{
+        "No column named " + std::string{column_name} + " in Track table"};
+}
+
+void el_track_impl::read_cell(const char* column_name, double& result)
+{
+    result = sqlite3_value_double(cell(column_name));
+}
+
+void el_track_impl::read_cell(const char* column_name, int32_t& result)
+{
+    result = sqlite3_value_int(cell(column_name));
+}
+
+void el_track_impl::read_cell(const char* column_name, int64_t& result)
+{
+    result = sqlite3_value_int64(cell(column_name));
+}
+
+void el_track_impl::read_cell(const char* column_name, std::string& result)
+{
+    auto value = cell(column_name);
+    auto text = sqlite3_value_text(value);
+    result = text ? std::string{reinterpret_cast<const char*>(text),
+                                static_cast<size_t>(sqlite3_value_bytes(value))}
+                  : std::string{};
+}
+
 stdx::optional<std::string> el_track_impl::get_metadata_str(
     metadata_str_type type)
 {
@@ -121,17 +404,22 @@ void el_track_impl::set_metadata_str(
     }
     else
     {
+        auto change_count = storage_->change_count("MetaData");
         storage_->db
             << "REPLACE INTO MetaData (id, type, text) VALUES (?, ?, ?)" << id()
             << static_cast<int64_t>(type) << nullptr;
+        storage_->apply_metadata_str_changes(
+            change_count, id(), {{type, stdx::nullopt}});
     }
 }
 
 void el_track_impl::set_metadata_str(
     metadata_str_type type, const std::string& content)
 {
+    auto change_count = storage_->change_count("MetaData");
     storage_->db << "REPLACE INTO MetaData (id, type, text) VALUES (?, ?, ?)"
                  << id() << static_cast<int64_t>(type) << content;
+    storage_->apply_metadata_str_changes(change_count, id(), {{type, content}});
 }
 
 stdx::optional<int64_t> el_track_impl::get_metadata_int(metadata_int_type type)
@@ -159,9 +447,59 @@ stdx::optional<int64_t> el_track_impl::get_metadata_int(metadata_int_type type)
 void el_track_impl::set_metadata_int(
     metadata_int_type type, stdx::optional<int64_t> content)
 {
+    auto change_count = storage_->change_count("MetaDataInteger");
     storage_->db
         << "REPLACE INTO MetaDataInteger (id, type, value) VALUES (?, ?, ?)"
         << id() << static_cast<int64_t>(type) << content;
+    storage_->apply_metadata_int_changes(
+        change_count, id(), {{type, content}});
+}
+
+void el_track_impl::ensure_perfdata_row()
+{
+    bool found = false;
+    storage_->db << "SELECT COUNT(*) FROM PerformanceData WHERE id = ?"
+                 << id() >>
+        [&](int32_t count) {
+            if (count == 1)
+            {
+                found = true;
+            }
+            else if (count > 1)
+            {
+                throw track_database_inconsistency{
+                    "More than one PerformanceData entry for the same "
+                    "track",
+                    id()};
+            }
+        };
+
+    if (!found)
+    {
+        storage_->db
+            << "INSERT INTO PerformanceData (id, isAnalyzed, isRendered, "
+               "trackData, highResolutionWaveFormData, "
+               "overviewWaveFormData, beatData, quickCues, loops, "
+               "hasSeratoValues) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+            << id()                               //
+            << 1.0                                // isAnalyzed
+            << 0.0                                // isRendered
+            << track_data{}.encode()              //
+            << high_res_waveform_data{}.encode()  //
+            << overview_waveform_data{}.encode()  //
+            << beat_data{}.encode()               //
+            << quick_cues_data{}.encode()         //
+            << loops_data{}.encode()              //
+            << 0.0;                               // hasSeratoValues
+
+        if (storage_->version >= version_1_7_1)
+        {
+            storage_->db
+                << "UPDATE PerformanceData SET hasRekordboxValues = 0 "
+                   "WHERE id = ?"
+                << id();
+        }
+    }
 }
 
 beat_data el_track_impl::get_beat_data()
@@ -201,15 +539,7 @@ overview_waveform_data el_track_impl::get_overview_waveform_data()
 
 void el_track_impl::set_overview_waveform_data(overview_waveform_data data)
 {
-    // As the overview waveform does not store opacity, it is defaulted to 255
-    // when read back.  If we also set it to 255 here, we can apply a check in
-    // `set_perfdata` that a round-trip encode/decode gives the same data.
-    for (auto&& entry : data.waveform)
-    {
-        entry.low.opacity = 255;
-        entry.mid.opacity = 255;
-        entry.high.opacity = 255;
-    }
+    normalise_overview_opacity(data);
     set_perfdata("overviewWaveFormData", data);
 }
 
@@ -343,13 +673,12 @@ stdx::optional<double> el_track_impl::bpm()
 
 void el_track_impl::set_bpm(stdx::optional<double> bpm)
 {
-    set_cell("bpmAnalyzed", bpm);
-    stdx::optional<int64_t> ceiled_bpm;
-    if (bpm)
-    {
-        ceiled_bpm = static_cast<int64_t>(std::ceil(*bpm));
-    }
-    set_cell("bpm", ceiled_bpm);
+    row_cache_.reset();
+    auto change_count = storage_->change_count("Track");
+    update_row(
+        storage_->db, "Track",
+        {assign("bpmAnalyzed", bpm), assign("bpm", ceil_bpm(bpm))}, id());
+    storage_->apply_track_row_changes(change_count, id(), bpm);
 }
 
 stdx::optional<std::string> el_track_impl::comment()
@@ -372,6 +701,341 @@ void el_track_impl::set_composer(stdx::optional<std::string> composer)
     set_metadata_str(metadata_str_type::composer, composer);
 }
 
+void el_track_impl::commit_edit(const track_changes& changes)
+{
+    el_transaction_guard_impl trans{storage_};
+
+    // A zero sample rate is interpreted as no sample rate.
+    auto sampling = changes.sampling;
+    if (sampling && *sampling && (*sampling)->sample_rate == 0)
+    {
+        *sampling = stdx::nullopt;
+    }
+
+    std::vector<column_assignment> track_cells;
+    std::vector<std::pair<metadata_str_type, stdx::optional<std::string> > >
+        metadata_strs;
+    std::vector<std::pair<metadata_int_type, stdx::optional<int64_t> > >
+        metadata_ints;
+
+    auto add_metadata_str =
+        [&](metadata_str_type type,
+            const stdx::optional<stdx::optional<std::string> >& change) {
+            if (change)
+            {
+                metadata_strs.emplace_back(type, *change);
+            }
+        };
+    add_metadata_str(metadata_str_type::album, changes.album);
+    add_metadata_str(metadata_str_type::artist, changes.artist);
+    add_metadata_str(metadata_str_type::comment, changes.comment);
+    add_metadata_str(metadata_str_type::composer, changes.composer);
+    add_metadata_str(metadata_str_type::genre, changes.genre);
+    add_metadata_str(metadata_str_type::publisher, changes.publisher);
+    add_metadata_str(metadata_str_type::title, changes.title);
+
+    if (changes.album_art_id)
+    {
+        // 1 is the magic number for "no album art"
+        track_cells.push_back(
+            assign("idAlbumArt", changes.album_art_id->value_or(1)));
+    }
+
+    if (changes.bitrate)
+    {
+        track_cells.push_back(assign("bitrate", *changes.bitrate));
+    }
+
+    if (changes.bpm)
+    {
+        track_cells.push_back(assign("bpmAnalyzed", *changes.bpm));
+        track_cells.push_back(assign("bpm", ceil_bpm(*changes.bpm)));
+    }
+
+    if (changes.import_info)
+    {
+        auto& import_info = *changes.import_info;
+        if (import_info)
+        {
+            track_cells.push_back(assign("isExternalTrack", int64_t{1}));
+            track_cells.push_back(
+                assign("uuidOfExternalDatabase", import_info->external_db_uuid));
+            track_cells.push_back(assign(
+                "idTrackInExternalDatabase", import_info->external_track_id));
+        }
+        else
+        {
+            track_cells.push_back(assign("isExternalTrack", int64_t{0}));
+            track_cells.push_back(assign("uuidOfExternalDatabase", nullptr));
+            track_cells.push_back(assign("idTrackInExternalDatabase", nullptr));
+        }
+    }
+
+    if (changes.key)
+    {
+        stdx::optional<int64_t> key_num;
+        if (*changes.key)
+        {
+            key_num = static_cast<int64_t>(**changes.key);
+        }
+        metadata_ints.emplace_back(metadata_int_type::musical_key, key_num);
+    }
+
+    if (changes.last_accessed_at)
+    {
+        auto timestamp = to_timestamp(*changes.last_accessed_at);
+        if (timestamp)
+        {
+            timestamp = ceil_to_end_of_day(*timestamp);
+        }
+        metadata_ints.emplace_back(
+            metadata_int_type::last_accessed_ts, timestamp);
+    }
+
+    if (changes.last_modified_at)
+    {
+        metadata_ints.emplace_back(
+            metadata_int_type::last_modified_ts,
+            to_timestamp(*changes.last_modified_at));
+    }
+
+    if (changes.last_played_at)
+    {
+        metadata_strs.emplace_back(
+            metadata_str_type::ever_played,
+            std::string{*changes.last_played_at ? "1" : "0"});
+        metadata_ints.emplace_back(
+            metadata_int_type::last_played_ts,
+            to_timestamp(*changes.last_played_at));
+    }
+
+    if (changes.relative_path)
+    {
+        auto filename = get_filename(*changes.relative_path);
+        track_cells.push_back(assign("path", *changes.relative_path));
+        track_cells.push_back(assign("filename", filename));
+        metadata_strs.emplace_back(
+            metadata_str_type::file_extension, get_file_extension(filename));
+    }
+
+    if (sampling)
+    {
+        stdx::optional<int64_t> secs;
+        stdx::optional<std::string> duration_mm_ss;
+        if (*sampling)
+        {
+            secs = static_cast<int64_t>(
+                (*sampling)->sample_count / (*sampling)->sample_rate);
+            duration_mm_ss = format_duration_mm_ss(*secs);
+        }
+        track_cells.push_back(assign("length", secs));
+        track_cells.push_back(assign("lengthCalculated", secs));
+        metadata_strs.emplace_back(
+            metadata_str_type::duration_mm_ss, std::move(duration_mm_ss));
+    }
+
+    if (changes.track_number)
+    {
+        track_cells.push_back(assign("playOrder", *changes.track_number));
+    }
+
+    if (changes.year)
+    {
+        track_cells.push_back(assign("year", *changes.year));
+    }
+
+    row_cache_.reset();
+    auto change_count = storage_->change_count("Track");
+    update_row(storage_->db, "Track", track_cells, id());
+    storage_->apply_track_row_changes(change_count, id(), changes.bpm);
+
+    change_count = storage_->change_count("MetaData");
+    replace_metadata(storage_->db, "MetaData", "text", metadata_strs, id());
+    storage_->apply_metadata_str_changes(change_count, id(), metadata_strs);
+
+    change_count = storage_->change_count("MetaDataInteger");
+    replace_metadata(
+        storage_->db, "MetaDataInteger", "value", metadata_ints, id());
+    storage_->apply_metadata_int_changes(change_count, id(), metadata_ints);
+
+    // Each performance data column is read at most once, and all modified
+    // columns are written back in a single statement.
+    std::vector<column_assignment> perfdata_cells;
+
+    stdx::optional<track_data> track_d;
+    if (changes.average_loudness || changes.key || sampling ||
+        changes.waveform)
+    {
+        track_d = get_track_data();
+    }
+
+    // The sampling info that the track will have after the edit.
+    auto effective_sampling = sampling ? *sampling : stdx::nullopt;
+    if (!sampling && track_d)
+    {
+        effective_sampling = track_d->sampling;
+    }
+    int64_t sample_rate = effective_sampling ? effective_sampling->sample_rate
+                                             : 0;
+    int64_t sample_count = effective_sampling
+                               ? effective_sampling->sample_count
+                               : 0;
+
+    if (changes.average_loudness || changes.key || sampling)
+    {
+        if (changes.average_loudness)
+        {
+            // Zero average loudness is interpreted as no average loudness.
+            auto& average_loudness = *changes.average_loudness;
+            track_d->average_loudness = average_loudness.value_or(0) == 0
+                                            ? stdx::nullopt
+                                            : average_loudness;
+        }
+        if (changes.key)
+        {
+            track_d->key = *changes.key;
+        }
+        if (sampling)
+        {
+            track_d->sampling = *sampling;
+        }
+        perfdata_cells.push_back(
+            assign("trackData", encode_perfdata("trackData", *track_d)));
+    }
+
+    if (changes.adjusted_beatgrid || changes.default_beatgrid || sampling)
+    {
+        auto beat_d = get_beat_data();
+        if (changes.adjusted_beatgrid)
+        {
+            beat_d.adjusted_beatgrid = *changes.adjusted_beatgrid;
+        }
+        if (changes.default_beatgrid)
+        {
+            beat_d.default_beatgrid = *changes.default_beatgrid;
+        }
+        if (sampling)
+        {
+            beat_d.sampling = *sampling;
+        }
+        perfdata_cells.push_back(
+            assign("beatData", encode_perfdata("beatData", beat_d)));
+    }
+
+    auto has_change = [](const auto& array) {
+        for (auto&& change : array)
+        {
+            if (change)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (changes.adjusted_main_cue || changes.default_main_cue ||
+        has_change(changes.hot_cues))
+    {
+        auto quick_cues_d = get_quick_cues_data();
+        if (changes.adjusted_main_cue)
+        {
+            quick_cues_d.adjusted_main_cue = *changes.adjusted_main_cue;
+        }
+        if (changes.default_main_cue)
+        {
+            quick_cues_d.default_main_cue = *changes.default_main_cue;
+        }
+        for (size_t i = 0; i < changes.hot_cues.size(); ++i)
+        {
+            if (changes.hot_cues[i])
+            {
+                quick_cues_d.hot_cues[i] = *changes.hot_cues[i];
+            }
+        }
+        perfdata_cells.push_back(assign(
+            "quickCues", encode_perfdata("quickCues", quick_cues_d)));
+    }
+
+    if (has_change(changes.loops))
+    {
+        auto loops_d = get_loops_data();
+        for (size_t i = 0; i < changes.loops.size(); ++i)
+        {
+            if (changes.loops[i])
+            {
+                loops_d.loops[i] = *changes.loops[i];
+            }
+        }
+        perfdata_cells.push_back(
+            assign("loops", encode_perfdata("loops", loops_d)));
+    }
+
+    stdx::optional<high_res_waveform_data> high_res_waveform_d;
+    stdx::optional<overview_waveform_data> overview_waveform_d;
+    if (changes.waveform)
+    {
+        high_res_waveform_d = high_res_waveform_data{};
+        overview_waveform_d = overview_waveform_data{};
+        if (!changes.waveform->empty())
+        {
+            *overview_waveform_d = make_overview_waveform_data(
+                *changes.waveform, sample_rate, sample_count);
+
+            // Make the assumption that the client has respected the required
+            // number of samples per entry when constructing the waveform.
+            high_res_waveform_d->samples_per_entry =
+                quantisation_number(sample_rate);
+            high_res_waveform_d->waveform = *changes.waveform;
+        }
+    }
+    else if (sampling)
+    {
+        // Existing waveforms must have their samples-per-entry recalculated
+        // for the new sampling info.
+        auto existing_high_res_d = get_high_res_waveform_data();
+        if (!existing_high_res_d.waveform.empty())
+        {
+            existing_high_res_d.samples_per_entry =
+                quantisation_number(sample_rate);
+            high_res_waveform_d = std::move(existing_high_res_d);
+        }
+
+        auto existing_overview_d = get_overview_waveform_data();
+        if (!existing_overview_d.waveform.empty())
+        {
+            existing_overview_d.samples_per_entry =
+                calculate_overview_waveform_samples_per_entry(
+                    sample_rate, sample_count);
+            overview_waveform_d = std::move(existing_overview_d);
+        }
+    }
+
+    if (high_res_waveform_d)
+    {
+        perfdata_cells.push_back(assign(
+            "highResolutionWaveFormData",
+            encode_perfdata(
+                "highResolutionWaveFormData", *high_res_waveform_d)));
+    }
+
+    if (overview_waveform_d)
+    {
+        normalise_overview_opacity(*overview_waveform_d);
+        perfdata_cells.push_back(assign(
+            "overviewWaveFormData",
+            encode_perfdata("overviewWaveFormData", *overview_waveform_d)));
+    }
+
+    if (!perfdata_cells.empty())
+    {
+        ensure_perfdata_row();
+        perfdata_cells.push_back(assign("isAnalyzed", int64_t{1}));
+        update_row(storage_->db, "PerformanceData", perfdata_cells, id());
+    }
+
+    trans.commit();
+}
+
 database el_track_impl::db()
 {
     return database{std::make_shared<el_database_impl>(storage_)};
@@ -384,7 +1048,7 @@ std::vector<crate> el_track_impl::containing_crates()
                  << id() >>
         [&](int64_t id) {
             results.push_back(
-                crate{std::make_shared<el_crate_impl>(storage_, id)});
+                crate{storage_->make_crate_impl(id)});
         };
     return results;
 }
@@ -490,6 +1154,7 @@ void el_track_impl::set_hot_cues(std::array<stdx::optional<hot_cue>, 8> cues)
 
 stdx::optional<track_import_info> el_track_impl::import_info()
 {
+    row_cache_batch batch{*this};
     if (get_cell<int64_t>("isExternalTrack") == 0)
     {
         return stdx::nullopt;
@@ -585,10 +1250,7 @@ void el_track_impl::set_last_accessed_at(
         // leave the decision whether to ceil it to the library user. Also, it
         // would make `el_track_impl::last_accessed_at()` consistent with the
         // value that has been set using this method.
-        auto timestamp = *to_timestamp(accessed_at);
-        auto secs_per_day = 86400;
-        timestamp += secs_per_day - 1;
-        timestamp -= timestamp % secs_per_day;
+        auto timestamp = ceil_to_end_of_day(*to_timestamp(accessed_at));
         set_metadata_int(metadata_int_type::last_accessed_ts, timestamp);
     }
     else
@@ -736,13 +1398,8 @@ void el_track_impl::set_sampling(stdx::optional<sampling_info> sampling)
             sampling->sample_count / sampling->sample_rate);
 
         // Set metadata duration_mm_ss as "MM:SS"
-        std::ostringstream oss;
-        oss << std::setw(2) << std::setfill('0');
-        oss << (*secs / 60);
-        oss << ":";
-        oss << (*secs % 60);
-        auto str = oss.str();
-        set_metadata_str(metadata_str_type::duration_mm_ss, std::string{str});
+        set_metadata_str(
+            metadata_str_type::duration_mm_ss, format_duration_mm_ss(*secs));
     }
     else
     {
@@ -830,16 +1487,8 @@ void el_track_impl::set_waveform(std::vector<waveform_entry> waveform)
         int64_t sample_rate = smp ? smp->sample_rate : 0;
 
         // Calculate an overview waveform automatically.
-        // Note that the overview waveform always has 1024 entries in it.
-        overview_waveform_d.samples_per_entry =
-            calculate_overview_waveform_samples_per_entry(
-                sample_rate, sample_count);
-        overview_waveform_d.waveform.reserve(1024);
-        for (int32_t i = 0; i < 1024; ++i)
-        {
-            auto entry = waveform[waveform.size() * (2 * i + 1) / 2048];
-            overview_waveform_d.waveform.push_back(entry);
-        }
+        overview_waveform_d = make_overview_waveform_data(
+            waveform, sample_rate, sample_count);
 
         // Make the assumption that the client has respected the required number
         // of samples per entry when constructing the waveform.
@@ -78,34 +78,20 @@ public:
     template <typename T>
     T get_cell(const char* column_name)
     {
-        stdx::optional<T> result;
-        storage_->db << (std::string{"SELECT "} + column_name +
-                         " FROM Track WHERE id = ?")
-                     << id() >>
-            [&](T cell) {
-                if (!result)
-                {
-                    result = cell;
-                }
-                else
-                {
-                    throw track_database_inconsistency{
-                        "More than one track with the same ID", id()};
-                }
-            };
-        if (!result)
-        {
-            throw track_deleted{id()};
-        }
-        return *result;
+        T result;
+        read_cell(column_name, result);
+        return result;
     }
 
     template <typename T>
     void set_cell(const char* column_name, const T& content)
     {
+        row_cache_.reset();
+        auto change_count = storage_->change_count("Track");
         storage_->db << (std::string{"UPDATE Track SET "} + column_name +
                          " = ? WHERE id = ?")
                      << content << id();
+        storage_->apply_track_row_changes(change_count, id(), stdx::nullopt);
     }
 
     template <typename T>
@@ -132,7 +118,7 @@ public:
     }
 
     template <typename T>
-    void set_perfdata(const char* column_name, const T& content)
+    std::vector<char> encode_perfdata(const char* column_name, const T& content)
     {
         auto encoded_content = content.encode();
         // Check that subsequent reads can correctly decode what we are about to
@@ -147,57 +133,23 @@ public:
                 " is not invariant under encoding and subsequent decoding. "
                 "This is a bug in libdjinterop."};
         }
+        return encoded_content;
+    }
 
-        bool found = false;
-        storage_->db << "SELECT COUNT(*) FROM PerformanceData WHERE id = ?"
-                     << id() >>
-            [&](int32_t count) {
-                if (count == 1)
-                {
-                    found = true;
-                }
-                else if (count > 1)
-                {
-                    throw track_database_inconsistency{
-                        "More than one PerformanceData entry for the same "
-                        "track",
-                        id()};
-                }
-            };
-
-        if (!found)
-        {
-            storage_->db
-                << "INSERT INTO PerformanceData (id, isAnalyzed, isRendered, "
-                   "trackData, highResolutionWaveFormData, "
-                   "overviewWaveFormData, beatData, quickCues, loops, "
-                   "hasSeratoValues) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
-                << id()                               //
-                << 1.0                                // isAnalyzed
-                << 0.0                                // isRendered
-                << track_data{}.encode()              //
-                << high_res_waveform_data{}.encode()  //
-                << overview_waveform_data{}.encode()  //
-                << beat_data{}.encode()               //
-                << quick_cues_data{}.encode()         //
-                << loops_data{}.encode()              //
-                << 0.0;                               // hasSeratoValues
-
-            // TODO (haslersn): Don't allocate during the version() call
-            if (db().version() >= version_1_7_1)
-            {
-                storage_->db
-                    << "UPDATE PerformanceData SET hasRekordboxValues = 0 "
-                       "WHERE id = ?"
-                    << id();
-            }
-        }
-
+    template <typename T>
+    void set_perfdata(const char* column_name, const T& content)
+    {
+        auto encoded_content = encode_perfdata(column_name, content);
+        ensure_perfdata_row();
         storage_->db << (std::string{"UPDATE PerformanceData SET "} +
                          column_name + " = ?, isAnalyzed = 1 WHERE id = ?")
                      << encoded_content << id();
     }
 
+    /// Insert an empty PerformanceData row for this track, if there is not
+    /// one already.
+    void ensure_perfdata_row();
+
     beat_data get_beat_data();
     void set_beat_data(beat_data data);
     high_res_waveform_data get_high_res_waveform_data();
@@ -232,6 +184,7 @@ public:
     void set_comment(stdx::optional<std::string> comment) override;
     stdx::optional<std::string> composer() override;
     void set_composer(stdx::optional<std::string> composer) override;
+    void commit_edit(const track_changes& changes) override;
     std::vector<djinterop::crate> containing_crates() override;
     database db() override;
     std::vector<beatgrid_marker> default_beatgrid() override;
@@ -290,7 +243,64 @@ public:
     void set_year(stdx::optional<int32_t> year) override;
 
 private:
+    /// A copy of a single cell of the Track table.
+    struct cached_cell
+    {
+        std::string column_name;
+        std::unique_ptr<sqlite3_value, decltype(&sqlite3_value_free)> value;
+    };
+
+    /// Marks a scope in which several cells are read, so that changes by
+    /// other connections are checked for only once within it.
+    class row_cache_batch
+    {
+    public:
+        explicit row_cache_batch(el_track_impl& track);
+        ~row_cache_batch();
+
+        row_cache_batch(const row_cache_batch&) = delete;
+        row_cache_batch& operator=(const row_cache_batch&) = delete;
+
+    private:
+        el_track_impl& track_;
+    };
+
+    /// Get a cell of the Track row for this track, from the row cache.
+    ///
+    /// The whole row is (re-)loaded into the cache with a single query if it
+    /// has not been loaded yet, or if the Track table may have changed since,
+    /// as judged by the storage's track row cache policy.
+    sqlite3_value* cell(const char* column_name);
+
+    /// Determine whether the row cache may be used, as judged by the
+    /// storage's track row cache policy.
+    bool row_cache_fresh(int64_t change_count);
+
+    template <typename T>
+    void read_cell(const char* column_name, stdx::optional<T>& result)
+    {
+        if (sqlite3_value_type(cell(column_name)) == SQLITE_NULL)
+        {
+            result = stdx::nullopt;
+            return;
+        }
+
+        T value;
+        read_cell(column_name, value);
+        result = std::move(value);
+    }
+
+    void read_cell(const char* column_name, double& result);
+    void read_cell(const char* column_name, int32_t& result);
+    void read_cell(const char* column_name, int64_t& result);
+    void read_cell(const char* column_name, std::string& result);
+
     std::shared_ptr<el_storage> storage_;
+    stdx::optional<std::vector<cached_cell> > row_cache_;
+    int64_t row_cache_change_count_ = 0;
+    int64_t row_cache_data_version_ = 0;
+    int64_t row_cache_checked_in_ = -1;
+    bool row_cache_batch_ = false;
 };
 
 }  // namespace enginelibrary
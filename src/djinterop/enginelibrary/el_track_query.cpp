@@ -0,0 +1,622 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_track_query.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// The location at which a field of a track is stored.
+struct field_location
+{
+    /// Table holding the field, being `Track`, `MetaData`, or
+    /// `MetaDataInteger`
+    const char* table;
+
+    /// Column holding the field
+    const char* column;
+
+    /// Type of the metadata holding the field, if not in the `Track` table
+    int64_t type;
+};
+
+field_location location_of(track_field field)
+{
+    auto str = [](metadata_str_type type) {
+        return field_location{"MetaData", "text", static_cast<int64_t>(type)};
+    };
+
+    switch (field)
+    {
+        case track_field::album: return str(metadata_str_type::album);
+        case track_field::artist: return str(metadata_str_type::artist);
+        case track_field::bitrate: return {"Track", "bitrate", 0};
+        case track_field::bpm: return {"Track", "bpmAnalyzed", 0};
+        case track_field::comment: return str(metadata_str_type::comment);
+        case track_field::composer: return str(metadata_str_type::composer);
+        case track_field::duration: return {"Track", "length", 0};
+        case track_field::file_extension:
+            return str(metadata_str_type::file_extension);
+        case track_field::filename: return {"Track", "filename", 0};
+        case track_field::genre: return str(metadata_str_type::genre);
+        case track_field::key:
+            return {
+                "MetaDataInteger", "value",
+                static_cast<int64_t>(metadata_int_type::musical_key)};
+        case track_field::publisher: return str(metadata_str_type::publisher);
+        case track_field::relative_path: return {"Track", "path", 0};
+        case track_field::title: return str(metadata_str_type::title);
+        case track_field::track_number: return {"Track", "playOrder", 0};
+        case track_field::year: return {"Track", "year", 0};
+    }
+
+    throw std::invalid_argument{"Unknown track field"};
+}
+
+/// Compile the comparison made by a predicate, to be applied to a column.
+std::string compile_comparison(
+    const track_query::predicate& pred, std::vector<sql_parameter>& parameters)
+{
+    for (auto&& value : pred.values)
+    {
+        parameters.push_back(value.get());
+    }
+
+    switch (pred.op)
+    {
+        case track_query::comparison::equal: return " = ?";
+        case track_query::comparison::not_equal: return " != ?";
+        case track_query::comparison::less: return " < ?";
+        case track_query::comparison::less_equal: return " <= ?";
+        case track_query::comparison::greater: return " > ?";
+        case track_query::comparison::greater_equal: return " >= ?";
+        case track_query::comparison::between: return " BETWEEN ? AND ?";
+        case track_query::comparison::in:
+        {
+            std::string sql = " IN (";
+            for (size_t i = 0; i < pred.values.size(); ++i)
+            {
+                sql += i == 0 ? "?" : ", ?";
+            }
+            return sql + ")";
+        }
+        case track_query::comparison::missing: return " IS NULL";
+    }
+
+    throw std::invalid_argument{"Unknown comparison"};
+}
+
+/// Compile the predicates of a query to a conjunction, or to an empty string
+/// if there are none.
+///
+/// Predicates on metadata are compiled to subqueries over a single type of
+/// metadata, so that the indexes on the value of metadata can be used.
+std::string compile_predicates(
+    const track_query& query, std::vector<sql_parameter>& parameters)
+{
+    // At most one predicate on metadata drives the query, by way of the index
+    // on the metadata value, preferring exact matches of text as these are
+    // typically the most selective.  Other predicates on metadata are checked
+    // per track, by way of the primary key of the metadata table.
+    auto& predicates = query.predicates();
+    auto driving = predicates.size();
+    for (size_t i = 0; i < predicates.size(); ++i)
+    {
+        auto& pred = predicates[i];
+        auto location = location_of(pred.field);
+        auto exact = pred.op == track_query::comparison::equal ||
+                     pred.op == track_query::comparison::in;
+        auto ranged = exact || pred.op == track_query::comparison::between;
+        if (location.type != 0 && ranged && !pred.values.empty() &&
+            (driving == predicates.size() ||
+             (exact && is_text_field(pred.field) &&
+              !is_text_field(predicates[driving].field))))
+        {
+            driving = i;
+        }
+    }
+
+    std::string sql;
+    for (size_t i = 0; i < predicates.size(); ++i)
+    {
+        auto& pred = predicates[i];
+        sql += sql.empty() ? "" : " AND ";
+        auto location = location_of(pred.field);
+        auto type = std::to_string(location.type);
+        if (pred.op == track_query::comparison::in && pred.values.empty())
+        {
+            sql += "0";
+        }
+        else if (location.type == 0)
+        {
+            sql += std::string{"t."} + location.column +
+                   compile_comparison(pred, parameters);
+        }
+        else if (pred.op == track_query::comparison::missing)
+        {
+            sql += std::string{"NOT EXISTS (SELECT 1 FROM "} + location.table +
+                   " WHERE id = t.id AND type = " + type + " AND " +
+                   location.column + " IS NOT NULL)";
+        }
+        else if (i == driving)
+        {
+            // Every track has a row of every type of metadata, and so the
+            // index on the type is suppressed in favour of that on the value.
+            sql += std::string{"t.id IN (SELECT id FROM "} + location.table +
+                   " WHERE +type = " + type + " AND " + location.column +
+                   compile_comparison(pred, parameters) + ")";
+        }
+        else
+        {
+            sql += std::string{"EXISTS (SELECT 1 FROM "} + location.table +
+                   " WHERE id = t.id AND type = " + type + " AND " +
+                   location.column + compile_comparison(pred, parameters) +
+                   ")";
+        }
+    }
+
+    return sql;
+}
+
+/// The columns holding the sort keys of a query, and the joins by which they
+/// are reached from the `Track` table.
+struct sort_columns
+{
+    /// The join needed for each sort key, being empty for keys held in the
+    /// `Track` table
+    std::vector<std::string> joins;
+
+    std::vector<std::string> columns;
+
+    /// Get the joins needed for the sort keys from a given index onwards.
+    std::string joins_from(size_t first) const
+    {
+        std::string sql;
+        for (size_t i = first; i < joins.size(); ++i)
+        {
+            sql += joins[i];
+        }
+
+        return sql;
+    }
+};
+
+/// Compile the sort keys of a query, reaching each key on metadata by a join
+/// on the primary key of the metadata table.
+sort_columns compile_sort_columns(const track_query& query)
+{
+    sort_columns result;
+    auto& sort_keys = query.sort_keys();
+    for (size_t i = 0; i < sort_keys.size(); ++i)
+    {
+        auto location = location_of(sort_keys[i].field);
+        if (location.type == 0)
+        {
+            result.joins.emplace_back();
+            result.columns.push_back(std::string{"t."} + location.column);
+        }
+        else
+        {
+            auto alias = "s" + std::to_string(i);
+            result.joins.push_back(
+                std::string{" LEFT JOIN "} + location.table + " " + alias +
+                " ON " + alias + ".id = t.id AND " + alias +
+                ".type = " + std::to_string(location.type));
+            result.columns.push_back(alias + "." + location.column);
+        }
+    }
+
+    return result;
+}
+
+/// Compile an ordering by the sort keys from a given index onwards, with
+/// missing values last, and ties broken by track ID.
+std::string compile_order_by(
+    const track_query& query, const std::vector<std::string>& columns,
+    size_t first)
+{
+    std::string sql;
+    for (size_t i = first; i < columns.size(); ++i)
+    {
+        sql += columns[i] + " IS NULL, " + columns[i] +
+               (query.sort_keys()[i].descending ? " DESC, " : ", ");
+    }
+
+    return sql + "t.id";
+}
+
+using sql_value = stdx::optional<sql_parameter>;
+
+/// The position of a track within a sorted listing.
+struct page_position
+{
+    /// Whether the track lacks a value for the first sort key, and so is
+    /// listed after all tracks that have one
+    bool missing_first_key;
+
+    /// Values of the sort keys of the track
+    std::vector<sql_value> values;
+
+    /// ID of the track
+    int64_t id;
+};
+
+constexpr char token_version = '1';
+
+void invalid_token()
+{
+    throw std::invalid_argument{"Invalid continuation token"};
+}
+
+std::string encode_position(const page_position& position)
+{
+    std::string token{token_version};
+    token += position.missing_first_key ? 'm' : 'v';
+    for (auto&& value : position.values)
+    {
+        if (!value)
+        {
+            token += 'n';
+        }
+        else if (auto integer = std::get_if<int64_t>(&*value))
+        {
+            token += 'i' + std::to_string(*integer) + ';';
+        }
+        else if (auto real = std::get_if<double>(&*value))
+        {
+            // Reals are encoded by their bit pattern, so as to be exact.
+            uint64_t bits;
+            std::memcpy(&bits, real, sizeof bits);
+            token += 'r' + std::to_string(bits) + ';';
+        }
+        else
+        {
+            auto& text = std::get<std::string>(*value);
+            token += 's' + std::to_string(text.size()) + ':' + text;
+        }
+    }
+
+    return token + 'i' + std::to_string(position.id) + ';';
+}
+
+page_position decode_position(const std::string& token, size_t key_count)
+{
+    size_t pos = 0;
+    auto read_field = [&](char terminator) {
+        auto end = token.find(terminator, pos);
+        if (end == std::string::npos || end == pos)
+        {
+            invalid_token();
+        }
+
+        auto field = token.substr(pos, end - pos);
+        pos = end + 1;
+        return field;
+    };
+    auto read_number = [&](char terminator) {
+        auto field = read_field(terminator);
+        size_t length;
+        int64_t number;
+        try
+        {
+            number = std::stoll(field, &length);
+        }
+        catch (const std::exception&)
+        {
+            invalid_token();
+        }
+
+        if (length != field.size())
+        {
+            invalid_token();
+        }
+
+        return number;
+    };
+    auto read_bits = [&](char terminator) {
+        // Bit patterns are unsigned, and so may exceed the range of `stoll`.
+        // Unlike the digits, a sign would be accepted by `stoull`.
+        auto field = read_field(terminator);
+        if (!std::isdigit(static_cast<unsigned char>(field[0])))
+        {
+            invalid_token();
+        }
+
+        size_t length;
+        uint64_t bits;
+        try
+        {
+            bits = std::stoull(field, &length);
+        }
+        catch (const std::exception&)
+        {
+            invalid_token();
+        }
+
+        if (length != field.size())
+        {
+            invalid_token();
+        }
+
+        return bits;
+    };
+
+    if (token.size() < 2 || token[0] != token_version ||
+        (token[1] != 'm' && token[1] != 'v'))
+    {
+        invalid_token();
+    }
+
+    page_position position;
+    position.missing_first_key = token[1] == 'm';
+    pos = 2;
+    while (position.values.size() < key_count)
+    {
+        if (pos == token.size())
+        {
+            invalid_token();
+        }
+
+        auto tag = token[pos++];
+        switch (tag)
+        {
+            case 'n': position.values.emplace_back(); break;
+            case 'i': position.values.emplace_back(read_number(';')); break;
+            case 'r':
+            {
+                auto bits = read_bits(';');
+                double real;
+                std::memcpy(&real, &bits, sizeof real);
+                position.values.emplace_back(real);
+                break;
+            }
+            case 's':
+            {
+                auto length = static_cast<size_t>(read_number(':'));
+                if (length > token.size() - pos)
+                {
+                    invalid_token();
+                }
+
+                position.values.emplace_back(token.substr(pos, length));
+                pos += length;
+                break;
+            }
+            default: invalid_token();
+        }
+    }
+
+    if (pos == token.size() || token[pos++] != 'i')
+    {
+        invalid_token();
+    }
+
+    position.id = read_number(';');
+    if (pos != token.size() ||
+        (key_count > 0 && position.missing_first_key == !!position.values[0]))
+    {
+        invalid_token();
+    }
+
+    return position;
+}
+
+/// Compile a predicate that the sort keys from a given index onwards,
+/// followed by the track ID, come strictly after those of a position.
+std::string compile_after(
+    const track_query& query, const std::vector<std::string>& columns,
+    const page_position& position, size_t first,
+    std::vector<sql_parameter>& parameters)
+{
+    if (first == columns.size())
+    {
+        parameters.emplace_back(position.id);
+        return "t.id > ?";
+    }
+
+    auto& column = columns[first];
+    auto& value = position.values[first];
+    if (!value)
+    {
+        return "(" + column + " IS NULL AND " +
+               compile_after(query, columns, position, first + 1, parameters) +
+               ")";
+    }
+
+    auto descending = query.sort_keys()[first].descending;
+    parameters.push_back(*value);
+    parameters.push_back(*value);
+    auto sql = "(" + column + (descending ? " < ?" : " > ?") + " OR " +
+               column + " IS NULL OR (" + column + " = ? AND ";
+    return sql +
+           compile_after(query, columns, position, first + 1, parameters) +
+           "))";
+}
+
+}  // namespace
+
+std::string compile_track_query(
+    const track_query& query, std::vector<sql_parameter>& parameters)
+{
+    auto sort = compile_sort_columns(query);
+    auto where = compile_predicates(query, parameters);
+    auto sql = "SELECT t.id FROM Track t" + sort.joins_from(0) +
+               (where.empty() ? "" : " WHERE " + where) + " ORDER BY " +
+               compile_order_by(query, sort.columns, 0);
+    if (query.max_results())
+    {
+        sql += " LIMIT ?";
+        parameters.emplace_back(static_cast<int64_t>(*query.max_results()));
+    }
+
+    return sql;
+}
+
+track_page fetch_track_page(
+    const std::shared_ptr<el_storage>& storage, const track_query& query,
+    size_t page_size, const stdx::optional<std::string>& continuation_token)
+{
+    if (page_size == 0)
+    {
+        throw std::invalid_argument{"Page size must be positive"};
+    }
+
+    auto& sort_keys = query.sort_keys();
+    stdx::optional<page_position> after;
+    if (continuation_token)
+    {
+        after = decode_position(*continuation_token, sort_keys.size());
+    }
+
+    // One more track than fits on the page is fetched, so as to know whether
+    // there is a further page.
+    track_page page;
+    stdx::optional<page_position> last_position;
+    auto fetch = [&](const std::string& sql,
+                     std::vector<sql_parameter> parameters,
+                     bool missing_first_key) {
+        parameters.emplace_back(
+            static_cast<int64_t>(page_size + 1 - page.tracks.size()));
+        el_track_cursor_impl cursor{storage, sql + " LIMIT ?", parameters};
+        while (auto tr = cursor.next())
+        {
+            if (page.tracks.size() == page_size)
+            {
+                page.continuation_token = encode_position(*last_position);
+                return;
+            }
+
+            page_position position{missing_first_key, {}, tr->id()};
+            for (size_t i = 0; i < sort_keys.size(); ++i)
+            {
+                position.values.push_back(
+                    cursor.column(static_cast<int>(i + 1)));
+            }
+
+            page.tracks.push_back(*tr);
+            last_position = std::move(position);
+        }
+    };
+
+    auto sort = compile_sort_columns(query);
+    std::string select = "SELECT t.id";
+    for (auto&& column : sort.columns)
+    {
+        select += ", " + column;
+    }
+
+    std::vector<sql_parameter> parameters;
+    auto predicates = compile_predicates(query, parameters);
+    if (sort_keys.empty())
+    {
+        auto sql = select + " FROM Track t WHERE " +
+                   (predicates.empty() ? "" : predicates + " AND ");
+        if (after)
+        {
+            parameters.emplace_back(after->id);
+        }
+
+        fetch(
+            sql + (after ? "t.id > ?" : "1") + " ORDER BY t.id", parameters,
+            false);
+        return page;
+    }
+
+    // Tracks having a value for the first sort key are listed first.  When
+    // that key is held in metadata, the metadata table is scanned first, so
+    // that the index on the metadata value can both find the position of the
+    // page and give the order of the tracks.
+    auto first = location_of(sort_keys[0].field);
+    auto& first_column = sort.columns[0];
+    auto descending = sort_keys[0].descending;
+    if (!after || !after->missing_first_key)
+    {
+        auto from = first.type == 0
+                        ? std::string{" FROM Track t"}
+                        : std::string{" FROM "} + first.table +
+                              " s0 JOIN Track t ON t.id = s0.id";
+
+        std::string where = first_column + " IS NOT NULL";
+        if (first.type != 0)
+        {
+            where += " AND +s0.type = " + std::to_string(first.type);
+        }
+
+        auto phase_parameters = parameters;
+        if (!predicates.empty())
+        {
+            where += " AND " + predicates;
+        }
+
+        if (after)
+        {
+            phase_parameters.push_back(*after->values[0]);
+            phase_parameters.push_back(*after->values[0]);
+            phase_parameters.push_back(*after->values[0]);
+            where += " AND " + first_column + (descending ? " <= ?" : " >= ?") +
+                     " AND (" + first_column + (descending ? " < ?" : " > ?") +
+                     " OR (" + first_column + " = ? AND " +
+                     compile_after(
+                         query, sort.columns, *after, 1, phase_parameters) +
+                     "))";
+        }
+
+        auto order_by = first_column + (descending ? " DESC, " : ", ") +
+                        compile_order_by(query, sort.columns, 1);
+        fetch(
+            select + from + sort.joins_from(1) + " WHERE " + where +
+                " ORDER BY " + order_by,
+            phase_parameters, false);
+        if (page.continuation_token)
+        {
+            return page;
+        }
+    }
+
+    std::string where = first_column + " IS NULL";
+    if (!predicates.empty())
+    {
+        where += " AND " + predicates;
+    }
+
+    if (after && after->missing_first_key)
+    {
+        where += " AND " +
+                 compile_after(query, sort.columns, *after, 1, parameters);
+    }
+
+    fetch(
+        select + " FROM Track t" + sort.joins_from(0) + " WHERE " + where +
+            " ORDER BY " + compile_order_by(query, sort.columns, 1),
+        parameters, true);
+    return page;
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
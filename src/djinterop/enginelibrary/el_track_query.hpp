@@ -0,0 +1,51 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/enginelibrary/el_track_cursor_impl.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/track_query.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// Compile a track query to a single statement selecting track IDs.
+std::string compile_track_query(
+    const track_query& query, std::vector<sql_parameter>& parameters);
+
+/// Fetch a page of the tracks satisfying a query, in the order given by the
+/// query, continuing from the position given by a continuation token.
+///
+/// Each page is fetched using predicates on the sort keys of the last track
+/// of the previous page, rather than by an offset, so that the cost of
+/// fetching a page does not grow with its position in the listing.
+track_page fetch_track_page(
+    const std::shared_ptr<el_storage>& storage, const track_query& query,
+    size_t page_size, const stdx::optional<std::string>& continuation_token);
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,387 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <djinterop/enginelibrary/el_storage.hpp>
+#include <djinterop/enginelibrary/el_track_search_index.hpp>
+#include <djinterop/text_folding.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+namespace
+{
+/// Weight of a match in each field, indexed by metadata type less one.
+constexpr std::array<int, 7> field_weights{3, 3, 2, 1, 1, 1, 1};
+
+uint64_t make_trigram(char32_t a, char32_t b, char32_t c)
+{
+    return (uint64_t{a} << 42) | (uint64_t{b} << 21) | uint64_t{c};
+}
+
+void append_trigrams(std::vector<uint64_t>& trigrams, const std::string& text)
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    auto code_points = decode_utf8(" " + text);
+    for (size_t i = 0; i + 2 < code_points.size(); ++i)
+    {
+        trigrams.push_back(make_trigram(
+            code_points[i], code_points[i + 1], code_points[i + 2]));
+    }
+}
+
+template <typename Fields>
+std::vector<uint64_t> trigrams_of(const Fields& track_fields)
+{
+    std::vector<uint64_t> trigrams;
+    for (auto&& text : track_fields)
+    {
+        append_trigrams(trigrams, text);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(
+        std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+/// Score how well a single folded query word matches a single folded field,
+/// where zero indicates no match.
+int match_quality(
+    const std::string& field, const std::string& word, bool word_start_only)
+{
+    if (field == word)
+    {
+        return 4;
+    }
+
+    int quality = 0;
+    for (auto pos = field.find(word); pos != std::string::npos;
+         pos = field.find(word, pos + 1))
+    {
+        if (pos == 0)
+        {
+            return 3;
+        }
+
+        if (field[pos - 1] == ' ')
+        {
+            quality = 2;
+        }
+        else if (!word_start_only && quality == 0)
+        {
+            quality = 1;
+        }
+    }
+
+    return quality;
+}
+
+}  // namespace
+
+el_track_search_index::el_track_search_index(el_storage& storage) :
+    storage_{storage}
+{
+}
+
+int64_t el_track_search_index::change_count() const
+{
+    return storage_.change_count("MetaData");
+}
+
+void el_track_search_index::apply(
+    int64_t change_count_before, int64_t track_id,
+    const std::vector<
+        std::pair<metadata_str_type, stdx::optional<std::string> > >& changes)
+{
+    if (!loaded_ || change_count_before != change_count_)
+    {
+        return;
+    }
+
+    auto iter = fields_by_track_.find(track_id);
+    auto track_fields = iter != fields_by_track_.end() ? iter->second : fields{};
+    auto changed_fields = track_fields;
+    for (auto&& change : changes)
+    {
+        auto index = static_cast<size_t>(change.first) - 1;
+        if (index < field_count)
+        {
+            changed_fields[index] =
+                change.second ? fold_text(*change.second) : std::string{};
+        }
+    }
+
+    if (changed_fields != track_fields)
+    {
+        unindex_track(track_id, track_fields);
+        index_track(track_id, changed_fields);
+    }
+
+    change_count_ = change_count();
+}
+
+void el_track_search_index::apply_removal(
+    int64_t change_count_before, const std::vector<int64_t>& track_ids)
+{
+    if (!loaded_ || change_count_before != change_count_)
+    {
+        return;
+    }
+
+    for (auto track_id : track_ids)
+    {
+        auto iter = fields_by_track_.find(track_id);
+        if (iter != fields_by_track_.end())
+        {
+            auto track_fields = iter->second;
+            unindex_track(track_id, track_fields);
+        }
+    }
+
+    change_count_ = change_count();
+}
+
+std::vector<int64_t> el_track_search_index::search(
+    const std::string& query, size_t limit)
+{
+    refresh();
+
+    auto folded_query = fold_text(query);
+    if (folded_query.empty() || limit == 0)
+    {
+        return {};
+    }
+
+    std::vector<std::string> words;
+    for (size_t begin = 0; begin < folded_query.size();)
+    {
+        auto end = folded_query.find(' ', begin);
+        if (end == std::string::npos)
+        {
+            end = folded_query.size();
+        }
+
+        words.push_back(folded_query.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    // Gather the trigrams of all words, which every matching track must have.
+    std::vector<bool> word_start_only;
+    std::vector<const id_bitmap*> postings;
+    for (auto&& word : words)
+    {
+        auto code_points = decode_utf8(word);
+        word_start_only.push_back(code_points.size() < 3);
+        std::vector<uint64_t> trigrams;
+        if (code_points.size() >= 3)
+        {
+            for (size_t i = 0; i + 2 < code_points.size(); ++i)
+            {
+                trigrams.push_back(make_trigram(
+                    code_points[i], code_points[i + 1], code_points[i + 2]));
+            }
+        }
+        else if (code_points.size() == 2)
+        {
+            trigrams.push_back(make_trigram(' ', code_points[0], code_points[1]));
+        }
+
+        for (auto trigram : trigrams)
+        {
+            auto iter = tracks_by_trigram_.find(trigram);
+            if (iter == tracks_by_trigram_.end())
+            {
+                return {};
+            }
+
+            postings.push_back(&iter->second);
+        }
+    }
+
+    std::vector<int64_t> candidates;
+    if (postings.empty())
+    {
+        candidates.reserve(fields_by_track_.size());
+        for (auto&& entry : fields_by_track_)
+        {
+            candidates.push_back(entry.first);
+        }
+    }
+    else
+    {
+        // Intersect the smallest postings first, so as to keep the
+        // intermediate results small.
+        std::sort(
+            postings.begin(), postings.end(),
+            [](const id_bitmap* a, const id_bitmap* b) {
+                return a->size() < b->size();
+            });
+        postings.erase(
+            std::unique(postings.begin(), postings.end()), postings.end());
+        auto matches = *postings.front();
+        for (auto iter = postings.begin() + 1;
+             iter != postings.end() && !matches.empty(); ++iter)
+        {
+            matches &= **iter;
+        }
+
+        candidates = matches.to_vector();
+    }
+
+    // Verify and score the candidates, since sharing trigrams with a word
+    // does not imply containing it.
+    std::vector<std::pair<int, int64_t> > scored;
+    for (auto track_id : candidates)
+    {
+        auto& track_fields = fields_by_track_.at(track_id);
+        int score = 0;
+        for (size_t w = 0; w < words.size() && (w == 0 || score > 0); ++w)
+        {
+            int best = 0;
+            for (size_t f = 0; f < field_count; ++f)
+            {
+                best = std::max(
+                    best, field_weights[f] * match_quality(
+                                                 track_fields[f], words[w],
+                                                 word_start_only[w]));
+            }
+
+            score = best > 0 ? score + best : 0;
+        }
+
+        if (score > 0 && words.size() > 1)
+        {
+            // Reward the words appearing together, as typed.
+            for (size_t f = 0; f < field_count; ++f)
+            {
+                score += field_weights[f] *
+                         match_quality(track_fields[f], folded_query, false);
+            }
+        }
+
+        if (score > 0)
+        {
+            scored.emplace_back(score, track_id);
+        }
+    }
+
+    auto better = [](const std::pair<int, int64_t>& a,
+                     const std::pair<int, int64_t>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    auto count = std::min(limit, scored.size());
+    std::partial_sort(
+        scored.begin(), scored.begin() + count, scored.end(), better);
+
+    std::vector<int64_t> results;
+    results.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        results.push_back(scored[i].second);
+    }
+
+    return results;
+}
+
+void el_track_search_index::index_track(
+    int64_t track_id, const fields& track_fields)
+{
+    for (auto trigram : trigrams_of(track_fields))
+    {
+        tracks_by_trigram_[trigram].add(track_id);
+    }
+
+    if (std::any_of(
+            track_fields.begin(), track_fields.end(),
+            [](const std::string& text) { return !text.empty(); }))
+    {
+        fields_by_track_[track_id] = track_fields;
+    }
+}
+
+void el_track_search_index::load()
+{
+    change_count_ = change_count();
+    data_version_ = storage_.music_data_version();
+    loaded_ = true;
+
+    fields_by_track_.clear();
+    storage_.db << "SELECT id, type, text FROM MetaData WHERE type BETWEEN "
+                   "1 AND 7 AND text IS NOT NULL AND text != ''" >>
+        [&](int64_t id, int64_t type, const std::string& text) {
+            auto folded = fold_text(text);
+            if (!folded.empty())
+            {
+                fields_by_track_[id][type - 1] = std::move(folded);
+            }
+        };
+
+    std::unordered_map<uint64_t, std::vector<int64_t> > track_ids_by_trigram;
+    for (auto&& entry : fields_by_track_)
+    {
+        for (auto trigram : trigrams_of(entry.second))
+        {
+            track_ids_by_trigram[trigram].push_back(entry.first);
+        }
+    }
+
+    tracks_by_trigram_.clear();
+    tracks_by_trigram_.reserve(track_ids_by_trigram.size());
+    for (auto&& entry : track_ids_by_trigram)
+    {
+        tracks_by_trigram_.emplace(
+            entry.first, id_bitmap{std::move(entry.second)});
+    }
+}
+
+void el_track_search_index::refresh()
+{
+    if (!loaded_ || change_count() != change_count_ ||
+        storage_.music_data_version() != data_version_)
+    {
+        load();
+    }
+}
+
+void el_track_search_index::unindex_track(
+    int64_t track_id, const fields& track_fields)
+{
+    for (auto trigram : trigrams_of(track_fields))
+    {
+        auto iter = tracks_by_trigram_.find(trigram);
+        if (iter != tracks_by_trigram_.end())
+        {
+            iter->second.remove(track_id);
+            if (iter->second.empty())
+            {
+                tracks_by_trigram_.erase(iter);
+            }
+        }
+    }
+
+    fields_by_track_.erase(track_id);
+}
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -0,0 +1,95 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/id_bitmap.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+class el_storage;
+
+/// An in-memory trigram index of the textual metadata of all tracks, being
+/// the title, artist, album, genre, comment, publisher, and composer.
+///
+/// Text is folded with `fold_text()` before it is indexed or searched for.
+/// Each field is indexed as if preceded by a space, so that the start of every
+/// word in a field is marked by a trigram beginning with a space.
+class el_track_search_index
+{
+public:
+    el_track_search_index(el_storage& storage);
+
+    /// Get the counter of changes to track metadata made via the storage's
+    /// connection.
+    int64_t change_count() const;
+
+    /// Apply changes to the metadata strings of a track that were made via the
+    /// storage's connection.
+    ///
+    /// The changes are only applied if the index was up to date just before
+    /// they were made, as given by the change counter at that time.
+    /// Otherwise, the index will be reloaded upon its next search.
+    void apply(
+        int64_t change_count_before, int64_t track_id,
+        const std::vector<
+            std::pair<metadata_str_type, stdx::optional<std::string> > >&
+            changes);
+
+    /// Apply the removal of tracks that was made via the storage's connection.
+    void apply_removal(
+        int64_t change_count_before, const std::vector<int64_t>& track_ids);
+
+    /// Search for tracks matching a query, returning at most `limit` track IDs
+    /// in descending order of match quality.
+    ///
+    /// The query is split into words, each of which must match some field of
+    /// a track.  Words of three or more characters may match anywhere within
+    /// a field, whereas shorter words must match the start of a word.
+    std::vector<int64_t> search(const std::string& query, size_t limit);
+
+private:
+    static constexpr size_t field_count = 7;
+    using fields = std::array<std::string, field_count>;
+
+    void index_track(int64_t track_id, const fields& track_fields);
+    void load();
+    void refresh();
+    void unindex_track(int64_t track_id, const fields& track_fields);
+
+    el_storage& storage_;
+    bool loaded_ = false;
+    int64_t change_count_ = 0;
+    int64_t data_version_ = 0;
+    std::unordered_map<int64_t, fields> fields_by_track_;
+    std::unordered_map<uint64_t, id_bitmap> tracks_by_trigram_;
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
@@ -37,7 +37,10 @@ el_transaction_guard_impl::~el_transaction_guard_impl()
     {
         try
         {
+            // Rolling back to a savepoint leaves it open, and so it must
+            // also be released for the transaction to end.
             storage_->db << ("ROLLBACK TO s" + std::to_string(savepoint_));
+            storage_->db << ("RELEASE s" + std::to_string(savepoint_));
         }
         catch (...)
         {
@@ -48,6 +51,9 @@ el_transaction_guard_impl::~el_transaction_guard_impl()
             //
             // TODO (haslersn): We could still issue a warning
         }
+
+        // Any cached copies of rows changed since the savepoint are now stale.
+        storage_->notify_rollback();
     }
 }
 
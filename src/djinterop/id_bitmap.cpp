@@ -0,0 +1,517 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <djinterop/id_bitmap.hpp>
+
+namespace djinterop
+{
+namespace
+{
+// Containers with more than this many IDs are stored as bitmaps.
+constexpr size_t max_array_cardinality = 4096;
+
+// Number of 64-bit words in a bitmap container, covering 65536 IDs.
+constexpr size_t bitmap_words = 1024;
+
+int64_t high_bits(int64_t id)
+{
+    return id >> 16;
+}
+
+uint16_t low_bits(int64_t id)
+{
+    return static_cast<uint16_t>(id & 0xFFFF);
+}
+
+size_t popcount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count = 0;
+    for (; word != 0; word &= word - 1)
+        ++count;
+    return count;
+#endif
+}
+
+size_t popcount(const std::vector<uint64_t>& words)
+{
+    size_t count = 0;
+    for (auto word : words)
+        count += popcount(word);
+    return count;
+}
+
+bool test_bit(const std::vector<uint64_t>& words, uint16_t low)
+{
+    return (words[low >> 6] >> (low & 63)) & 1;
+}
+
+template <typename Chunk>
+auto find_chunk(std::vector<Chunk>& chunks, int64_t key)
+{
+    return std::lower_bound(
+        chunks.begin(), chunks.end(), key,
+        [](const Chunk& chunk, int64_t k) { return chunk.first < k; });
+}
+
+}  // namespace
+
+id_bitmap::id_bitmap() noexcept = default;
+
+id_bitmap::id_bitmap(std::vector<int64_t> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    for (auto iter = ids.begin(); iter != ids.end();)
+    {
+        auto key = high_bits(*iter);
+        auto end = std::find_if(iter, ids.end(), [key](int64_t id) {
+            return high_bits(id) != key;
+        });
+
+        container c;
+        c.cardinality = static_cast<size_t>(std::distance(iter, end));
+        if (c.cardinality > max_array_cardinality)
+        {
+            c.words.resize(bitmap_words);
+            for (; iter != end; ++iter)
+            {
+                auto low = low_bits(*iter);
+                c.words[low >> 6] |= uint64_t{1} << (low & 63);
+            }
+        }
+        else
+        {
+            c.array.reserve(c.cardinality);
+            for (; iter != end; ++iter)
+            {
+                c.array.push_back(low_bits(*iter));
+            }
+        }
+
+        chunks_.emplace_back(key, std::move(c));
+    }
+}
+
+void id_bitmap::add(int64_t id)
+{
+    auto key = high_bits(id);
+    auto iter = find_chunk(chunks_, key);
+    if (iter == chunks_.end() || iter->first != key)
+    {
+        iter = chunks_.emplace(iter, key, container{});
+    }
+
+    add_to(iter->second, low_bits(id));
+}
+
+bool id_bitmap::contains(int64_t id) const
+{
+    auto c = find_container(high_bits(id));
+    return c && contains_in(*c, low_bits(id));
+}
+
+bool id_bitmap::empty() const noexcept
+{
+    return chunks_.empty();
+}
+
+void id_bitmap::remove(int64_t id)
+{
+    auto key = high_bits(id);
+    auto iter = find_chunk(chunks_, key);
+    if (iter == chunks_.end() || iter->first != key)
+    {
+        return;
+    }
+
+    if (remove_from(iter->second, low_bits(id)) &&
+        iter->second.cardinality == 0)
+    {
+        chunks_.erase(iter);
+    }
+}
+
+size_t id_bitmap::size() const noexcept
+{
+    size_t size = 0;
+    for (auto&& chunk : chunks_)
+        size += chunk.second.cardinality;
+    return size;
+}
+
+std::vector<int64_t> id_bitmap::to_vector() const
+{
+    std::vector<int64_t> results;
+    results.reserve(size());
+    for (auto&& chunk : chunks_)
+    {
+        auto base = chunk.first * 65536;
+        auto& c = chunk.second;
+        if (c.words.empty())
+        {
+            for (auto low : c.array)
+                results.push_back(base + low);
+        }
+        else
+        {
+            for (size_t i = 0; i < bitmap_words; ++i)
+            {
+                for (auto word = c.words[i]; word != 0; word &= word - 1)
+                {
+                    auto bit = popcount((word & -word) - 1);
+                    results.push_back(base + static_cast<int64_t>(i * 64 + bit));
+                }
+            }
+        }
+    }
+
+    return results;
+}
+
+id_bitmap& id_bitmap::operator|=(const id_bitmap& other)
+{
+    std::vector<chunk> results;
+    results.reserve(chunks_.size() + other.chunks_.size());
+    auto a = chunks_.begin();
+    auto b = other.chunks_.begin();
+    while (a != chunks_.end() || b != other.chunks_.end())
+    {
+        if (b == other.chunks_.end() ||
+            (a != chunks_.end() && a->first < b->first))
+        {
+            results.push_back(std::move(*a++));
+        }
+        else if (a == chunks_.end() || b->first < a->first)
+        {
+            results.push_back(*b++);
+        }
+        else
+        {
+            results.emplace_back(a->first, unite(a->second, b->second));
+            ++a;
+            ++b;
+        }
+    }
+
+    chunks_ = std::move(results);
+    return *this;
+}
+
+id_bitmap& id_bitmap::operator&=(const id_bitmap& other)
+{
+    std::vector<chunk> results;
+    for (auto&& chunk : chunks_)
+    {
+        auto c = other.find_container(chunk.first);
+        if (!c)
+        {
+            continue;
+        }
+
+        auto intersection = intersect(chunk.second, *c);
+        if (intersection.cardinality != 0)
+        {
+            results.emplace_back(chunk.first, std::move(intersection));
+        }
+    }
+
+    chunks_ = std::move(results);
+    return *this;
+}
+
+id_bitmap& id_bitmap::operator-=(const id_bitmap& other)
+{
+    std::vector<chunk> results;
+    for (auto&& chunk : chunks_)
+    {
+        auto c = other.find_container(chunk.first);
+        if (!c)
+        {
+            results.push_back(std::move(chunk));
+            continue;
+        }
+
+        auto difference = subtract(chunk.second, *c);
+        if (difference.cardinality != 0)
+        {
+            results.emplace_back(chunk.first, std::move(difference));
+        }
+    }
+
+    chunks_ = std::move(results);
+    return *this;
+}
+
+bool id_bitmap::operator==(const id_bitmap& other) const noexcept
+{
+    // Every container is kept in the form implied by its cardinality, and
+    // so equal sets have equal representations.
+    return chunks_ == other.chunks_;
+}
+
+bool id_bitmap::operator!=(const id_bitmap& other) const noexcept
+{
+    return !(*this == other);
+}
+
+bool id_bitmap::container::operator==(const container& other) const noexcept
+{
+    return cardinality == other.cardinality && array == other.array &&
+           words == other.words;
+}
+
+id_bitmap::container* id_bitmap::find_container(int64_t key)
+{
+    auto iter = find_chunk(chunks_, key);
+    return iter != chunks_.end() && iter->first == key ? &iter->second
+                                                       : nullptr;
+}
+
+const id_bitmap::container* id_bitmap::find_container(int64_t key) const
+{
+    return const_cast<id_bitmap*>(this)->find_container(key);
+}
+
+void id_bitmap::add_to(container& c, uint16_t low)
+{
+    if (c.words.empty())
+    {
+        auto iter = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (iter == c.array.end() || *iter != low)
+        {
+            c.array.insert(iter, low);
+            ++c.cardinality;
+            normalise(c);
+        }
+    }
+    else if (!test_bit(c.words, low))
+    {
+        c.words[low >> 6] |= uint64_t{1} << (low & 63);
+        ++c.cardinality;
+    }
+}
+
+bool id_bitmap::contains_in(const container& c, uint16_t low)
+{
+    if (c.words.empty())
+    {
+        return std::binary_search(c.array.begin(), c.array.end(), low);
+    }
+
+    return test_bit(c.words, low);
+}
+
+void id_bitmap::normalise(container& c)
+{
+    if (c.words.empty() && c.cardinality > max_array_cardinality)
+    {
+        c.words = words_of(c);
+        c.array.clear();
+        c.array.shrink_to_fit();
+    }
+    else if (!c.words.empty() && c.cardinality <= max_array_cardinality)
+    {
+        c.array.clear();
+        c.array.reserve(c.cardinality);
+        for (size_t i = 0; i < bitmap_words; ++i)
+        {
+            for (auto word = c.words[i]; word != 0; word &= word - 1)
+            {
+                auto bit = popcount((word & -word) - 1);
+                c.array.push_back(static_cast<uint16_t>(i * 64 + bit));
+            }
+        }
+
+        c.words.clear();
+        c.words.shrink_to_fit();
+    }
+}
+
+bool id_bitmap::remove_from(container& c, uint16_t low)
+{
+    if (c.words.empty())
+    {
+        auto iter = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (iter == c.array.end() || *iter != low)
+        {
+            return false;
+        }
+
+        c.array.erase(iter);
+    }
+    else
+    {
+        if (!test_bit(c.words, low))
+        {
+            return false;
+        }
+
+        c.words[low >> 6] &= ~(uint64_t{1} << (low & 63));
+    }
+
+    --c.cardinality;
+    normalise(c);
+    return true;
+}
+
+id_bitmap::container id_bitmap::unite(const container& a, const container& b)
+{
+    container result;
+    if (a.words.empty() && b.words.empty())
+    {
+        result.array.reserve(a.array.size() + b.array.size());
+        std::set_union(
+            a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+            std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+    }
+    else
+    {
+        result.words = words_of(a);
+        if (b.words.empty())
+        {
+            for (auto low : b.array)
+                result.words[low >> 6] |= uint64_t{1} << (low & 63);
+        }
+        else
+        {
+            for (size_t i = 0; i < bitmap_words; ++i)
+                result.words[i] |= b.words[i];
+        }
+
+        result.cardinality = popcount(result.words);
+    }
+
+    normalise(result);
+    return result;
+}
+
+id_bitmap::container id_bitmap::intersect(
+    const container& a, const container& b)
+{
+    container result;
+    if (a.words.empty() && b.words.empty())
+    {
+        std::set_intersection(
+            a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+            std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+    }
+    else if (a.words.empty() || b.words.empty())
+    {
+        auto& sparse = a.words.empty() ? a : b;
+        auto& dense = a.words.empty() ? b : a;
+        for (auto low : sparse.array)
+        {
+            if (test_bit(dense.words, low))
+                result.array.push_back(low);
+        }
+
+        result.cardinality = result.array.size();
+    }
+    else
+    {
+        result.words.resize(bitmap_words);
+        for (size_t i = 0; i < bitmap_words; ++i)
+            result.words[i] = a.words[i] & b.words[i];
+        result.cardinality = popcount(result.words);
+    }
+
+    normalise(result);
+    return result;
+}
+
+id_bitmap::container id_bitmap::subtract(
+    const container& a, const container& b)
+{
+    container result;
+    if (a.words.empty() && b.words.empty())
+    {
+        std::set_difference(
+            a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+            std::back_inserter(result.array));
+        result.cardinality = result.array.size();
+    }
+    else if (a.words.empty())
+    {
+        for (auto low : a.array)
+        {
+            if (!test_bit(b.words, low))
+                result.array.push_back(low);
+        }
+
+        result.cardinality = result.array.size();
+    }
+    else
+    {
+        result.words = a.words;
+        if (b.words.empty())
+        {
+            for (auto low : b.array)
+                result.words[low >> 6] &= ~(uint64_t{1} << (low & 63));
+        }
+        else
+        {
+            for (size_t i = 0; i < bitmap_words; ++i)
+                result.words[i] &= ~b.words[i];
+        }
+
+        result.cardinality = popcount(result.words);
+    }
+
+    normalise(result);
+    return result;
+}
+
+std::vector<uint64_t> id_bitmap::words_of(const container& c)
+{
+    if (!c.words.empty())
+    {
+        return c.words;
+    }
+
+    std::vector<uint64_t> words(bitmap_words);
+    for (auto low : c.array)
+        words[low >> 6] |= uint64_t{1} << (low & 63);
+    return words;
+}
+
+id_bitmap operator|(id_bitmap a, const id_bitmap& b)
+{
+    return a |= b;
+}
+
+id_bitmap operator&(id_bitmap a, const id_bitmap& b)
+{
+    return a &= b;
+}
+
+id_bitmap operator-(id_bitmap a, const id_bitmap& b)
+{
+    return a -= b;
+}
+
+}  // namespace djinterop
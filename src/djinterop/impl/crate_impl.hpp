@@ -40,6 +40,7 @@ public:
 
     virtual void add_track(int64_t track_id) = 0;
     virtual void add_track(track tr) = 0;
+    virtual void add_tracks(const std::vector<int64_t>& track_ids) = 0;
     virtual std::vector<crate> children() = 0;
     virtual void clear_tracks() = 0;
     virtual crate create_sub_crate(std::string name) = 0;
@@ -53,6 +54,7 @@ public:
         const std::string& name) = 0;
     virtual void set_name(std::string name) = 0;
     virtual void set_parent(stdx::optional<crate> parent) = 0;
+    virtual void set_tracks(const std::vector<int64_t>& track_ids) = 0;
     virtual std::vector<track> tracks() = 0;
 
 private:
@@ -0,0 +1,39 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <djinterop/id_bitmap.hpp>
+
+namespace djinterop
+{
+class crate_membership_index_impl
+{
+public:
+    virtual ~crate_membership_index_impl() noexcept;
+
+    /// Get the tracks contained in a crate, or `nullptr` if the crate does not
+    /// contain any tracks.
+    virtual const id_bitmap* find(int64_t crate_id) = 0;
+
+    /// Reload the index if it may be out of date.
+    virtual void refresh() = 0;
+};
+
+}  // namespace djinterop
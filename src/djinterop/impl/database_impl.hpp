@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,9 +25,29 @@
 
 namespace djinterop
 {
+enum class autocomplete_field;
+struct autocomplete_suggestion;
+struct content_hash_options;
+struct content_hash_result;
 class crate;
+class crate_membership_index_impl;
+class crate_set_expr;
+struct crate_tree_node;
+class database;
+struct file_scan_options;
+struct file_scan_summary;
+struct library_snapshot_impl;
+struct library_sync_options;
+struct library_sync_report;
+enum class musical_key;
 struct semantic_version;
+struct similar_track_group;
+struct similar_tracks_options;
 class track;
+class track_cursor_impl;
+struct track_page;
+class track_query;
+enum class track_row_cache_policy;
 class transaction_guard;
 
 class database_impl
@@ -34,24 +55,65 @@ class database_impl
 public:
     virtual ~database_impl();
 
+    virtual std::vector<autocomplete_suggestion> autocomplete(
+        autocomplete_field field, const std::string& prefix,
+        size_t limit) = 0;
     virtual transaction_guard begin_transaction() = 0;
+    virtual content_hash_result compute_content_hashes(
+        const content_hash_options& options) = 0;
+    virtual std::vector<track> copy_tracks(
+        const database& source, const std::vector<track>& tracks) = 0;
     virtual stdx::optional<crate> crate_by_id(int64_t id) = 0;
     virtual std::vector<crate> crates() = 0;
     virtual std::vector<crate> crates_by_name(const std::string& name) = 0;
+    virtual std::vector<crate_tree_node> crate_tree_nodes() = 0;
+    virtual int64_t crates_version() = 0;
     virtual crate create_root_crate(std::string name) = 0;
     virtual track create_track(std::string relative_path) = 0;
     virtual std::string directory() = 0;
+    virtual std::vector<std::vector<track>> duplicate_tracks_by_content() = 0;
+    virtual std::vector<track> harmonic_candidates(
+        double bpm, musical_key key, double bpm_tolerance) = 0;
     virtual bool is_supported() = 0;
+    virtual std::shared_ptr<crate_membership_index_impl>
+    load_crate_membership_index() = 0;
+    virtual track_page list_tracks(
+        const track_query& query, size_t page_size,
+        const stdx::optional<std::string>& continuation_token) = 0;
+    virtual std::shared_ptr<library_snapshot_impl> load_library_snapshot(
+        bool include_track_data) = 0;
+    virtual std::shared_ptr<track_cursor_impl> query_tracks(
+        const track_query& query) = 0;
+    virtual int64_t relocate_tracks(
+        const std::string& old_prefix, const std::string& new_prefix) = 0;
+    virtual file_scan_summary scan_files(const file_scan_options& options) = 0;
+    virtual void set_track_row_cache_policy(track_row_cache_policy policy) = 0;
+    virtual std::vector<std::string> track_directories() = 0;
     virtual void verify() = 0;
     virtual void remove_crate(crate cr) = 0;
+    virtual void remove_crates(
+        const std::vector<int64_t>& crate_ids, bool recursive) = 0;
     virtual void remove_track(track tr) = 0;
+    virtual void remove_tracks(const std::vector<int64_t>& track_ids) = 0;
     virtual std::vector<crate> root_crates() = 0;
     virtual stdx::optional<crate> root_crate_by_name(
         const std::string& name) = 0;
+    virtual std::vector<track> search_tracks(
+        const std::string& query, size_t limit) = 0;
+    virtual std::vector<similar_track_group> similar_tracks(
+        const similar_tracks_options& options) = 0;
+    virtual library_sync_report sync_library(
+        database_impl& other, const library_sync_options& options) = 0;
     virtual stdx::optional<track> track_by_id(int64_t id) = 0;
+    virtual std::vector<stdx::optional<track>> tracks_by_ids(
+        const std::vector<int64_t>& ids) = 0;
     virtual std::vector<track> tracks() = 0;
+    virtual std::shared_ptr<track_cursor_impl> tracks_in_crates(
+        const crate_set_expr& expr) = 0;
     virtual std::vector<track> tracks_by_relative_path(
         const std::string& relative_path) = 0;
+    virtual std::vector<std::vector<track>> tracks_by_relative_paths(
+        const std::vector<std::string>& relative_paths) = 0;
     virtual std::string uuid() = 0;
     virtual semantic_version version() = 0;
     virtual std::string version_name() = 0;
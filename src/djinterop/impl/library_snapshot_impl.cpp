@@ -0,0 +1,80 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#include <djinterop/impl/library_snapshot_impl.hpp>
+
+namespace djinterop
+{
+library_snapshot_impl::library_snapshot_impl()
+{
+    texts.emplace_back();
+    text_by_value.emplace(std::string{}, library_snapshot::no_text);
+}
+
+size_t library_snapshot_impl::add_row(int64_t id)
+{
+    auto row = ids.size();
+    ids.push_back(id);
+    albums.push_back(library_snapshot::no_text);
+    artists.push_back(library_snapshot::no_text);
+    bitrates.emplace_back();
+    bpms.emplace_back();
+    durations.emplace_back();
+    genres.push_back(library_snapshot::no_text);
+    keys.emplace_back();
+    titles.push_back(library_snapshot::no_text);
+    years.emplace_back();
+    row_by_id.emplace(id, row);
+    return row;
+}
+
+library_snapshot::text_ref library_snapshot_impl::intern(
+    const std::string& text)
+{
+    auto iter = text_by_value.find(text);
+    if (iter != text_by_value.end())
+    {
+        return iter->second;
+    }
+
+    auto ref = static_cast<library_snapshot::text_ref>(texts.size());
+    texts.push_back(text);
+    text_by_value.emplace(text, ref);
+    return ref;
+}
+
+void library_snapshot_impl::rank_texts()
+{
+    std::vector<library_snapshot::text_ref> order(texts.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(
+        order.begin(), order.end(),
+        [this](library_snapshot::text_ref a, library_snapshot::text_ref b) {
+            return texts[a] < texts[b];
+        });
+
+    text_ranks.resize(texts.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        text_ranks[order[i]] = static_cast<uint32_t>(i);
+    }
+}
+
+}  // namespace djinterop
@@ -0,0 +1,73 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <djinterop/library_snapshot.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop
+{
+/// Columns of a library snapshot, as populated by a database implementation.
+struct library_snapshot_impl
+{
+    /// Construct empty columns, with the empty string interned as `no_text`.
+    library_snapshot_impl();
+
+    /// Append a row for a track, with no values, and return its row number.
+    size_t add_row(int64_t id);
+
+    /// Intern a string, returning its reference.
+    library_snapshot::text_ref intern(const std::string& text);
+
+    /// Compute `text_ranks` once all strings have been interned.
+    void rank_texts();
+
+    std::vector<int64_t> ids;
+    std::vector<library_snapshot::text_ref> albums;
+    std::vector<library_snapshot::text_ref> artists;
+    std::vector<stdx::optional<int64_t> > bitrates;
+    std::vector<stdx::optional<double> > bpms;
+    std::vector<stdx::optional<std::chrono::milliseconds> > durations;
+    std::vector<library_snapshot::text_ref> genres;
+    std::vector<stdx::optional<musical_key> > keys;
+    std::vector<library_snapshot::text_ref> titles;
+    std::vector<stdx::optional<int32_t> > years;
+
+    /// Row number of each track ID.
+    std::unordered_map<int64_t, size_t> row_by_id;
+
+    /// Interned strings, indexed by reference.
+    std::vector<std::string> texts;
+
+    /// Reference of each interned string.
+    std::unordered_map<std::string, library_snapshot::text_ref> text_by_value;
+
+    /// Position of each interned string in byte-wise sorted order, indexed by
+    /// reference.
+    std::vector<uint32_t> text_ranks;
+};
+
+}  // namespace djinterop
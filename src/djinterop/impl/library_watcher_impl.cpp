@@ -0,0 +1,676 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include <djinterop/impl/library_watcher_impl.hpp>
+#include <djinterop/track_cursor.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/transaction_guard.hpp>
+#include <djinterop/util.hpp>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+#endif
+
+namespace djinterop
+{
+namespace
+{
+std::string join_path(const std::string& directory, const std::string& name)
+{
+    return directory.empty() ? name : directory + "/" + name;
+}
+
+/// Returns whether a path lies within a directory, or is that directory.
+bool is_within(const std::string& path, const std::string& directory)
+{
+    return directory.empty() || path == directory ||
+           (path.size() > directory.size() &&
+            path.compare(0, directory.size(), directory) == 0 &&
+            path[directory.size()] == '/');
+}
+
+/// Returns a path as it would be after renaming a directory, assuming that
+/// it lies within that directory.
+std::string rename_within(
+    const std::string& path, const std::string& from, const std::string& to)
+{
+    return to + path.substr(from.size());
+}
+
+#if defined(__linux__)
+constexpr uint32_t watch_mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+bool is_regular_file(const std::string& path)
+{
+    struct stat status;
+    return ::stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+}
+
+bool exists(const std::string& path)
+{
+    struct stat status;
+    return ::stat(path.c_str(), &status) == 0;
+}
+#endif
+
+}  // namespace
+
+#if defined(__linux__)
+
+library_watcher_impl::library_watcher_impl(
+    database db, const std::vector<std::string>& relative_directories,
+    library_watcher_options options) :
+    db_{std::move(db)}, options_{std::move(options)}
+{
+    for (auto&& extension : options_.extensions)
+    {
+        std::transform(
+            extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return std::tolower(c); });
+    }
+
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0)
+    {
+        throw std::system_error{
+            errno, std::system_category(), "Failed to initialise inotify"};
+    }
+
+    for (auto&& relative_directory : relative_directories)
+    {
+        add_watch(relative_directory, false);
+    }
+}
+
+library_watcher_impl::~library_watcher_impl()
+{
+    ::close(fd_);
+}
+
+int library_watcher_impl::native_handle() const noexcept
+{
+    return fd_;
+}
+
+library_watcher_update library_watcher_impl::poll(
+    std::chrono::milliseconds timeout)
+{
+    if (!wait_readable(timeout))
+    {
+        return library_watcher_update{};
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + options_.max_batch_time;
+    read_events();
+    for (;;)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 ||
+            !wait_readable(std::min(remaining, options_.settle_time)))
+        {
+            break;
+        }
+
+        read_events();
+    }
+
+    return apply();
+}
+
+size_t library_watcher_impl::watched_directory_count() const
+{
+    return directories_by_watch_.size();
+}
+
+std::string library_watcher_impl::absolute_path(
+    const std::string& relative_path) const
+{
+    return relative_path.empty() ? db_.directory()
+                                 : db_.directory() + "/" + relative_path;
+}
+
+bool library_watcher_impl::has_music_extension(
+    const std::string& relative_path) const
+{
+    auto slash = relative_path.rfind('/');
+    auto dot = relative_path.rfind('.');
+    if (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash))
+    {
+        return false;
+    }
+
+    auto extension = relative_path.substr(dot + 1);
+    std::transform(
+        extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+    return std::find(
+               options_.extensions.begin(), options_.extensions.end(),
+               extension) != options_.extensions.end();
+}
+
+void library_watcher_impl::add_watch(
+    const std::string& relative_directory, bool scan)
+{
+    auto path = absolute_path(relative_directory);
+    auto wd = ::inotify_add_watch(fd_, path.c_str(), watch_mask);
+    if (wd < 0)
+    {
+        // The directory no longer exists, or cannot be watched.
+        return;
+    }
+
+    directories_by_watch_.emplace(wd, relative_directory);
+    if (!scan)
+    {
+        return;
+    }
+
+    // Files may have been put in a new directory before it was watched.
+    auto dir = ::opendir(path.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+
+    std::vector<std::string> names;
+    while (auto entry = ::readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..")
+        {
+            names.push_back(std::move(name));
+        }
+    }
+
+    ::closedir(dir);
+    std::sort(names.begin(), names.end());
+    for (auto&& name : names)
+    {
+        auto relative_path = join_path(relative_directory, name);
+        struct stat status;
+        if (::stat(absolute_path(relative_path).c_str(), &status) != 0)
+        {
+            continue;
+        }
+
+        if (S_ISDIR(status.st_mode))
+        {
+            add_watch(relative_path, true);
+        }
+        else if (S_ISREG(status.st_mode))
+        {
+            file_written(relative_path);
+        }
+    }
+}
+
+void library_watcher_impl::remove_watches(
+    const std::string& relative_directory)
+{
+    for (auto iter = directories_by_watch_.begin();
+         iter != directories_by_watch_.end();)
+    {
+        if (is_within(iter->second, relative_directory))
+        {
+            ::inotify_rm_watch(fd_, iter->first);
+            iter = directories_by_watch_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+bool library_watcher_impl::wait_readable(
+    std::chrono::milliseconds timeout) const
+{
+    pollfd descriptor{fd_, POLLIN, 0};
+    auto result = ::poll(&descriptor, 1, static_cast<int>(timeout.count()));
+    if (result < 0 && errno != EINTR)
+    {
+        throw std::system_error{
+            errno, std::system_category(), "Failed to poll inotify"};
+    }
+
+    return result > 0;
+}
+
+void library_watcher_impl::read_events()
+{
+    alignas(inotify_event) char buffer[64 * 1024];
+    for (;;)
+    {
+        auto length = ::read(fd_, buffer, sizeof buffer);
+        if (length <= 0)
+        {
+            if (length < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                throw std::system_error{
+                    errno, std::system_category(), "Failed to read inotify"};
+            }
+
+            break;
+        }
+
+        for (auto ptr = buffer; ptr < buffer + length;)
+        {
+            auto& event = *reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event.len;
+
+            if (event.mask & IN_Q_OVERFLOW)
+            {
+                // Events have been lost, so rescan everything watched.
+                std::vector<std::string> directories;
+                for (auto&& entry : directories_by_watch_)
+                {
+                    directories.push_back(entry.second);
+                    removed_directory_origins_.insert(origin_of(entry.second));
+                }
+
+                for (auto&& directory : directories)
+                {
+                    remove_watches(directory);
+                    add_watch(directory, true);
+                }
+
+                continue;
+            }
+
+            auto iter = directories_by_watch_.find(event.wd);
+            if (iter == directories_by_watch_.end())
+            {
+                continue;
+            }
+
+            if (event.mask & IN_IGNORED)
+            {
+                directories_by_watch_.erase(iter);
+                continue;
+            }
+
+            if (event.len == 0)
+            {
+                continue;
+            }
+
+            auto path = join_path(iter->second, event.name);
+            bool is_directory = (event.mask & IN_ISDIR) != 0;
+            if (event.mask & IN_MOVED_FROM)
+            {
+                pending_moves_[event.cookie] = {path, is_directory};
+            }
+            else if (event.mask & IN_MOVED_TO)
+            {
+                auto move = pending_moves_.find(event.cookie);
+                if (move == pending_moves_.end())
+                {
+                    // Moved in from outside the watched directories.
+                    if (is_directory)
+                    {
+                        add_watch(path, true);
+                    }
+                    else
+                    {
+                        file_written(path);
+                    }
+                }
+                else if (is_directory)
+                {
+                    directory_moved(move->second.first, path);
+                    pending_moves_.erase(move);
+                }
+                else
+                {
+                    file_moved(move->second.first, path);
+                    pending_moves_.erase(move);
+                }
+            }
+            else if (event.mask & IN_CREATE)
+            {
+                if (is_directory)
+                {
+                    add_watch(path, true);
+                }
+            }
+            else if (event.mask & IN_CLOSE_WRITE)
+            {
+                file_written(path);
+            }
+            else if (event.mask & IN_DELETE)
+            {
+                if (!is_directory)
+                {
+                    file_removed(path);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+library_watcher_impl::library_watcher_impl(
+    database db, const std::vector<std::string>&, library_watcher_options) :
+    db_{std::move(db)}
+{
+    throw std::runtime_error{"Watching libraries is only supported on Linux"};
+}
+
+library_watcher_impl::~library_watcher_impl() = default;
+
+int library_watcher_impl::native_handle() const noexcept
+{
+    return fd_;
+}
+
+library_watcher_update library_watcher_impl::poll(std::chrono::milliseconds)
+{
+    return library_watcher_update{};
+}
+
+size_t library_watcher_impl::watched_directory_count() const
+{
+    return 0;
+}
+
+#endif
+
+void library_watcher_impl::file_written(const std::string& path)
+{
+    if (origins_by_path_.find(path) == origins_by_path_.end())
+    {
+        origins_by_path_.emplace(path, origin_of(path));
+    }
+}
+
+void library_watcher_impl::file_removed(const std::string& path)
+{
+    auto iter = origins_by_path_.find(path);
+    if (iter != origins_by_path_.end())
+    {
+        removed_origins_.insert(iter->second);
+        origins_by_path_.erase(iter);
+    }
+    else
+    {
+        removed_origins_.insert(origin_of(path));
+    }
+}
+
+void library_watcher_impl::file_moved(
+    const std::string& from, const std::string& to)
+{
+    auto origin = origin_of(from);
+    auto iter = origins_by_path_.find(from);
+    if (iter != origins_by_path_.end())
+    {
+        origin = iter->second;
+        origins_by_path_.erase(iter);
+    }
+
+    // Any file replaced by the move is removed.  The origin is also treated
+    // as removed, so that its track is reported if it cannot be relocated.
+    file_removed(to);
+    removed_origins_.insert(origin);
+    origins_by_path_[to] = origin;
+}
+
+void library_watcher_impl::directory_moved(
+    const std::string& from, const std::string& to)
+{
+    directory_renames_.emplace_back(from, to);
+
+    std::map<std::string, std::string> origins_by_path;
+    for (auto&& entry : origins_by_path_)
+    {
+        auto path = is_within(entry.first, from)
+                        ? rename_within(entry.first, from, to)
+                        : entry.first;
+        origins_by_path.emplace(std::move(path), entry.second);
+    }
+
+    origins_by_path_ = std::move(origins_by_path);
+    for (auto&& entry : directories_by_watch_)
+    {
+        if (is_within(entry.second, from))
+        {
+            entry.second = rename_within(entry.second, from, to);
+        }
+    }
+}
+
+void library_watcher_impl::directory_removed(const std::string& path)
+{
+    remove_watches(path);
+    removed_directory_origins_.insert(origin_of(path));
+    for (auto iter = origins_by_path_.begin(); iter != origins_by_path_.end();)
+    {
+        if (is_within(iter->first, path))
+        {
+            removed_origins_.insert(iter->second);
+            iter = origins_by_path_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+std::string library_watcher_impl::origin_of(const std::string& path) const
+{
+    auto origin = path;
+    for (auto iter = directory_renames_.rbegin();
+         iter != directory_renames_.rend(); ++iter)
+    {
+        if (is_within(origin, iter->second))
+        {
+            origin = rename_within(origin, iter->second, iter->first);
+        }
+    }
+
+    return origin;
+}
+
+std::string library_watcher_impl::current_of(const std::string& origin) const
+{
+    auto path = origin;
+    for (auto&& rename : directory_renames_)
+    {
+        if (is_within(path, rename.first))
+        {
+            path = rename_within(path, rename.first, rename.second);
+        }
+    }
+
+    return path;
+}
+
+void library_watcher_impl::clear_pending() noexcept
+{
+    origins_by_path_.clear();
+    removed_origins_.clear();
+    directory_renames_.clear();
+    removed_directory_origins_.clear();
+    pending_moves_.clear();
+}
+
+library_watcher_update library_watcher_impl::apply()
+{
+#if defined(__linux__)
+    // The pending changes are discarded however the batch ends, so that a
+    // batch that cannot be applied is not retried by every later poll.
+    struct pending_clearer
+    {
+        library_watcher_impl& watcher;
+        ~pending_clearer() { watcher.clear_pending(); }
+    } clearer{*this};
+
+    // Moves whose destination was never seen were out of the watched
+    // directories.
+    for (auto&& move : pending_moves_)
+    {
+        if (move.second.second)
+        {
+            directory_removed(move.second.first);
+        }
+        else
+        {
+            file_removed(move.second.first);
+        }
+    }
+
+    pending_moves_.clear();
+
+    library_watcher_update update;
+    auto tracks_within = [&](const std::string& directory) {
+        track_query query;
+        if (!directory.empty())
+        {
+            query.where(
+                track_field::relative_path,
+                track_query::comparison::greater_equal, directory + "/");
+            auto upper_bound = prefix_upper_bound(directory + "/");
+            if (upper_bound)
+            {
+                query.where(
+                    track_field::relative_path, track_query::comparison::less,
+                    *upper_bound);
+            }
+        }
+
+        std::vector<track> tracks;
+        auto cursor = db_.query_tracks(query);
+        while (auto t = cursor.next())
+        {
+            tracks.push_back(*t);
+        }
+
+        return tracks;
+    };
+
+    auto trans = db_.begin_transaction();
+    for (auto&& rename : directory_renames_)
+    {
+        int64_t relocated_count;
+        try
+        {
+            relocated_count =
+                db_.relocate_tracks(rename.first + "/", rename.second + "/");
+        }
+        catch (const std::runtime_error&)
+        {
+            // Tracks already exist at some of the new paths, and no path has
+            // been changed.
+            update.failed_directory_renames.push_back(rename);
+            continue;
+        }
+
+        if (relocated_count > 0)
+        {
+            for (auto&& t : tracks_within(rename.second))
+            {
+                update.relocated_tracks.push_back(t);
+            }
+        }
+    }
+
+    for (auto&& entry : origins_by_path_)
+    {
+        auto& path = entry.first;
+        if (!is_regular_file(absolute_path(path)))
+        {
+            continue;
+        }
+
+        auto tracks_at_path = db_.tracks_by_relative_path(path);
+        if (!tracks_at_path.empty())
+        {
+            continue;
+        }
+
+        auto origin_path = current_of(entry.second);
+        if (origin_path != path)
+        {
+            auto tracks_at_origin = db_.tracks_by_relative_path(origin_path);
+            if (!tracks_at_origin.empty())
+            {
+                tracks_at_origin.front().set_relative_path(path);
+                update.relocated_tracks.push_back(tracks_at_origin.front());
+                continue;
+            }
+        }
+
+        if (has_music_extension(path))
+        {
+            update.created_tracks.push_back(db_.create_track(path));
+        }
+    }
+
+    for (auto&& origin : removed_origins_)
+    {
+        auto path = current_of(origin);
+        if (!exists(absolute_path(path)))
+        {
+            for (auto&& t : db_.tracks_by_relative_path(path))
+            {
+                update.deleted_tracks.push_back(t);
+            }
+        }
+    }
+
+    for (auto&& origin : removed_directory_origins_)
+    {
+        for (auto&& t : tracks_within(current_of(origin)))
+        {
+            auto is_reported = [&](const track& deleted) {
+                return deleted.id() == t.id();
+            };
+            if (!exists(absolute_path(t.relative_path())) &&
+                std::none_of(
+                    update.deleted_tracks.begin(), update.deleted_tracks.end(),
+                    is_reported))
+            {
+                update.deleted_tracks.push_back(t);
+            }
+        }
+    }
+
+    trans.commit();
+    return update;
+#else
+    return library_watcher_update{};
+#endif
+}
+
+}  // namespace djinterop
@@ -0,0 +1,92 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/library_watcher.hpp>
+
+namespace djinterop
+{
+/// Watches directories of music files with inotify, and applies the changes
+/// seen to a database through its public interface.
+///
+/// Changes are gathered in terms of the paths of files as they were before
+/// the batch began, called their origins, so that a batch can be applied in
+/// any order regardless of how its changes were interleaved.
+class library_watcher_impl
+{
+public:
+    library_watcher_impl(
+        database db, const std::vector<std::string>& relative_directories,
+        library_watcher_options options);
+    library_watcher_impl(const library_watcher_impl&) = delete;
+    library_watcher_impl& operator=(const library_watcher_impl&) = delete;
+    ~library_watcher_impl();
+
+    int native_handle() const noexcept;
+    library_watcher_update poll(std::chrono::milliseconds timeout);
+    size_t watched_directory_count() const;
+
+private:
+    std::string absolute_path(const std::string& relative_path) const;
+    bool has_music_extension(const std::string& relative_path) const;
+
+    void add_watch(const std::string& relative_directory, bool scan);
+    void remove_watches(const std::string& relative_directory);
+    bool wait_readable(std::chrono::milliseconds timeout) const;
+    void read_events();
+
+    void file_written(const std::string& path);
+    void file_removed(const std::string& path);
+    void file_moved(const std::string& from, const std::string& to);
+    void directory_moved(const std::string& from, const std::string& to);
+    void directory_removed(const std::string& path);
+
+    std::string origin_of(const std::string& path) const;
+    std::string current_of(const std::string& origin) const;
+    library_watcher_update apply();
+    void clear_pending() noexcept;
+
+    database db_;
+    library_watcher_options options_;
+    int fd_ = -1;
+    std::map<int, std::string> directories_by_watch_;
+
+    /// Pending changes, being the origin of each file written or moved to
+    /// a path, the origins of files removed, directories renamed in order,
+    /// and the origins of directories whose tracks must be checked.
+    std::map<std::string, std::string> origins_by_path_;
+    std::set<std::string> removed_origins_;
+    std::vector<std::pair<std::string, std::string> > directory_renames_;
+    std::set<std::string> removed_directory_origins_;
+
+    /// Moves from a path whose destination has not yet been seen, by cookie,
+    /// along with whether the path is a directory.
+    std::map<uint32_t, std::pair<std::string, bool> > pending_moves_;
+};
+
+}  // namespace djinterop
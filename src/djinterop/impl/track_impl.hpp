@@ -28,6 +28,7 @@ namespace djinterop
 {
 class database;
 class track;
+struct track_changes;
 struct track_import_info;
 enum class musical_key;
 
@@ -61,6 +62,7 @@ public:
     virtual void set_comment(stdx::optional<std::string> comment) = 0;
     virtual stdx::optional<std::string> composer() = 0;
     virtual void set_composer(stdx::optional<std::string> composer) = 0;
+    virtual void commit_edit(const track_changes& changes) = 0;
     virtual std::vector<crate> containing_crates() = 0;
     virtual database db() = 0;
     virtual std::vector<beatgrid_marker> default_beatgrid() = 0;
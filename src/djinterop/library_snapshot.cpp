@@ -0,0 +1,554 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include <djinterop/impl/library_snapshot_impl.hpp>
+#include <djinterop/library_snapshot.hpp>
+
+namespace djinterop
+{
+namespace
+{
+constexpr uint32_t encoding_version = 1;
+constexpr uint32_t encoding_byte_order_mark = 0x01020304;
+
+enum presence_bit : uint8_t
+{
+    has_bitrate = 1 << 0,
+    has_bpm = 1 << 1,
+    has_duration = 1 << 2,
+    has_key = 1 << 3,
+    has_year = 1 << 4,
+};
+
+template <typename T>
+void encode_value(std::vector<char>& out, const T& value)
+{
+    auto ptr = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), ptr, ptr + sizeof value);
+}
+
+template <typename T>
+void encode_column(std::vector<char>& out, const std::vector<T>& column)
+{
+    auto ptr = reinterpret_cast<const char*>(column.data());
+    out.insert(out.end(), ptr, ptr + column.size() * sizeof(T));
+}
+
+/// Reads fixed-width values from a buffer, checking bounds as it goes.
+class decoder
+{
+public:
+    decoder(const char* data, size_t size) : ptr_{data}, end_{data + size} {}
+
+    template <typename T>
+    T value()
+    {
+        T result;
+        std::memcpy(&result, take(sizeof result), sizeof result);
+        return result;
+    }
+
+    template <typename T>
+    std::vector<T> column(size_t count)
+    {
+        if (count > static_cast<size_t>(end_ - ptr_) / sizeof(T))
+        {
+            throw std::invalid_argument{
+                "Library snapshot data is shorter than expected"};
+        }
+
+        std::vector<T> result(count);
+        std::memcpy(result.data(), take(count * sizeof(T)), count * sizeof(T));
+        return result;
+    }
+
+    const char* take(size_t size)
+    {
+        if (size > static_cast<size_t>(end_ - ptr_))
+        {
+            throw std::invalid_argument{
+                "Library snapshot data is shorter than expected"};
+        }
+
+        auto result = ptr_;
+        ptr_ += size;
+        return result;
+    }
+
+    bool at_end() const noexcept { return ptr_ == end_; }
+
+private:
+    const char* ptr_;
+    const char* end_;
+};
+
+double numeric_value(double value)
+{
+    return value;
+}
+
+double numeric_value(int64_t value)
+{
+    return static_cast<double>(value);
+}
+
+double numeric_value(int32_t value)
+{
+    return value;
+}
+
+double numeric_value(musical_key value)
+{
+    return static_cast<int>(value);
+}
+
+double numeric_value(std::chrono::milliseconds value)
+{
+    return value.count() / 1000.0;
+}
+
+template <typename T>
+std::vector<size_t> rows_in_range_of(
+    const std::vector<stdx::optional<T> >& column, double min, double max)
+{
+    std::vector<size_t> results;
+    for (size_t row = 0; row < column.size(); ++row)
+    {
+        if (column[row])
+        {
+            auto value = numeric_value(*column[row]);
+            if (value >= min && value <= max)
+            {
+                results.push_back(row);
+            }
+        }
+    }
+
+    return results;
+}
+
+/// Sort rows by a key, placing rows without a key last, and leaving rows with
+/// equal keys in their original order.
+template <typename HasKey, typename Less>
+std::vector<size_t> sort_rows(
+    size_t count, HasKey has_key, Less less, bool descending)
+{
+    std::vector<size_t> rows(count);
+    std::iota(rows.begin(), rows.end(), 0);
+    auto end_of_keyed =
+        std::stable_partition(rows.begin(), rows.end(), has_key);
+    if (descending)
+    {
+        std::stable_sort(
+            rows.begin(), end_of_keyed,
+            [&](size_t a, size_t b) { return less(b, a); });
+    }
+    else
+    {
+        std::stable_sort(rows.begin(), end_of_keyed, less);
+    }
+
+    return rows;
+}
+
+template <typename T>
+std::vector<size_t> sort_rows_by(
+    const std::vector<stdx::optional<T> >& column, bool descending)
+{
+    return sort_rows(
+        column.size(), [&](size_t row) { return !!column[row]; },
+        [&](size_t a, size_t b) { return *column[a] < *column[b]; },
+        descending);
+}
+
+}  // namespace
+
+const std::vector<library_snapshot::text_ref>& library_snapshot::albums()
+    const noexcept
+{
+    return pimpl_->albums;
+}
+
+const std::vector<library_snapshot::text_ref>& library_snapshot::artists()
+    const noexcept
+{
+    return pimpl_->artists;
+}
+
+const std::vector<stdx::optional<int64_t> >& library_snapshot::bitrates()
+    const noexcept
+{
+    return pimpl_->bitrates;
+}
+
+const std::vector<stdx::optional<double> >& library_snapshot::bpms()
+    const noexcept
+{
+    return pimpl_->bpms;
+}
+
+library_snapshot library_snapshot::decode(const char* data, size_t size)
+{
+    decoder in{data, size};
+    if (in.value<uint32_t>() != encoding_version ||
+        in.value<uint32_t>() != encoding_byte_order_mark)
+    {
+        throw std::invalid_argument{
+            "Library snapshot data has an unsupported version or byte order"};
+    }
+
+    auto row_count = in.value<uint64_t>();
+    auto text_count = in.value<uint64_t>();
+    auto ids = in.column<int64_t>(row_count);
+    auto bpms = in.column<double>(row_count);
+    auto durations = in.column<int64_t>(row_count);
+    auto bitrates = in.column<int64_t>(row_count);
+    auto keys = in.column<int32_t>(row_count);
+    auto years = in.column<int32_t>(row_count);
+    auto presence = in.column<uint8_t>(row_count);
+
+    auto pimpl = std::make_shared<library_snapshot_impl>();
+    pimpl->albums = in.column<text_ref>(row_count);
+    pimpl->artists = in.column<text_ref>(row_count);
+    pimpl->genres = in.column<text_ref>(row_count);
+    pimpl->titles = in.column<text_ref>(row_count);
+    auto text_ends = in.column<uint64_t>(text_count);
+    pimpl->text_ranks = in.column<uint32_t>(text_count);
+    auto heap_size = text_count == 0 ? 0 : text_ends.back();
+    auto heap = in.take(heap_size);
+    if (!in.at_end() || text_count == 0)
+    {
+        throw std::invalid_argument{
+            "Library snapshot data has an unexpected length"};
+    }
+
+    pimpl->texts.clear();
+    pimpl->text_by_value.clear();
+    pimpl->texts.reserve(text_count);
+    pimpl->text_by_value.reserve(text_count);
+    uint64_t begin = 0;
+    for (auto end : text_ends)
+    {
+        if (end < begin || end > heap_size)
+        {
+            throw std::invalid_argument{
+                "Library snapshot data has an invalid string heap"};
+        }
+
+        pimpl->text_by_value.emplace(
+            std::string{heap + begin, heap + end},
+            static_cast<text_ref>(pimpl->texts.size()));
+        pimpl->texts.emplace_back(heap + begin, heap + end);
+        begin = end;
+    }
+
+    for (auto&& column :
+         {&pimpl->albums, &pimpl->artists, &pimpl->genres, &pimpl->titles})
+    {
+        for (auto ref : *column)
+        {
+            if (ref >= text_count)
+            {
+                throw std::invalid_argument{
+                    "Library snapshot data has an invalid string reference"};
+            }
+        }
+    }
+
+    pimpl->ids = std::move(ids);
+    pimpl->bitrates.resize(row_count);
+    pimpl->bpms.resize(row_count);
+    pimpl->durations.resize(row_count);
+    pimpl->keys.resize(row_count);
+    pimpl->years.resize(row_count);
+    pimpl->row_by_id.reserve(row_count);
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        auto present = presence[row];
+        if (present & has_bitrate)
+        {
+            pimpl->bitrates[row] = bitrates[row];
+        }
+        if (present & has_bpm)
+        {
+            pimpl->bpms[row] = bpms[row];
+        }
+        if (present & has_duration)
+        {
+            pimpl->durations[row] = std::chrono::milliseconds{durations[row]};
+        }
+        if (present & has_key)
+        {
+            pimpl->keys[row] = static_cast<musical_key>(keys[row]);
+        }
+        if (present & has_year)
+        {
+            pimpl->years[row] = years[row];
+        }
+
+        pimpl->row_by_id.emplace(pimpl->ids[row], row);
+    }
+
+    return library_snapshot{std::move(pimpl)};
+}
+
+const std::vector<stdx::optional<std::chrono::milliseconds> >&
+library_snapshot::durations() const noexcept
+{
+    return pimpl_->durations;
+}
+
+std::vector<char> library_snapshot::encode() const
+{
+    auto row_count = size();
+    std::vector<double> bpms(row_count);
+    std::vector<int64_t> durations(row_count);
+    std::vector<int64_t> bitrates(row_count);
+    std::vector<int32_t> keys(row_count);
+    std::vector<int32_t> years(row_count);
+    std::vector<uint8_t> presence(row_count);
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        uint8_t present = 0;
+        if (pimpl_->bitrates[row])
+        {
+            bitrates[row] = *pimpl_->bitrates[row];
+            present |= has_bitrate;
+        }
+        if (pimpl_->bpms[row])
+        {
+            bpms[row] = *pimpl_->bpms[row];
+            present |= has_bpm;
+        }
+        if (pimpl_->durations[row])
+        {
+            durations[row] = pimpl_->durations[row]->count();
+            present |= has_duration;
+        }
+        if (pimpl_->keys[row])
+        {
+            keys[row] = static_cast<int32_t>(*pimpl_->keys[row]);
+            present |= has_key;
+        }
+        if (pimpl_->years[row])
+        {
+            years[row] = *pimpl_->years[row];
+            present |= has_year;
+        }
+
+        presence[row] = present;
+    }
+
+    std::vector<uint64_t> text_ends;
+    text_ends.reserve(pimpl_->texts.size());
+    uint64_t heap_size = 0;
+    for (auto&& text : pimpl_->texts)
+    {
+        heap_size += text.size();
+        text_ends.push_back(heap_size);
+    }
+
+    std::vector<char> out;
+    encode_value(out, encoding_version);
+    encode_value(out, encoding_byte_order_mark);
+    encode_value(out, static_cast<uint64_t>(row_count));
+    encode_value(out, static_cast<uint64_t>(pimpl_->texts.size()));
+    encode_column(out, pimpl_->ids);
+    encode_column(out, bpms);
+    encode_column(out, durations);
+    encode_column(out, bitrates);
+    encode_column(out, keys);
+    encode_column(out, years);
+    encode_column(out, presence);
+    encode_column(out, pimpl_->albums);
+    encode_column(out, pimpl_->artists);
+    encode_column(out, pimpl_->genres);
+    encode_column(out, pimpl_->titles);
+    encode_column(out, text_ends);
+    encode_column(out, pimpl_->text_ranks);
+    out.reserve(out.size() + heap_size);
+    for (auto&& text : pimpl_->texts)
+    {
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+    return out;
+}
+
+stdx::optional<library_snapshot::text_ref> library_snapshot::find_text(
+    const std::string& text) const
+{
+    auto iter = pimpl_->text_by_value.find(text);
+    if (iter == pimpl_->text_by_value.end())
+    {
+        return stdx::nullopt;
+    }
+
+    return iter->second;
+}
+
+const std::vector<library_snapshot::text_ref>& library_snapshot::genres()
+    const noexcept
+{
+    return pimpl_->genres;
+}
+
+const std::vector<int64_t>& library_snapshot::ids() const noexcept
+{
+    return pimpl_->ids;
+}
+
+const std::vector<stdx::optional<musical_key> >& library_snapshot::keys()
+    const noexcept
+{
+    return pimpl_->keys;
+}
+
+stdx::optional<size_t> library_snapshot::row_of(int64_t id) const
+{
+    auto iter = pimpl_->row_by_id.find(id);
+    if (iter == pimpl_->row_by_id.end())
+    {
+        return stdx::nullopt;
+    }
+
+    return iter->second;
+}
+
+std::vector<size_t> library_snapshot::rows_in_range(
+    library_column column, double min, double max) const
+{
+    switch (column)
+    {
+        case library_column::bitrate:
+            return rows_in_range_of(pimpl_->bitrates, min, max);
+        case library_column::bpm:
+            return rows_in_range_of(pimpl_->bpms, min, max);
+        case library_column::duration:
+            return rows_in_range_of(pimpl_->durations, min, max);
+        case library_column::key:
+            return rows_in_range_of(pimpl_->keys, min, max);
+        case library_column::year:
+            return rows_in_range_of(pimpl_->years, min, max);
+        default:
+            throw std::invalid_argument{
+                "Cannot filter a text column by numeric range"};
+    }
+}
+
+std::vector<size_t> library_snapshot::rows_with_text(
+    library_column column, const std::string& text) const
+{
+    auto& refs = text_column(column);
+    auto ref = find_text(text);
+    if (!ref)
+    {
+        return {};
+    }
+
+    std::vector<size_t> results;
+    for (size_t row = 0; row < refs.size(); ++row)
+    {
+        if (refs[row] == *ref)
+        {
+            results.push_back(row);
+        }
+    }
+
+    return results;
+}
+
+size_t library_snapshot::size() const noexcept
+{
+    return pimpl_->ids.size();
+}
+
+std::vector<size_t> library_snapshot::sorted_rows(
+    library_column column, bool descending) const
+{
+    switch (column)
+    {
+        case library_column::bitrate:
+            return sort_rows_by(pimpl_->bitrates, descending);
+        case library_column::bpm:
+            return sort_rows_by(pimpl_->bpms, descending);
+        case library_column::duration:
+            return sort_rows_by(pimpl_->durations, descending);
+        case library_column::key:
+            return sort_rows_by(pimpl_->keys, descending);
+        case library_column::year:
+            return sort_rows_by(pimpl_->years, descending);
+        default:
+            break;
+    }
+
+    auto& refs = text_column(column);
+    auto& ranks = pimpl_->text_ranks;
+    return sort_rows(
+        refs.size(), [&](size_t row) { return refs[row] != no_text; },
+        [&](size_t a, size_t b) { return ranks[refs[a]] < ranks[refs[b]]; },
+        descending);
+}
+
+const std::string& library_snapshot::text(text_ref ref) const
+{
+    return pimpl_->texts.at(ref);
+}
+
+const std::vector<library_snapshot::text_ref>& library_snapshot::titles()
+    const noexcept
+{
+    return pimpl_->titles;
+}
+
+const std::vector<stdx::optional<int32_t> >& library_snapshot::years()
+    const noexcept
+{
+    return pimpl_->years;
+}
+
+library_snapshot::library_snapshot(
+    std::shared_ptr<library_snapshot_impl> pimpl) :
+    pimpl_{std::move(pimpl)}
+{
+}
+
+const std::vector<library_snapshot::text_ref>& library_snapshot::text_column(
+    library_column column) const
+{
+    switch (column)
+    {
+        case library_column::album:
+            return pimpl_->albums;
+        case library_column::artist:
+            return pimpl_->artists;
+        case library_column::genre:
+            return pimpl_->genres;
+        case library_column::title:
+            return pimpl_->titles;
+        default:
+            throw std::invalid_argument{"Column is not a text column"};
+    }
+}
+
+}  // namespace djinterop
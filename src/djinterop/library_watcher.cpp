@@ -0,0 +1,46 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <djinterop/impl/library_watcher_impl.hpp>
+#include <djinterop/library_watcher.hpp>
+
+namespace djinterop
+{
+library_watcher::library_watcher(
+    std::shared_ptr<library_watcher_impl> pimpl) noexcept :
+    pimpl_{std::move(pimpl)}
+{
+}
+
+int library_watcher::native_handle() const noexcept
+{
+    return pimpl_->native_handle();
+}
+
+library_watcher_update library_watcher::poll(
+    std::chrono::milliseconds timeout) const
+{
+    return pimpl_->poll(timeout);
+}
+
+size_t library_watcher::watched_directory_count() const
+{
+    return pimpl_->watched_directory_count();
+}
+
+}  // namespace djinterop
@@ -0,0 +1,134 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <djinterop/mapped_file.hpp>
+
+namespace djinterop
+{
+#if defined(_WIN32)
+mapped_file::mapped_file(const std::string& path)
+{
+    file_ = CreateFileA(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        file_ = nullptr;
+        throw std::runtime_error{"Failed to open file for mapping"};
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_, &file_size))
+    {
+        CloseHandle(file_);
+        throw std::runtime_error{"Failed to get size of file for mapping"};
+    }
+
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0)
+    {
+        return;
+    }
+
+    mapping_ =
+        CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_)
+    {
+        CloseHandle(file_);
+        throw std::runtime_error{"Failed to map file"};
+    }
+
+    data_ = static_cast<const char*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_)
+    {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error{"Failed to map file"};
+    }
+}
+
+mapped_file::~mapped_file()
+{
+    if (data_)
+    {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_)
+    {
+        CloseHandle(mapping_);
+    }
+    if (file_)
+    {
+        CloseHandle(file_);
+    }
+}
+#else
+mapped_file::mapped_file(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error{"Failed to open file for mapping"};
+    }
+
+    struct stat buf;
+    if (fstat(fd, &buf) != 0)
+    {
+        close(fd);
+        throw std::runtime_error{"Failed to get size of file for mapping"};
+    }
+
+    size_ = static_cast<size_t>(buf.st_size);
+    if (size_ == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // The mapping remains valid after the descriptor is closed.
+    auto addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        throw std::runtime_error{"Failed to map file"};
+    }
+
+    data_ = static_cast<const char*>(addr);
+}
+
+mapped_file::~mapped_file()
+{
+    if (data_)
+    {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+#endif
+
+}  // namespace djinterop
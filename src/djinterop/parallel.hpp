@@ -0,0 +1,93 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace djinterop
+{
+/// Call a function for each index below a count, on at most a given number
+/// of threads, passing the index and the number of the calling thread.
+///
+/// Indices are handed out to threads one at a time, so that slow calls do not
+/// hold up the remaining indices.  If any call throws, no further indices are
+/// handed out, and the first exception is rethrown once all threads have
+/// finished.
+template <typename Function>
+void for_each_in_parallel(size_t count, size_t max_threads, Function function)
+{
+    std::atomic<size_t> next_index{0};
+    std::exception_ptr first_exception;
+    std::mutex first_exception_mutex;
+    auto thread_count = std::min(max_threads, count);
+    std::vector<std::thread> threads;
+    auto join_all = [&] {
+        for (auto&& thread : threads)
+        {
+            thread.join();
+        }
+    };
+
+    try
+    {
+        for (size_t t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([&, t] {
+                try
+                {
+                    for (auto index = next_index++; index < count;
+                         index = next_index++)
+                    {
+                        function(index, t);
+                    }
+                }
+                catch (...)
+                {
+                    next_index = count;
+                    std::lock_guard<std::mutex> lock{first_exception_mutex};
+                    if (!first_exception)
+                    {
+                        first_exception = std::current_exception();
+                    }
+                }
+            });
+        }
+    }
+    catch (...)
+    {
+        // Threads already started must be joined before they are destroyed.
+        next_index = count;
+        join_all();
+        throw;
+    }
+
+    join_all();
+    if (first_exception)
+    {
+        std::rethrow_exception(first_exception);
+    }
+}
+
+}  // namespace djinterop
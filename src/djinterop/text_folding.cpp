@@ -0,0 +1,220 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/text_folding.hpp>
+
+namespace djinterop
+{
+namespace
+{
+constexpr char32_t replacement_character = 0xFFFD;
+
+/// Base letters of U+00C0 to U+00FF, where '*' marks a code point that is
+/// folded specially, and '-' one that is left alone.
+constexpr char latin_1_base_letters[] =
+    "aaaaaa*ceeeeiiii"
+    "dnooooo-ouuuuy**"
+    "aaaaaa*ceeeeiiii"
+    "dnooooo-ouuuuy*y";
+
+/// Base letters of U+0100 to U+017F.
+constexpr char latin_extended_a_base_letters[] =
+    "aaaaaaccccccccdd"
+    "ddeeeeeeeeeegggg"
+    "gggghhhhiiiiiiii"
+    "iiiijjkkklllllll"
+    "lllnnnnnnnnnoooo"
+    "oooorrrrrrssssss"
+    "ssttttttuuuuuuuu"
+    "uuuuwwyyyzzzzzzs";
+
+static_assert(sizeof latin_1_base_letters == 64 + 1);
+static_assert(sizeof latin_extended_a_base_letters == 128 + 1);
+
+bool is_space(char32_t c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+           c == '\f' || c == 0x00A0 || c == 0x3000 ||
+           (c >= 0x2000 && c <= 0x200A);
+}
+
+/// Append the folded form of a code point, which may be empty or more than
+/// one code point long.
+void append_folded(std::u32string& out, char32_t c)
+{
+    if (c >= 'A' && c <= 'Z')
+    {
+        out.push_back(c + ('a' - 'A'));
+    }
+    else if (c < 0xC0)
+    {
+        out.push_back(c);
+    }
+    else if (c <= 0xFF)
+    {
+        auto base = latin_1_base_letters[c - 0xC0];
+        switch (c)
+        {
+            case 0xC6:
+            case 0xE6: out += U"ae"; break;
+            case 0xDE:
+            case 0xFE: out += U"th"; break;
+            case 0xDF: out += U"ss"; break;
+            default: out.push_back(base == '-' ? c : char32_t(base)); break;
+        }
+    }
+    else if (c <= 0x17F)
+    {
+        switch (c)
+        {
+            case 0x152:
+            case 0x153: out += U"oe"; break;
+            default:
+                out.push_back(latin_extended_a_base_letters[c - 0x100]);
+                break;
+        }
+    }
+    else if (c >= 0x300 && c <= 0x36F)
+    {
+        // Combining diacritical marks are dropped.
+    }
+    else if (c >= 0x391 && c <= 0x3A9 && c != 0x3A2)
+    {
+        out.push_back(c + 0x20);
+    }
+    else if (c >= 0x400 && c <= 0x40F)
+    {
+        out.push_back(c + 0x50);
+    }
+    else if (c >= 0x410 && c <= 0x42F)
+    {
+        out.push_back(c + 0x20);
+    }
+    else
+    {
+        out.push_back(c);
+    }
+}
+
+}  // namespace
+
+std::u32string decode_utf8(std::string_view text)
+{
+    std::u32string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size();)
+    {
+        auto lead = static_cast<unsigned char>(text[i]);
+        size_t length = lead < 0x80              ? 1
+                        : (lead & 0xE0) == 0xC0 ? 2
+                        : (lead & 0xF0) == 0xE0 ? 3
+                        : (lead & 0xF8) == 0xF0 ? 4
+                                                 : 0;
+        if (length == 0 || i + length > text.size())
+        {
+            result.push_back(replacement_character);
+            ++i;
+            continue;
+        }
+
+        char32_t c = length == 1 ? lead : lead & (0x7F >> length);
+        bool valid = true;
+        for (size_t j = 1; j < length; ++j)
+        {
+            auto byte = static_cast<unsigned char>(text[i + j]);
+            if ((byte & 0xC0) != 0x80)
+            {
+                valid = false;
+                break;
+            }
+
+            c = (c << 6) | (byte & 0x3F);
+        }
+
+        if (!valid)
+        {
+            result.push_back(replacement_character);
+            ++i;
+            continue;
+        }
+
+        result.push_back(c);
+        i += length;
+    }
+
+    return result;
+}
+
+std::string encode_utf8(std::u32string_view code_points)
+{
+    std::string result;
+    result.reserve(code_points.size());
+    for (auto c : code_points)
+    {
+        if (c < 0x80)
+        {
+            result.push_back(static_cast<char>(c));
+        }
+        else if (c < 0x800)
+        {
+            result.push_back(static_cast<char>(0xC0 | (c >> 6)));
+            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+        else if (c < 0x10000)
+        {
+            result.push_back(static_cast<char>(0xE0 | (c >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+        else
+        {
+            result.push_back(static_cast<char>(0xF0 | (c >> 18)));
+            result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+
+    return result;
+}
+
+std::string fold_text(std::string_view text)
+{
+    std::u32string folded;
+    folded.reserve(text.size());
+    bool pending_space = false;
+    for (auto c : decode_utf8(text))
+    {
+        if (is_space(c))
+        {
+            pending_space = !folded.empty();
+            continue;
+        }
+
+        if (pending_space)
+        {
+            folded.push_back(' ');
+            pending_space = false;
+        }
+
+        append_folded(folded, c);
+    }
+
+    return encode_utf8(folded);
+}
+
+}  // namespace djinterop
@@ -0,0 +1,43 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace djinterop
+{
+/// Decode UTF-8 text into code points.
+///
+/// Invalid byte sequences are decoded as U+FFFD REPLACEMENT CHARACTER.
+std::u32string decode_utf8(std::string_view text);
+
+/// Encode code points as UTF-8 text.
+std::string encode_utf8(std::u32string_view code_points);
+
+/// Fold UTF-8 text into a form suitable for case- and accent-insensitive
+/// matching.
+///
+/// Letters are lower-cased, Latin letters with diacritics are replaced by
+/// their base letters, and combining diacritical marks are removed, so that
+/// precomposed and decomposed forms of the same text fold identically.  Runs
+/// of whitespace are collapsed to a single space, and leading and trailing
+/// whitespace is removed.
+std::string fold_text(std::string_view text);
+
+}  // namespace djinterop
@@ -25,6 +25,7 @@
 #include <djinterop/impl/database_impl.hpp>
 #include <djinterop/impl/track_impl.hpp>
 #include <djinterop/track.hpp>
+#include <djinterop/track_edit.hpp>
 
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
@@ -214,6 +215,11 @@ stdx::optional<milliseconds> track::duration() const
     return pimpl_->duration();
 }
 
+track_edit track::edit() const
+{
+    return track_edit{pimpl_};
+}
+
 std::string track::file_extension() const
 {
     return pimpl_->file_extension();
@@ -0,0 +1,35 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include <djinterop/impl/track_cursor_impl.hpp>
+#include <djinterop/track_cursor.hpp>
+
+namespace djinterop
+{
+stdx::optional<track> track_cursor::next()
+{
+    return pimpl_->next();
+}
+
+track_cursor::track_cursor(std::shared_ptr<track_cursor_impl> pimpl) noexcept :
+    pimpl_{std::move(pimpl)}
+{
+}
+
+}  // namespace djinterop
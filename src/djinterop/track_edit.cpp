@@ -0,0 +1,237 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate.hpp>
+#include <djinterop/impl/track_impl.hpp>
+#include <djinterop/track_edit.hpp>
+
+using std::chrono::system_clock;
+
+namespace djinterop
+{
+track_edit::track_edit(std::shared_ptr<track_impl> pimpl) noexcept :
+    pimpl_{std::move(pimpl)}
+{
+}
+
+const track_changes& track_edit::changes() const noexcept
+{
+    return changes_;
+}
+
+void track_edit::commit()
+{
+    pimpl_->commit_edit(changes_);
+    changes_ = track_changes{};
+}
+
+track_edit& track_edit::set_adjusted_beatgrid(
+    std::vector<beatgrid_marker> beatgrid)
+{
+    changes_.adjusted_beatgrid = std::move(beatgrid);
+    return *this;
+}
+
+track_edit& track_edit::set_adjusted_main_cue(double sample_offset)
+{
+    changes_.adjusted_main_cue = sample_offset;
+    return *this;
+}
+
+track_edit& track_edit::set_album(stdx::optional<std::string> album)
+{
+    changes_.album = std::move(album);
+    return *this;
+}
+
+track_edit& track_edit::set_album_art_id(stdx::optional<int64_t> album_art_id)
+{
+    changes_.album_art_id = album_art_id;
+    return *this;
+}
+
+track_edit& track_edit::set_artist(stdx::optional<std::string> artist)
+{
+    changes_.artist = std::move(artist);
+    return *this;
+}
+
+track_edit& track_edit::set_average_loudness(
+    stdx::optional<double> average_loudness)
+{
+    changes_.average_loudness = average_loudness;
+    return *this;
+}
+
+track_edit& track_edit::set_bitrate(stdx::optional<int64_t> bitrate)
+{
+    changes_.bitrate = bitrate;
+    return *this;
+}
+
+track_edit& track_edit::set_bpm(stdx::optional<double> bpm)
+{
+    changes_.bpm = bpm;
+    return *this;
+}
+
+track_edit& track_edit::set_comment(stdx::optional<std::string> comment)
+{
+    changes_.comment = std::move(comment);
+    return *this;
+}
+
+track_edit& track_edit::set_composer(stdx::optional<std::string> composer)
+{
+    changes_.composer = std::move(composer);
+    return *this;
+}
+
+track_edit& track_edit::set_default_beatgrid(
+    std::vector<beatgrid_marker> beatgrid)
+{
+    changes_.default_beatgrid = std::move(beatgrid);
+    return *this;
+}
+
+track_edit& track_edit::set_default_main_cue(double sample_offset)
+{
+    changes_.default_main_cue = sample_offset;
+    return *this;
+}
+
+track_edit& track_edit::set_genre(stdx::optional<std::string> genre)
+{
+    changes_.genre = std::move(genre);
+    return *this;
+}
+
+track_edit& track_edit::set_hot_cue_at(
+    int32_t index, stdx::optional<hot_cue> cue)
+{
+    changes_.hot_cues.at(index) = std::move(cue);
+    return *this;
+}
+
+track_edit& track_edit::set_hot_cues(
+    std::array<stdx::optional<hot_cue>, 8> cues)
+{
+    for (size_t i = 0; i < cues.size(); ++i)
+    {
+        changes_.hot_cues[i] = std::move(cues[i]);
+    }
+    return *this;
+}
+
+track_edit& track_edit::set_import_info(
+    const stdx::optional<track_import_info>& import_info)
+{
+    changes_.import_info = import_info;
+    return *this;
+}
+
+track_edit& track_edit::set_key(stdx::optional<musical_key> key)
+{
+    changes_.key = key;
+    return *this;
+}
+
+track_edit& track_edit::set_last_accessed_at(
+    stdx::optional<system_clock::time_point> accessed_at)
+{
+    changes_.last_accessed_at = accessed_at;
+    return *this;
+}
+
+track_edit& track_edit::set_last_modified_at(
+    stdx::optional<system_clock::time_point> modified_at)
+{
+    changes_.last_modified_at = modified_at;
+    return *this;
+}
+
+track_edit& track_edit::set_last_played_at(
+    stdx::optional<system_clock::time_point> played_at)
+{
+    changes_.last_played_at = played_at;
+    return *this;
+}
+
+track_edit& track_edit::set_loop_at(int32_t index, stdx::optional<loop> l)
+{
+    changes_.loops.at(index) = std::move(l);
+    return *this;
+}
+
+track_edit& track_edit::set_loops(std::array<stdx::optional<loop>, 8> loops)
+{
+    for (size_t i = 0; i < loops.size(); ++i)
+    {
+        changes_.loops[i] = std::move(loops[i]);
+    }
+    return *this;
+}
+
+track_edit& track_edit::set_publisher(stdx::optional<std::string> publisher)
+{
+    changes_.publisher = std::move(publisher);
+    return *this;
+}
+
+track_edit& track_edit::set_relative_path(std::string relative_path)
+{
+    changes_.relative_path = std::move(relative_path);
+    return *this;
+}
+
+track_edit& track_edit::set_sampling(stdx::optional<sampling_info> sampling)
+{
+    changes_.sampling = sampling;
+    return *this;
+}
+
+track_edit& track_edit::set_title(stdx::optional<std::string> title)
+{
+    changes_.title = std::move(title);
+    return *this;
+}
+
+track_edit& track_edit::set_track_number(stdx::optional<int32_t> track_number)
+{
+    changes_.track_number = track_number;
+    return *this;
+}
+
+track_edit& track_edit::set_waveform(std::vector<waveform_entry> waveform)
+{
+    changes_.waveform = std::move(waveform);
+    return *this;
+}
+
+track_edit& track_edit::set_year(stdx::optional<int32_t> year)
+{
+    changes_.year = year;
+    return *this;
+}
+
+}  // namespace djinterop
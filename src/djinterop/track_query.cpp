@@ -0,0 +1,170 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdexcept>
+#include <utility>
+
+#include <djinterop/musical_key.hpp>
+#include <djinterop/track_query.hpp>
+
+namespace djinterop
+{
+namespace
+{
+void ensure_matching_value(track_field field, const track_query_value& value)
+{
+    if (value.is_text() != is_text_field(field))
+    {
+        throw std::invalid_argument{
+            is_text_field(field)
+                ? "Text fields can only be compared against text"
+                : "Numeric fields can only be compared against numbers"};
+    }
+}
+
+}  // namespace
+
+bool is_text_field(track_field field) noexcept
+{
+    switch (field)
+    {
+        case track_field::album:
+        case track_field::artist:
+        case track_field::comment:
+        case track_field::composer:
+        case track_field::file_extension:
+        case track_field::filename:
+        case track_field::genre:
+        case track_field::publisher:
+        case track_field::relative_path:
+        case track_field::title: return true;
+        default: return false;
+    }
+}
+
+track_query_value::track_query_value(int value) noexcept :
+    value_{int64_t{value}}
+{
+}
+
+track_query_value::track_query_value(int64_t value) noexcept : value_{value}
+{
+}
+
+track_query_value::track_query_value(double value) noexcept : value_{value}
+{
+}
+
+track_query_value::track_query_value(const char* value) :
+    value_{std::string{value}}
+{
+}
+
+track_query_value::track_query_value(std::string value) noexcept :
+    value_{std::move(value)}
+{
+}
+
+track_query_value::track_query_value(musical_key value) noexcept :
+    value_{static_cast<int64_t>(value)}
+{
+}
+
+bool track_query_value::is_text() const noexcept
+{
+    return std::holds_alternative<std::string>(value_);
+}
+
+const track_query_value::variant_type& track_query_value::get() const noexcept
+{
+    return value_;
+}
+
+track_query& track_query::where(
+    track_field field, comparison op, track_query_value value)
+{
+    if (op == comparison::between || op == comparison::in ||
+        op == comparison::missing)
+    {
+        throw std::invalid_argument{
+            "Comparison does not take a single value"};
+    }
+
+    ensure_matching_value(field, value);
+    predicates_.push_back(predicate{field, op, {std::move(value)}});
+    return *this;
+}
+
+track_query& track_query::where_between(
+    track_field field, track_query_value min, track_query_value max)
+{
+    ensure_matching_value(field, min);
+    ensure_matching_value(field, max);
+    predicates_.push_back(
+        predicate{field, comparison::between, {std::move(min), std::move(max)}});
+    return *this;
+}
+
+track_query& track_query::where_in(
+    track_field field, std::vector<track_query_value> values)
+{
+    for (auto&& value : values)
+    {
+        ensure_matching_value(field, value);
+    }
+
+    predicates_.push_back(predicate{field, comparison::in, std::move(values)});
+    return *this;
+}
+
+track_query& track_query::where_missing(track_field field)
+{
+    predicates_.push_back(predicate{field, comparison::missing, {}});
+    return *this;
+}
+
+track_query& track_query::order_by(track_field field, bool descending)
+{
+    sort_keys_.push_back(sort_key{field, descending});
+    return *this;
+}
+
+track_query& track_query::limit(size_t max_results)
+{
+    max_results_ = max_results;
+    return *this;
+}
+
+const std::vector<track_query::predicate>& track_query::predicates()
+    const noexcept
+{
+    return predicates_;
+}
+
+const std::vector<track_query::sort_key>& track_query::sort_keys()
+    const noexcept
+{
+    return sort_keys_;
+}
+
+stdx::optional<size_t> track_query::max_results() const noexcept
+{
+    return max_results_;
+}
+
+}  // namespace djinterop
@@ -98,4 +98,20 @@ stdx::optional<std::string> get_file_extension(const std::string& file_path)
     return file_extension;
 }
 
+stdx::optional<std::string> prefix_upper_bound(std::string prefix)
+{
+    while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xFF)
+    {
+        prefix.pop_back();
+    }
+
+    if (prefix.empty())
+    {
+        return stdx::nullopt;
+    }
+
+    prefix.back() = static_cast<char>(prefix.back() + 1);
+    return prefix;
+}
+
 }  // namespace djinterop
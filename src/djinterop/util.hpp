@@ -29,4 +29,8 @@ std::string generate_random_uuid();
 std::string get_filename(const std::string& file_path);
 stdx::optional<std::string> get_file_extension(const std::string& file_path);
 
+/// Get the least string greater than all strings beginning with a given
+/// prefix, or `nullopt` if there is no such string.
+stdx::optional<std::string> prefix_upper_bound(std::string prefix);
+
 }  // namespace djinterop
@@ -0,0 +1,108 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE content_hasher_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <djinterop/content_hasher.hpp>
+
+namespace utf = boost::unit_test;
+
+namespace
+{
+struct known_answer
+{
+    std::string data;
+    uint64_t seed;
+    uint64_t digest;
+};
+
+std::ostream& operator<<(std::ostream& os, const known_answer& answer)
+{
+    os << answer.data.size() << " bytes with seed " << answer.seed;
+    return os;
+}
+
+/// Returns a deterministic sequence of bytes that is longer than the 32-byte
+/// stripe of XXH64 and not a multiple of it.
+std::string patterned_data()
+{
+    std::string data;
+    for (int i = 0; i < 1000; ++i)
+    {
+        data.push_back(static_cast<char>(i * 7 % 256));
+    }
+
+    return data;
+}
+
+// Digests produced by the reference implementation of XXH64.
+const std::vector<known_answer> known_answers{
+    known_answer{"", 0, 0xef46db3751d8e999},
+    known_answer{"a", 0, 0xd24ec4f1a98c6e5b},
+    known_answer{"abc", 0, 0x44bc2cf5ad770999},
+    known_answer{"abc", 1, 0xbea9ca8199328908},
+    known_answer{
+        "The quick brown fox jumps over the lazy dog", 0, 0x0b242d361fda71bc},
+    known_answer{patterned_data(), 0, 0x25275608a9cfc168},
+    known_answer{patterned_data(), 0x9e3779b97f4a7c15, 0x77ecbbeb00a44532},
+};
+
+}  // namespace
+
+BOOST_TEST_DECORATOR(
+    * utf::description("content_hasher::digest() matches reference XXH64"))
+BOOST_DATA_TEST_CASE(
+    digest__known_data__reference_digest, known_answers, answer)
+{
+    // Arrange
+    djinterop::content_hasher hasher{answer.seed};
+
+    // Act
+    hasher.update(answer.data.data(), answer.data.size());
+
+    // Assert
+    BOOST_CHECK_EQUAL(hasher.digest(), answer.digest);
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "content_hasher::update() in chunks gives the same digest as all at once"))
+BOOST_DATA_TEST_CASE(
+    update__chunks__same_digest, utf::data::make({1, 3, 31, 32, 33, 100}),
+    chunk_size)
+{
+    // Arrange
+    auto data = patterned_data();
+    djinterop::content_hasher hasher;
+
+    // Act
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size)
+    {
+        auto size = std::min<size_t>(chunk_size, data.size() - offset);
+        hasher.update(data.data() + offset, size);
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(hasher.digest(), 0x25275608a9cfc168);
+}
@@ -21,14 +21,20 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <boost/filesystem.hpp>
+#include <sqlite_modern_cpp.h>
 
 #include <djinterop/crate.hpp>
+#include <djinterop/crate_membership_index.hpp>
+#include <djinterop/crate_set_expr.hpp>
+#include <djinterop/crate_tree.hpp>
 #include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
 #include <djinterop/exceptions.hpp>
 #include <djinterop/track.hpp>
+#include <djinterop/track_cursor.hpp>
 
 #define STRINGIFY(x) STRINGIFY_(x)
 #define STRINGIFY_(x) #x
@@ -65,6 +71,17 @@ static void copy_test_db_to_temp_dir(const fs::path &temp_dir)
     fs::copy_file(perfdata_db_path, temp_dir / perfdata_db_path.filename());
 }
 
+/// Reads the path of a crate as stored in the database, which the public
+/// API does not expose.
+static std::string stored_crate_path(
+    const djinterop::database &db, const djinterop::crate &cr)
+{
+    sqlite::database music_db{el::music_db_path(db)};
+    std::string path;
+    music_db << "SELECT path FROM Crate WHERE id = ?" << cr.id() >> path;
+    return path;
+}
+
 static void check_crate_2(djinterop::crate c)
 {
     BOOST_CHECK(c.is_valid());
@@ -205,6 +222,42 @@ BOOST_AUTO_TEST_CASE(set_name__existing_track_good_values__saves)
     remove_temp_dir(temp_dir);
 }
 
+BOOST_AUTO_TEST_CASE(crate_by_id__two_lookups__edits_shared)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto id = db.create_root_crate("Foo Crate").id();
+    auto c = *db.crate_by_id(id);
+    auto other = *db.crate_by_id(id);
+
+    // Act
+    other.set_name("Bar Crate");
+
+    // Assert
+    BOOST_CHECK_EQUAL(c.name(), "Bar Crate");
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(remove_crate__live_handle__no_longer_found)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto c = db.create_root_crate("Foo Crate");
+    auto id = c.id();
+
+    // Act
+    db.remove_crate(c);
+
+    // Assert
+    BOOST_CHECK(!db.crate_by_id(id));
+    BOOST_CHECK_THROW(c.name(), djinterop::crate_deleted);
+    auto created = db.create_root_crate("Bar Crate");
+    BOOST_CHECK_EQUAL(db.crate_by_id(created.id())->name(), "Bar Crate");
+    remove_temp_dir(temp_dir);
+}
+
 BOOST_AUTO_TEST_CASE(set_parent__change_hierarchy__saves)
 {
     // Arrange
@@ -323,3 +376,364 @@ BOOST_AUTO_TEST_CASE(create_sub_crate__valid_name__succeeds)
     BOOST_CHECK_EQUAL(child.id(), sc.id());
 }
 
+
+BOOST_AUTO_TEST_CASE(add_tracks__existing_and_duplicate_tracks__adds_once)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_latest);
+    auto c = db.create_root_crate("Root");
+    auto t1 = db.create_track("a.mp3");
+    auto t2 = db.create_track("b.mp3");
+    auto t3 = db.create_track("c.mp3");
+    c.add_track(t1);
+    std::vector<djinterop::track> tracks{t1, t2, t3, t2};
+
+    // Act
+    c.add_tracks(tracks.begin(), tracks.end());
+
+    // Assert
+    auto contained = c.tracks();
+    BOOST_REQUIRE_EQUAL(contained.size(), 3);
+    BOOST_CHECK_EQUAL(contained[0].id(), t1.id());
+    BOOST_CHECK_EQUAL(contained[1].id(), t2.id());
+    BOOST_CHECK_EQUAL(contained[2].id(), t3.id());
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(set_tracks__overlapping_tracks__replaces_contents)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto c = db.create_root_crate("Root");
+    auto t1 = db.create_track("a.mp3");
+    auto t2 = db.create_track("b.mp3");
+    auto t3 = db.create_track("c.mp3");
+    c.add_track(t1);
+    c.add_track(t2);
+    std::vector<int64_t> track_ids{t2.id(), t3.id()};
+
+    // Act
+    c.set_tracks(track_ids.begin(), track_ids.end());
+
+    // Assert
+    auto contained = c.tracks();
+    BOOST_REQUIRE_EQUAL(contained.size(), 2);
+    BOOST_CHECK_EQUAL(contained[0].id(), t2.id());
+    BOOST_CHECK_EQUAL(contained[1].id(), t3.id());
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(set_name__deep_and_wide_hierarchy__saves)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_latest);
+    auto root = db.create_root_crate("Root");
+    std::vector<djinterop::crate> chain{root};
+    for (int i = 0; i < 200; ++i)
+    {
+        chain.push_back(chain.back().create_sub_crate("Deep " +
+                                                      std::to_string(i)));
+    }
+    std::vector<djinterop::crate> wide;
+    for (int i = 0; i < 50; ++i)
+    {
+        auto child = root.create_sub_crate("Wide " + std::to_string(i));
+        for (int j = 0; j < 20; ++j)
+        {
+            wide.push_back(child.create_sub_crate(
+                "Wide " + std::to_string(i) + "." + std::to_string(j)));
+        }
+    }
+
+    // Act
+    root.set_name("Renamed Root");
+    chain[100].set_name("Renamed Deep");
+
+    // Assert
+    BOOST_CHECK_EQUAL(root.name(), "Renamed Root");
+    BOOST_CHECK_EQUAL(chain[100].name(), "Renamed Deep");
+    BOOST_CHECK_EQUAL(root.children().size(), 200 + 50 + 50 * 20);
+    for (size_t i = 1; i < chain.size(); ++i)
+    {
+        BOOST_REQUIRE(chain[i].parent());
+        BOOST_CHECK_EQUAL(chain[i].parent()->id(), chain[i - 1].id());
+    }
+    BOOST_CHECK_EQUAL(chain[200].name(), "Deep 199");
+    BOOST_CHECK_EQUAL(wide.back().name(), "Wide 49.19");
+    BOOST_CHECK_EQUAL(wide.back().parent()->name(), "Wide 49");
+    std::string expected_path = "Renamed Root;";
+    for (size_t i = 1; i < chain.size(); ++i)
+    {
+        expected_path += chain[i].name() + ";";
+        if (i == 1 || i == 99 || i == 100 || i == 101 || i == 200)
+        {
+            BOOST_CHECK_EQUAL(stored_crate_path(db, chain[i]), expected_path);
+        }
+    }
+    BOOST_CHECK_EQUAL(
+        stored_crate_path(db, wide.back()),
+        "Renamed Root;Wide 49;Wide 49.19;");
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(set_parent__crate_with_descendants__moves_subtree)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_latest);
+    auto a = db.create_root_crate("A");
+    auto b = a.create_sub_crate("B");
+    auto c = b.create_sub_crate("C");
+    auto d = db.create_root_crate("D");
+    auto e = d.create_sub_crate("E");
+
+    // Act
+    b.set_parent(e);
+
+    // Assert
+    BOOST_CHECK(a.children().empty());
+    BOOST_CHECK_EQUAL(d.children().size(), 3);
+    BOOST_CHECK_EQUAL(e.children().size(), 2);
+    BOOST_REQUIRE(b.parent());
+    BOOST_CHECK_EQUAL(b.parent()->id(), e.id());
+    BOOST_REQUIRE(c.parent());
+    BOOST_CHECK_EQUAL(c.parent()->id(), b.id());
+    BOOST_CHECK_EQUAL(stored_crate_path(db, b), "D;E;B;");
+    BOOST_CHECK_EQUAL(stored_crate_path(db, c), "D;E;B;C;");
+
+    // Act
+    b.set_parent(djinterop::stdx::nullopt);
+
+    // Assert
+    BOOST_CHECK(!b.parent());
+    BOOST_CHECK(e.children().empty());
+    BOOST_CHECK_EQUAL(b.children().size(), 1);
+    BOOST_CHECK_EQUAL(db.root_crates().size(), 3);
+    BOOST_CHECK_EQUAL(stored_crate_path(db, b), "B;");
+    BOOST_CHECK_EQUAL(stored_crate_path(db, c), "B;C;");
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(set_parent__descendant_as_parent__throws)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto a = db.create_root_crate("A");
+    auto b = a.create_sub_crate("B");
+    auto c = b.create_sub_crate("C");
+
+    // Act/Assert
+    BOOST_CHECK_THROW(a.set_parent(c), djinterop::crate_invalid_parent);
+    BOOST_CHECK_THROW(a.set_parent(a), djinterop::crate_invalid_parent);
+    BOOST_CHECK(!a.parent());
+    BOOST_CHECK_EQUAL(a.children().size(), 2);
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(load_crate_tree__hierarchy__expected_lookups)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_latest);
+    auto a = db.create_root_crate("A");
+    auto b = a.create_sub_crate("B");
+    auto c = b.create_sub_crate("C");
+    auto d = a.create_sub_crate("D");
+    auto e = db.create_root_crate("E");
+
+    // Act
+    auto tree = db.load_crate_tree();
+
+    // Assert
+    BOOST_CHECK_EQUAL(tree.nodes().size(), 5);
+    BOOST_REQUIRE_EQUAL(tree.root_ids().size(), 2);
+    BOOST_CHECK_EQUAL(tree.root_ids()[0], a.id());
+    BOOST_CHECK_EQUAL(tree.root_ids()[1], e.id());
+    auto node = tree.find(b.id());
+    BOOST_REQUIRE(node);
+    BOOST_CHECK_EQUAL(node->name, "B");
+    BOOST_REQUIRE(node->parent_id);
+    BOOST_CHECK_EQUAL(*node->parent_id, a.id());
+    BOOST_REQUIRE_EQUAL(node->child_ids.size(), 1);
+    BOOST_CHECK_EQUAL(node->child_ids[0], c.id());
+    BOOST_CHECK(!tree.find(12345));
+    auto root = tree.find_child(djinterop::stdx::nullopt, "E");
+    BOOST_REQUIRE(root);
+    BOOST_CHECK_EQUAL(root->id, e.id());
+    auto child = tree.find_child(a.id(), "D");
+    BOOST_REQUIRE(child);
+    BOOST_CHECK_EQUAL(child->id, d.id());
+    BOOST_CHECK(!tree.find_child(a.id(), "C"));
+    auto descendants = tree.descendant_ids(a.id());
+    BOOST_REQUIRE_EQUAL(descendants.size(), 3);
+    BOOST_CHECK_EQUAL(descendants[0], b.id());
+    BOOST_CHECK_EQUAL(descendants[1], c.id());
+    BOOST_CHECK_EQUAL(descendants[2], d.id());
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(refresh__crates_changed__reloads)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto a = db.create_root_crate("A");
+    auto tree = db.load_crate_tree();
+
+    // Act/Assert
+    BOOST_CHECK(!tree.refresh());
+
+    a.create_sub_crate("B");
+    BOOST_CHECK(tree.refresh());
+    BOOST_CHECK(tree.find_child(a.id(), "B"));
+    BOOST_CHECK(!tree.refresh());
+
+    auto other_db = el::load_database(temp_dir.string());
+    other_db.create_root_crate("C");
+    BOOST_CHECK(tree.refresh());
+    BOOST_CHECK(tree.find_child(djinterop::stdx::nullopt, "C"));
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(refresh__load_fails__snapshot_kept_and_retried)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto a = db.create_root_crate("A");
+    auto tree = db.load_crate_tree();
+    sqlite::database music_db{el::music_db_path(db)};
+    music_db << "INSERT INTO CrateParentList (crateOriginId, crateParentId) "
+                "VALUES (?, ?)"
+             << a.id() << a.id() + 1;
+
+    // Act/Assert
+    BOOST_CHECK_THROW(tree.refresh(), djinterop::crate_database_inconsistency);
+    BOOST_CHECK_EQUAL(tree.nodes().size(), 1);
+    BOOST_CHECK(tree.find(a.id()));
+    BOOST_CHECK_THROW(tree.refresh(), djinterop::crate_database_inconsistency);
+
+    music_db << "DELETE FROM CrateParentList WHERE crateParentId = ?"
+             << a.id() + 1;
+    db.create_root_crate("B");
+    BOOST_CHECK(tree.refresh());
+    BOOST_CHECK_EQUAL(tree.nodes().size(), 2);
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(load_crate_membership_index__crates__expected_tracks)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_latest);
+    auto a = db.create_root_crate("A");
+    auto b = db.create_root_crate("B");
+    auto t1 = db.create_track("a.mp3");
+    auto t2 = db.create_track("b.mp3");
+    auto t3 = db.create_track("c.mp3");
+    std::vector<djinterop::track> a_tracks{t1, t2};
+    std::vector<djinterop::track> b_tracks{t2, t3};
+    a.add_tracks(a_tracks.begin(), a_tracks.end());
+    b.add_tracks(b_tracks.begin(), b_tracks.end());
+
+    // Act
+    auto index = db.load_crate_membership_index();
+
+    // Assert
+    BOOST_CHECK(
+        index.tracks_in(a.id()).to_vector() ==
+        (std::vector<int64_t>{t1.id(), t2.id()}));
+    BOOST_CHECK(
+        index.tracks_in_any({a.id(), b.id()}).to_vector() ==
+        (std::vector<int64_t>{t1.id(), t2.id(), t3.id()}));
+    BOOST_CHECK(
+        index.tracks_in_all({a.id(), b.id()}).to_vector() ==
+        (std::vector<int64_t>{t2.id()}));
+    BOOST_CHECK(
+        (index.tracks_in(a.id()) - index.tracks_in(b.id())).to_vector() ==
+        (std::vector<int64_t>{t1.id()}));
+    BOOST_CHECK(index.tracks_in(12345).empty());
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(load_crate_membership_index__membership_changed__current)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto a = db.create_root_crate("A");
+    auto t1 = db.create_track("a.mp3");
+    auto t2 = db.create_track("b.mp3");
+    auto index = db.load_crate_membership_index();
+
+    // Act/Assert
+    a.add_track(t1);
+    a.add_track(t2);
+    BOOST_CHECK_EQUAL(index.tracks_in(a.id()).size(), 2);
+
+    a.remove_track(t1);
+    BOOST_CHECK(
+        index.tracks_in(a.id()).to_vector() ==
+        (std::vector<int64_t>{t2.id()}));
+
+    a.clear_tracks();
+    BOOST_CHECK(index.tracks_in(a.id()).empty());
+
+    auto other_db = el::load_database(temp_dir.string());
+    other_db.crate_by_id(a.id())->add_track(t1.id());
+    BOOST_CHECK(
+        index.tracks_in(a.id()).to_vector() ==
+        (std::vector<int64_t>{t1.id()}));
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(tracks_in_crates__set_expression__expected_tracks)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_latest);
+    auto a = db.create_root_crate("A");
+    auto a1 = a.create_sub_crate("A1");
+    auto b = db.create_root_crate("B");
+    auto c = db.create_root_crate("C");
+    auto t1 = db.create_track("a.mp3");
+    auto t2 = db.create_track("b.mp3");
+    auto t3 = db.create_track("c.mp3");
+    auto t4 = db.create_track("d.mp3");
+    a.add_track(t1);
+    a1.add_track(t2);
+    b.add_track(t3);
+    b.add_track(t4);
+    c.add_track(t2);
+    c.add_track(t4);
+    auto ids_of = [](djinterop::track_cursor cursor) {
+        std::vector<int64_t> ids;
+        while (auto tr = cursor.next())
+        {
+            ids.push_back(tr->id());
+        }
+        return ids;
+    };
+    using djinterop::crate_set_expr;
+
+    // Act
+    auto without_c = db.tracks_in_crates(
+        (crate_set_expr::of(a.id(), true) | crate_set_expr::of(b.id())) -
+        crate_set_expr::of(c.id()));
+    auto shallow = db.tracks_in_crates(crate_set_expr::of(a.id()));
+    auto both = db.tracks_in_crates(
+        crate_set_expr::of(a.id(), true) & crate_set_expr::of(c.id()));
+
+    // Assert
+    BOOST_CHECK(
+        ids_of(std::move(without_c)) ==
+        (std::vector<int64_t>{t1.id(), t3.id()}));
+    BOOST_CHECK(
+        ids_of(std::move(shallow)) == (std::vector<int64_t>{t1.id()}));
+    BOOST_CHECK(ids_of(std::move(both)) == (std::vector<int64_t>{t2.id()}));
+    remove_temp_dir(temp_dir);
+}
@@ -19,14 +19,32 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/autocomplete.hpp>
+#include <djinterop/content_hash.hpp>
 #include <djinterop/crate.hpp>
 #include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/file_scan.hpp>
+#include <djinterop/library_sync.hpp>
+#include <djinterop/library_watcher.hpp>
+#include <djinterop/musical_key.hpp>
 #include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
+#include <djinterop/similar_tracks.hpp>
 #include <djinterop/track.hpp>
+#include <djinterop/track_edit.hpp>
+#include <djinterop/transaction_guard.hpp>
 
 #include "temporary_directory.hpp"
 
@@ -160,3 +178,1698 @@ BOOST_DATA_TEST_CASE(
         BOOST_CHECK_EQUAL(db.version(), reference_script.expected_version);
     }
 }
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::begin_transaction() rolled back by an exception ends the "
+    "transaction"))
+BOOST_DATA_TEST_CASE(
+    begin_transaction__exception_thrown__rolled_back_and_ended,
+    el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto failing_operation = [&] {
+            auto guard = db.begin_transaction();
+            db.create_track("rolled_back.mp3");
+            throw std::runtime_error{"Failed"};
+        };
+
+        // Act
+        BOOST_CHECK_THROW(failing_operation(), std::runtime_error);
+        db.create_track("kept.mp3");
+
+        // Assert
+        // The connection must have returned to autocommit mode for the later
+        // change to be visible to another connection.
+        auto other = el::load_database(tmp_loc.temp_dir);
+        BOOST_CHECK_EQUAL(other.tracks_by_relative_path("kept.mp3").size(), 1);
+        BOOST_CHECK(other.tracks_by_relative_path("rolled_back.mp3").empty());
+        BOOST_CHECK(db.tracks_by_relative_path("rolled_back.mp3").empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::remove_tracks() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    remove_tracks__supported_version__removes, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        std::vector<djinterop::track> tracks{
+            db.create_track("a.mp3"), db.create_track("b.mp3"),
+            db.create_track("c.mp3")};
+        auto crate = db.create_root_crate("Example Root Crate");
+        crate.add_tracks(tracks.begin(), tracks.end());
+
+        // Act
+        db.remove_tracks(tracks.begin(), tracks.begin() + 2);
+
+        // Assert
+        auto remaining = db.tracks();
+        BOOST_REQUIRE_EQUAL(remaining.size(), 1);
+        BOOST_CHECK_EQUAL(remaining[0].id(), tracks[2].id());
+        BOOST_CHECK(!db.track_by_id(tracks[0].id()));
+        auto crate_tracks = crate.tracks();
+        BOOST_REQUIRE_EQUAL(crate_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(crate_tracks[0].id(), tracks[2].id());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::remove_crates() non-recursively for all supported schema "
+    "versions"))
+BOOST_DATA_TEST_CASE(
+    remove_crates__non_recursive__children_become_roots, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto a = db.create_root_crate("A");
+        auto b = a.create_sub_crate("B");
+        auto c = b.create_sub_crate("C");
+        auto d = c.create_sub_crate("D");
+        auto e = d.create_sub_crate("E");
+        std::vector<djinterop::crate> removed{b, d};
+
+        // Act
+        db.remove_crates(removed.begin(), removed.end(), false);
+
+        // Assert
+        BOOST_CHECK(!db.crate_by_id(b.id()));
+        BOOST_CHECK(!db.crate_by_id(d.id()));
+        BOOST_CHECK_EQUAL(db.crates().size(), 3);
+        BOOST_CHECK_EQUAL(db.root_crates().size(), 3);
+        BOOST_CHECK(!c.parent());
+        BOOST_CHECK(!e.parent());
+        BOOST_CHECK_EQUAL(a.children().size(), 0);
+        BOOST_CHECK_EQUAL(c.children().size(), 0);
+        BOOST_CHECK(db.root_crate_by_name("C"));
+        BOOST_CHECK(db.root_crate_by_name("E"));
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::remove_crate() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    remove_crate__crate_with_children__children_become_roots,
+    el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto a = db.create_root_crate("A");
+        auto b = a.create_sub_crate("B");
+        auto c = b.create_sub_crate("C");
+        auto track = db.create_track("a.mp3");
+        b.add_track(track);
+
+        // Act
+        db.remove_crate(b);
+
+        // Assert
+        BOOST_CHECK(!db.crate_by_id(b.id()));
+        BOOST_CHECK_EQUAL(db.crates().size(), 2);
+        BOOST_CHECK_EQUAL(a.children().size(), 0);
+        BOOST_CHECK(!c.parent());
+        BOOST_CHECK(db.root_crate_by_name("C"));
+        BOOST_CHECK_EQUAL(track.containing_crates().size(), 0);
+        BOOST_CHECK_NO_THROW(db.verify());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::remove_crates() recursively for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    remove_crates__recursive__removes_descendants, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto a = db.create_root_crate("A");
+        auto b = a.create_sub_crate("B");
+        auto c = b.create_sub_crate("C");
+        auto track = db.create_track("a.mp3");
+        c.add_track(track);
+        std::vector<djinterop::crate> removed{b};
+
+        // Act
+        db.remove_crates(removed.begin(), removed.end(), true);
+
+        // Assert
+        auto remaining = db.crates();
+        BOOST_REQUIRE_EQUAL(remaining.size(), 1);
+        BOOST_CHECK_EQUAL(remaining[0].id(), a.id());
+        BOOST_CHECK_EQUAL(a.children().size(), 0);
+        BOOST_CHECK_EQUAL(track.containing_crates().size(), 0);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description("database::remove_tracks() timing with 100k tracks"))
+BOOST_AUTO_TEST_CASE(remove_tracks__100k_tracks__removes)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        std::vector<int64_t> track_ids;
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                track_ids.push_back(
+                    db.create_track(std::to_string(i) + ".mp3").id());
+            }
+            guard.commit();
+        }
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        db.remove_tracks(track_ids);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Removed 100k tracks in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                   .count()
+            << "ms");
+        auto found = db.tracks_by_ids(track_ids);
+        BOOST_CHECK(std::none_of(
+            found.begin(), found.end(),
+            [](const auto& tr) { return !!tr; }));
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::search_tracks() ignores case and diacritics for all supported "
+    "schema versions"))
+BOOST_DATA_TEST_CASE(
+    search_tracks__folded_query__matches, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto precomposed = db.create_track("a.mp3");
+        precomposed.set_artist(std::string{"Beyonc\u00e9"});
+        auto decomposed = db.create_track("b.mp3");
+        decomposed.set_artist(std::string{"BEYONCE\u0301"});
+        auto other = db.create_track("c.mp3");
+        other.set_artist(std::string{"Bey"});
+
+        // Act
+        auto results = db.search_tracks("beyonce", 10);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(results.size(), 2);
+        BOOST_CHECK_EQUAL(results[0].id(), precomposed.id());
+        BOOST_CHECK_EQUAL(results[1].id(), decomposed.id());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::search_tracks() ranks better matches first"))
+BOOST_AUTO_TEST_CASE(search_tracks__several_matches__ranked)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto in_comment = db.create_track("a.mp3");
+        in_comment.set_comment(std::string{"Love"});
+        auto within_word = db.create_track("b.mp3");
+        within_word.set_title(std::string{"Glove Box"});
+        auto word_in_title = db.create_track("c.mp3");
+        word_in_title.set_title(std::string{"Crazy In Love"});
+        auto whole_title = db.create_track("d.mp3");
+        whole_title.set_title(std::string{"love"});
+        auto title_prefix = db.create_track("e.mp3");
+        title_prefix.set_title(std::string{"Lovely"});
+
+        // Act
+        auto results = db.search_tracks("Love", 10);
+        auto limited = db.search_tracks("love", 2);
+        auto phrase = db.search_tracks("in love", 10);
+        auto short_word = db.search_tracks("lo", 10);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(results.size(), 5);
+        BOOST_CHECK_EQUAL(results[0].id(), whole_title.id());
+        BOOST_CHECK_EQUAL(results[1].id(), title_prefix.id());
+        BOOST_CHECK_EQUAL(results[2].id(), word_in_title.id());
+        BOOST_CHECK_EQUAL(results[3].id(), in_comment.id());
+        BOOST_CHECK_EQUAL(results[4].id(), within_word.id());
+        BOOST_REQUIRE_EQUAL(limited.size(), 2);
+        BOOST_CHECK_EQUAL(limited[0].id(), whole_title.id());
+        BOOST_CHECK_EQUAL(limited[1].id(), title_prefix.id());
+        BOOST_REQUIRE_EQUAL(phrase.size(), 1);
+        BOOST_CHECK_EQUAL(phrase[0].id(), word_in_title.id());
+        BOOST_CHECK_EQUAL(short_word.size(), 4);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::search_tracks() reflects changes made after the first search"))
+BOOST_AUTO_TEST_CASE(search_tracks__metadata_changed__updated)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto renamed = db.create_track("a.mp3");
+        renamed.set_title(std::string{"Before"});
+        auto removed = db.create_track("b.mp3");
+        removed.set_title(std::string{"Doomed Before"});
+        BOOST_REQUIRE_EQUAL(db.search_tracks("before", 10).size(), 2);
+
+        // Act
+        renamed.set_title(std::string{"After"});
+        auto created = db.create_track("c.mp3");
+        created.edit().set_artist("Aftermath").commit();
+        db.remove_track(removed);
+
+        // Assert
+        BOOST_CHECK(db.search_tracks("before", 10).empty());
+        auto results = db.search_tracks("after", 10);
+        BOOST_REQUIRE_EQUAL(results.size(), 2);
+        BOOST_CHECK_EQUAL(results[0].id(), renamed.id());
+        BOOST_CHECK_EQUAL(results[1].id(), created.id());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description("database::search_tracks() timing with 100k tracks"))
+BOOST_AUTO_TEST_CASE(search_tracks__100k_tracks__searches)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        const std::vector<std::string> words{
+            "love",  "night", "dance",  "heart", "fire",   "dream",  "light",
+            "world", "time",  "summer", "girl",  "baby",   "soul",   "music",
+            "rain",  "star",  "city",   "gold",  "shadow", "river",  "storm",
+            "wild",  "blue",  "deep",   "sweet", "free",   "electric"};
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (size_t i = 0; i < 100000; ++i)
+            {
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_artist(
+                        "Artist " + words[i % 13] + " " +
+                        std::to_string(i % 500))
+                    .set_title(
+                        words[i % words.size()] + " " +
+                        words[(i / words.size()) % words.size()] + " " +
+                        std::to_string(i))
+                    .set_album("Album " + std::to_string(i % 5000))
+                    .set_genre(words[i % 7])
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        db.search_tracks("warm up", 1);
+        auto build_elapsed = std::chrono::steady_clock::now() - start;
+
+        // Act
+        const std::vector<std::string> queries{
+            "love", "night fire", "electric soul 42", "Artist blue", "st",
+            "dream river 9"};
+        start = std::chrono::steady_clock::now();
+        size_t total = 0;
+        for (auto&& query : queries)
+        {
+            total += db.search_tracks(query, 50).size();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Built search index of 100k tracks in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   build_elapsed)
+                   .count()
+            << "ms, and searched in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                       .count() /
+                   queries.size()
+            << "us per query");
+        BOOST_CHECK_GT(total, 0);
+        BOOST_CHECK_EQUAL(db.search_tracks("love", 50).size(), 50);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::autocomplete() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    autocomplete__prefix__values_by_usage, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        const std::vector<std::string> artists{
+            "Daft Punk", "D\u00e1vid", "Dave",      "D\u00e1vid",
+            "Daft Punk", "D\u00e1vid", "Dead Mau5", "Other"};
+        for (size_t i = 0; i < artists.size(); ++i)
+        {
+            auto tr = db.create_track(std::to_string(i) + ".mp3");
+            tr.set_artist(artists[i]);
+            tr.set_genre(std::string{"House"});
+        }
+
+        // Act
+        auto results =
+            db.autocomplete(djinterop::autocomplete_field::artist, "DA", 10);
+        auto limited =
+            db.autocomplete(djinterop::autocomplete_field::artist, "d", 2);
+        auto word = db.autocomplete(
+            djinterop::autocomplete_field::artist, "daft ", 10);
+        auto genres =
+            db.autocomplete(djinterop::autocomplete_field::genre, "", 10);
+        auto albums =
+            db.autocomplete(djinterop::autocomplete_field::album, "", 10);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(results.size(), 3);
+        BOOST_CHECK_EQUAL(results[0].text, "D\u00e1vid");
+        BOOST_CHECK_EQUAL(results[0].usage_count, 3);
+        BOOST_CHECK_EQUAL(results[1].text, "Daft Punk");
+        BOOST_CHECK_EQUAL(results[1].usage_count, 2);
+        BOOST_CHECK_EQUAL(results[2].text, "Dave");
+        BOOST_CHECK_EQUAL(results[2].usage_count, 1);
+        BOOST_REQUIRE_EQUAL(limited.size(), 2);
+        BOOST_CHECK_EQUAL(limited[1].text, "Daft Punk");
+        BOOST_REQUIRE_EQUAL(word.size(), 1);
+        BOOST_CHECK_EQUAL(word[0].text, "Daft Punk");
+        BOOST_REQUIRE_EQUAL(genres.size(), 1);
+        BOOST_CHECK_EQUAL(genres[0].usage_count, artists.size());
+        BOOST_CHECK(albums.empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::autocomplete() reflects changes made after the first call"))
+BOOST_AUTO_TEST_CASE(autocomplete__metadata_changed__updated)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto renamed = db.create_track("a.mp3");
+        renamed.set_publisher(std::string{"Warp"});
+        auto removed = db.create_track("b.mp3");
+        removed.set_publisher(std::string{"Warp"});
+        BOOST_REQUIRE_EQUAL(
+            db.autocomplete(djinterop::autocomplete_field::publisher, "w", 10)
+                .size(),
+            1);
+
+        // Act
+        renamed.set_publisher(std::string{"Wax Trax"});
+        auto created = db.create_track("c.mp3");
+        created.edit().set_publisher("Wax Trax").commit();
+        db.remove_track(removed);
+
+        // Assert
+        auto results =
+            db.autocomplete(djinterop::autocomplete_field::publisher, "w", 10);
+        BOOST_REQUIRE_EQUAL(results.size(), 1);
+        BOOST_CHECK_EQUAL(results[0].text, "Wax Trax");
+        BOOST_CHECK_EQUAL(results[0].usage_count, 2);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description("database::autocomplete() timing with 100k tracks"))
+BOOST_AUTO_TEST_CASE(autocomplete__100k_tracks__completes)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_artist("Artist " + std::to_string(i % 20000))
+                    .set_album("Album " + std::to_string(i % 10000))
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        db.autocomplete(djinterop::autocomplete_field::artist, "", 1);
+        auto build_elapsed = std::chrono::steady_clock::now() - start;
+
+        // Act
+        const std::string typed = "artist 1234";
+        start = std::chrono::steady_clock::now();
+        std::vector<djinterop::autocomplete_suggestion> results;
+        for (size_t length = 1; length <= typed.size(); ++length)
+        {
+            results = db.autocomplete(
+                djinterop::autocomplete_field::artist, typed.substr(0, length),
+                10);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Built autocomplete index of 100k tracks in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   build_elapsed)
+                   .count()
+            << "ms, and completed in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                       .count() /
+                   typed.size()
+            << "us per keystroke");
+        BOOST_REQUIRE_EQUAL(results.size(), 10);
+        BOOST_CHECK_EQUAL(results[0].text, "Artist 1234");
+        BOOST_CHECK_EQUAL(results[0].usage_count, 5);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::harmonic_candidates() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    harmonic_candidates__bpm_and_key__compatible_tracks, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        using djinterop::musical_key;
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto make_track = [&](djinterop::stdx::optional<double> bpm,
+                              djinterop::stdx::optional<musical_key> key) {
+            auto tr = db.create_track(std::to_string(db.tracks().size()));
+            tr.edit().set_bpm(bpm).set_key(key).commit();
+            return tr.id();
+        };
+        auto same = make_track(128, musical_key::a_minor);
+        auto adjacent = make_track(130, musical_key::e_minor);
+        auto relative_half_time = make_track(64.5, musical_key::c_major);
+        auto double_time = make_track(250, musical_key::d_minor);
+        make_track(128, musical_key::b_minor);
+        make_track(140, musical_key::a_minor);
+        make_track(128, djinterop::stdx::nullopt);
+        make_track(djinterop::stdx::nullopt, musical_key::a_minor);
+
+        // Act
+        auto results = db.harmonic_candidates(128, musical_key::a_minor);
+        auto narrow = db.harmonic_candidates(128, musical_key::a_minor, 0.01);
+
+        // Assert
+        std::vector<int64_t> ids;
+        for (auto&& tr : results)
+        {
+            ids.push_back(tr.id());
+        }
+        const std::vector<int64_t> expected{
+            same, relative_half_time, adjacent, double_time};
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            ids.begin(), ids.end(), expected.begin(), expected.end());
+        BOOST_REQUIRE_EQUAL(narrow.size(), 2);
+        BOOST_CHECK_EQUAL(narrow[0].id(), same);
+        BOOST_CHECK_EQUAL(narrow[1].id(), relative_half_time);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::harmonic_candidates() reflects changes made after the first "
+    "call"))
+BOOST_AUTO_TEST_CASE(harmonic_candidates__bpm_and_key_changed__updated)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        using djinterop::musical_key;
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto rekeyed = db.create_track("a.mp3");
+        rekeyed.set_bpm(120);
+        rekeyed.set_key(musical_key::g_major);
+        auto retimed = db.create_track("b.mp3");
+        retimed.set_bpm(150);
+        retimed.set_key(musical_key::g_major);
+        auto removed = db.create_track("c.mp3");
+        removed.set_bpm(121);
+        removed.set_key(musical_key::g_major);
+        BOOST_REQUIRE_EQUAL(
+            db.harmonic_candidates(120, musical_key::g_major).size(), 2);
+
+        // Act
+        rekeyed.set_key(musical_key::f_minor);
+        retimed.set_bpm(119);
+        auto created = db.create_track("d.mp3");
+        created.edit().set_bpm(240).set_key(musical_key::e_minor).commit();
+        db.remove_track(removed);
+
+        // Assert
+        auto results = db.harmonic_candidates(120, musical_key::g_major);
+        BOOST_REQUIRE_EQUAL(results.size(), 2);
+        BOOST_CHECK_EQUAL(results[0].id(), created.id());
+        BOOST_CHECK_EQUAL(results[1].id(), retimed.id());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::harmonic_candidates() rejects invalid arguments"))
+BOOST_AUTO_TEST_CASE(harmonic_candidates__invalid_arguments__throws)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        using djinterop::musical_key;
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+
+        // Act/Assert
+        BOOST_CHECK_THROW(
+            db.harmonic_candidates(0, musical_key::a_minor),
+            std::invalid_argument);
+        BOOST_CHECK_THROW(
+            db.harmonic_candidates(128, musical_key::a_minor, -0.01),
+            std::invalid_argument);
+        BOOST_CHECK_THROW(
+            db.harmonic_candidates(128, musical_key::a_minor, 0.5),
+            std::invalid_argument);
+        BOOST_CHECK(db.harmonic_candidates(128, musical_key::a_minor).empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description(
+          "database::harmonic_candidates() timing with 100k tracks"))
+BOOST_AUTO_TEST_CASE(harmonic_candidates__100k_tracks__finds)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        using djinterop::musical_key;
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_bpm(70 + (i * 7919 % 10000) / 100.0)
+                    .set_key(static_cast<musical_key>(1 + i % 24))
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        db.harmonic_candidates(100, musical_key::a_minor);
+        auto build_elapsed = std::chrono::steady_clock::now() - start;
+
+        // Act
+        start = std::chrono::steady_clock::now();
+        size_t total = 0;
+        for (int i = 0; i < 24; ++i)
+        {
+            total += db.harmonic_candidates(
+                           90 + i * 2.5, static_cast<musical_key>(1 + i))
+                         .size();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Built harmonic index of 100k tracks in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   build_elapsed)
+                   .count()
+            << "ms, and found " << total / 24 << " candidates in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                       .count() /
+                   24
+            << "us per query");
+        BOOST_CHECK_GT(total, 0);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::compute_content_hashes() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    compute_content_hashes__files__duplicates_grouped, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto write_file = [&](const std::string& relative_path,
+                              const std::string& content) {
+            std::ofstream out{
+                tmp_loc.temp_dir + "/" + relative_path, std::ios::binary};
+            out << content;
+        };
+        boost::filesystem::create_directory(tmp_loc.temp_dir_path / "music");
+        write_file("music/a.mp3", std::string(1000, 'a'));
+        write_file("music/b.mp3", std::string(1000, 'a'));
+        write_file("music/c.mp3", std::string(1000, 'c'));
+        write_file("music/d.mp3", std::string(999, 'a'));
+        write_file("e.mp3", std::string(1000, 'c'));
+        auto a = db.create_track("music/a.mp3");
+        auto b = db.create_track("music/b.mp3");
+        auto c = db.create_track("music/c.mp3");
+        db.create_track("music/d.mp3");
+        auto e = db.create_track("e.mp3");
+        auto missing = db.create_track("music/missing.mp3");
+        djinterop::content_hash_options options;
+        options.max_concurrent_reads = 3;
+        options.read_size = 7;
+
+        // Act
+        auto result = db.compute_content_hashes(options);
+        auto groups = db.duplicate_tracks_by_content();
+        auto repeated = db.compute_content_hashes(options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(result.hashed_count, 5);
+        BOOST_REQUIRE_EQUAL(result.unreadable_track_ids.size(), 1);
+        BOOST_CHECK_EQUAL(result.unreadable_track_ids[0], missing.id());
+        BOOST_CHECK_EQUAL(repeated.hashed_count, 0);
+        BOOST_CHECK_EQUAL(repeated.unreadable_track_ids.size(), 1);
+        std::vector<std::vector<int64_t>> group_ids;
+        for (auto&& group : groups)
+        {
+            auto& ids = group_ids.emplace_back();
+            for (auto&& tr : group)
+            {
+                ids.push_back(tr.id());
+            }
+        }
+        std::sort(group_ids.begin(), group_ids.end());
+        BOOST_REQUIRE_EQUAL(group_ids.size(), 2);
+        BOOST_CHECK((group_ids[0] == std::vector<int64_t>{a.id(), b.id()}));
+        BOOST_CHECK((group_ids[1] == std::vector<int64_t>{c.id(), e.id()}));
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::compute_content_hashes() rehashes changed files on request"))
+BOOST_AUTO_TEST_CASE(compute_content_hashes__rehash__duplicates_updated)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto write_file = [&](const std::string& relative_path,
+                              const std::string& content) {
+            std::ofstream out{
+                tmp_loc.temp_dir + "/" + relative_path, std::ios::binary};
+            out << content;
+        };
+        write_file("a.mp3", "content");
+        write_file("b.mp3", "content");
+        db.create_track("a.mp3");
+        db.create_track("b.mp3");
+        db.compute_content_hashes();
+        BOOST_REQUIRE_EQUAL(db.duplicate_tracks_by_content().size(), 1);
+        write_file("b.mp3", "changed content");
+        djinterop::content_hash_options options;
+        options.rehash = true;
+
+        // Act
+        auto result = db.compute_content_hashes(options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(result.hashed_count, 2);
+        BOOST_CHECK(db.duplicate_tracks_by_content().empty());
+        djinterop::content_hash_options invalid;
+        invalid.max_concurrent_reads = 0;
+        BOOST_CHECK_THROW(
+            db.compute_content_hashes(invalid), std::invalid_argument);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::similar_tracks() groups re-tagged copies of tracks"))
+BOOST_AUTO_TEST_CASE(similar_tracks__retagged_copies__grouped)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        int count = 0;
+        auto create = [&](const std::string& artist, const std::string& title,
+                          djinterop::stdx::optional<int64_t> secs) {
+            auto tr = db.create_track(std::to_string(count++) + ".mp3");
+            auto edit = tr.edit();
+            edit.set_artist(artist).set_title(title);
+            if (secs)
+            {
+                edit.set_sampling(
+                    djinterop::sampling_info{44100, *secs * 44100});
+            }
+            edit.commit();
+            return tr;
+        };
+        auto a = create("Daft Punk", "One More Time", 320);
+        auto b = create("daft punk", "One More Time (Original Mix)", 320);
+        auto c = create("Daft Punk feat. Romanthony", "One More Time", 321);
+        create("Daft Punk", "Aerodynamic", 320);
+        create("Daft Punk", "One More Time", 400);
+        create("Daft Punk", "One More Time", djinterop::stdx::nullopt);
+        auto g = create("Röyksopp", "Eple", 220);
+        auto h = create("Royksopp", "Eple", 222);
+
+        // Act
+        auto groups = db.similar_tracks();
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(groups.size(), 2);
+        BOOST_REQUIRE_EQUAL(groups[0].tracks.size(), 3);
+        BOOST_CHECK_EQUAL(groups[0].tracks[0].id(), a.id());
+        BOOST_CHECK_EQUAL(groups[0].tracks[1].id(), b.id());
+        BOOST_CHECK_EQUAL(groups[0].tracks[2].id(), c.id());
+        BOOST_REQUIRE_EQUAL(groups[0].pairs.size(), 3);
+        BOOST_CHECK_EQUAL(groups[0].pairs[0].first, 0);
+        BOOST_CHECK_EQUAL(groups[0].pairs[0].second, 1);
+        BOOST_CHECK_CLOSE(groups[0].pairs[0].score, 1, 1e-6);
+        BOOST_CHECK_EQUAL(groups[0].pairs[1].first, 0);
+        BOOST_CHECK_EQUAL(groups[0].pairs[1].second, 2);
+        BOOST_CHECK_EQUAL(groups[0].pairs[2].first, 1);
+        BOOST_CHECK_EQUAL(groups[0].pairs[2].second, 2);
+        BOOST_CHECK_LT(groups[0].pairs[1].score, 1);
+        BOOST_REQUIRE_EQUAL(groups[1].tracks.size(), 2);
+        BOOST_CHECK_EQUAL(groups[1].tracks[0].id(), g.id());
+        BOOST_CHECK_EQUAL(groups[1].tracks[1].id(), h.id());
+        BOOST_REQUIRE_EQUAL(groups[1].pairs.size(), 1);
+        BOOST_CHECK_CLOSE(groups[1].pairs[0].score, 0.8, 1e-6);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::similar_tracks() with invalid options throws"))
+BOOST_AUTO_TEST_CASE(similar_tracks__invalid_options__throws)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        djinterop::similar_tracks_options negative_tolerance;
+        negative_tolerance.duration_tolerance = std::chrono::milliseconds{-1};
+        djinterop::similar_tracks_options zero_score;
+        zero_score.min_score = 0;
+        djinterop::similar_tracks_options excessive_score;
+        excessive_score.min_score = 1.5;
+        djinterop::similar_tracks_options no_threads;
+        no_threads.max_threads = 0;
+
+        // Act/Assert
+        BOOST_CHECK_THROW(
+            db.similar_tracks(negative_tolerance), std::invalid_argument);
+        BOOST_CHECK_THROW(db.similar_tracks(zero_score), std::invalid_argument);
+        BOOST_CHECK_THROW(
+            db.similar_tracks(excessive_score), std::invalid_argument);
+        BOOST_CHECK_THROW(db.similar_tracks(no_threads), std::invalid_argument);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description("database::similar_tracks() with 100k tracks"))
+BOOST_AUTO_TEST_CASE(similar_tracks__100k_tracks__finds)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                // Every two consecutive tracks are copies of each other.
+                auto n = i / 2;
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_artist("Artist " + std::to_string(n % 3000))
+                    .set_title("Title " + std::to_string(n))
+                    .set_sampling(djinterop::sampling_info{
+                        44100, (180 + n % 200) * int64_t{44100}})
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        auto groups = db.similar_tracks();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Found " << groups.size() << " groups of similar tracks among 100k "
+                     << "tracks in "
+                     << std::chrono::duration_cast<std::chrono::milliseconds>(
+                            elapsed)
+                            .count()
+                     << "ms");
+        BOOST_REQUIRE_EQUAL(groups.size(), 50000);
+        for (auto&& group : groups)
+        {
+            BOOST_REQUIRE_EQUAL(group.tracks.size(), 2);
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::relocate_tracks() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    relocate_tracks__prefixes__paths_changed, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto a = db.create_track("music/a.mp3");
+        auto b = db.create_track("music/sub/b.flac");
+        auto c = db.create_track("musicx/c.mp3");
+        auto d = db.create_track("other/d.mp3");
+
+        // Act
+        auto directory_count = db.relocate_tracks("music/", "library/");
+        auto filename_count = db.relocate_tracks("library/a", "library/z");
+        auto extension_count =
+            db.relocate_tracks("library/z.mp3", "library/z.wav");
+        auto unmatched_count = db.relocate_tracks("missing/", "library/");
+
+        // Assert
+        BOOST_CHECK_EQUAL(directory_count, 2);
+        BOOST_CHECK_EQUAL(filename_count, 1);
+        BOOST_CHECK_EQUAL(extension_count, 1);
+        BOOST_CHECK_EQUAL(unmatched_count, 0);
+        BOOST_CHECK_EQUAL(a.relative_path(), "library/z.wav");
+        BOOST_CHECK_EQUAL(a.filename(), "z.wav");
+        BOOST_CHECK_EQUAL(a.file_extension(), "wav");
+        BOOST_CHECK_EQUAL(b.relative_path(), "library/sub/b.flac");
+        BOOST_CHECK_EQUAL(b.filename(), "b.flac");
+        BOOST_CHECK_EQUAL(c.relative_path(), "musicx/c.mp3");
+        BOOST_CHECK_EQUAL(d.relative_path(), "other/d.mp3");
+        BOOST_CHECK_EQUAL(
+            db.tracks_by_relative_path("library/sub/b.flac").size(), 1);
+        BOOST_CHECK(db.tracks_by_relative_path("music/sub/b.flac").empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::relocate_tracks() onto existing paths changes nothing, for all "
+    "supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    relocate_tracks__existing_path__throws_and_unchanged, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto a = db.create_track("music/a.mp3");
+        auto b = db.create_track("music/b.mp3");
+        db.create_track("library/b.mp3");
+
+        // Act/Assert
+        BOOST_CHECK_THROW(
+            db.relocate_tracks("music/", "library/"), std::runtime_error);
+        BOOST_CHECK_EQUAL(a.relative_path(), "music/a.mp3");
+        BOOST_CHECK_EQUAL(b.relative_path(), "music/b.mp3");
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description("database::relocate_tracks() with 100k tracks"))
+BOOST_AUTO_TEST_CASE(relocate_tracks__100k_tracks__relocates)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                db.create_track(
+                    (i % 2 == 0 ? "../Music/" : "../Other/") +
+                    std::to_string(i % 100) + "/" + std::to_string(i) +
+                    ".mp3");
+            }
+            guard.commit();
+        }
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        auto count = db.relocate_tracks("../Music/", "/media/usb/Music/");
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Relocated " << count << " of 100k tracks in "
+                         << std::chrono::duration_cast<
+                                std::chrono::milliseconds>(elapsed)
+                                .count()
+                         << "ms");
+        BOOST_CHECK_EQUAL(count, 50000);
+        BOOST_CHECK_EQUAL(
+            db.tracks_by_relative_path("/media/usb/Music/2/2.mp3").size(), 1);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::scan_files() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    scan_files__missing_files__reported, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        boost::filesystem::create_directory(tmp_loc.temp_dir_path / "music");
+        std::ofstream{tmp_loc.temp_dir + "/music/a.mp3"} << "a";
+        std::ofstream{tmp_loc.temp_dir + "/music/b.mp3"} << "b";
+        db.create_track("music/a.mp3");
+        auto gone = db.create_track("music/gone.mp3");
+        db.create_track("music/b.mp3");
+        auto no_dir = db.create_track("nodir/c.mp3");
+        std::vector<djinterop::file_scan_entry> entries;
+        std::vector<std::pair<int64_t, int64_t>> progress;
+        djinterop::file_scan_options options;
+        options.parallelism = 3;
+        options.batch_size = 2;
+        options.on_entry = [&](const djinterop::file_scan_entry& entry) {
+            entries.push_back(entry);
+        };
+        options.on_progress = [&](int64_t scanned, int64_t total) {
+            progress.emplace_back(scanned, total);
+        };
+
+        // Act
+        auto summary = db.scan_files(options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(summary.scanned_count, 4);
+        BOOST_CHECK_EQUAL(summary.missing_count, 2);
+        BOOST_CHECK_EQUAL(summary.inaccessible_count, 0);
+        BOOST_CHECK_EQUAL(summary.size_changed_count, 0);
+        BOOST_REQUIRE_EQUAL(entries.size(), 2);
+        BOOST_CHECK_EQUAL(entries[0].track_id, gone.id());
+        BOOST_CHECK_EQUAL(entries[0].relative_path, "music/gone.mp3");
+        BOOST_CHECK(entries[0].status == djinterop::file_scan_status::missing);
+        BOOST_CHECK(!entries[0].actual_size);
+        BOOST_CHECK_EQUAL(entries[1].track_id, no_dir.id());
+        BOOST_CHECK(entries[1].status == djinterop::file_scan_status::missing);
+        BOOST_CHECK((
+            progress ==
+            std::vector<std::pair<int64_t, int64_t>>{{2, 4}, {4, 4}}));
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::scan_files() with recorded file sizes, for all supported "
+    "schema versions"))
+BOOST_DATA_TEST_CASE(
+    scan_files__recorded_size_differs__reported_from_1_15_0, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        std::ofstream{tmp_loc.temp_dir + "/changed.mp3"} << "abc";
+        std::ofstream{tmp_loc.temp_dir + "/same.mp3"} << "abc";
+        std::ofstream{tmp_loc.temp_dir + "/unknown.mp3"} << "abc";
+        auto changed = db.create_track("changed.mp3");
+        auto same = db.create_track("same.mp3");
+        auto unknown = db.create_track("unknown.mp3");
+        if (version >= el::version_1_15_0)
+        {
+            // There is no track setter for the recorded size, and so it is
+            // written to the database directly.
+            sqlite::database music_db{el::music_db_path(db)};
+            music_db << "UPDATE Track SET fileBytes = ? WHERE id = ?" << 100
+                     << changed.id();
+            music_db << "UPDATE Track SET fileBytes = ? WHERE id = ?" << 3
+                     << same.id();
+            music_db << "UPDATE Track SET fileBytes = ? WHERE id = ?" << 0
+                     << unknown.id();
+        }
+
+        std::vector<djinterop::file_scan_entry> entries;
+        djinterop::file_scan_options options;
+        options.on_entry = [&](const djinterop::file_scan_entry& entry) {
+            entries.push_back(entry);
+        };
+
+        // Act
+        auto summary = db.scan_files(options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(summary.scanned_count, 3);
+        BOOST_CHECK_EQUAL(summary.missing_count, 0);
+        if (version >= el::version_1_15_0)
+        {
+            BOOST_CHECK_EQUAL(summary.size_changed_count, 1);
+            BOOST_REQUIRE_EQUAL(entries.size(), 1);
+            BOOST_CHECK_EQUAL(entries[0].track_id, changed.id());
+            BOOST_CHECK(
+                entries[0].status == djinterop::file_scan_status::size_changed);
+            BOOST_CHECK(entries[0].recorded_size == int64_t{100});
+            BOOST_CHECK(entries[0].actual_size == int64_t{3});
+        }
+        else
+        {
+            // File sizes are not recorded, and so cannot have changed.
+            BOOST_CHECK_EQUAL(summary.size_changed_count, 0);
+            BOOST_CHECK(entries.empty());
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::scan_files() with invalid options throws"))
+BOOST_AUTO_TEST_CASE(scan_files__invalid_options__throws)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        djinterop::file_scan_options no_parallelism;
+        no_parallelism.parallelism = 0;
+        djinterop::file_scan_options no_batch;
+        no_batch.batch_size = 0;
+
+        // Act/Assert
+        BOOST_CHECK_THROW(db.scan_files(no_parallelism), std::invalid_argument);
+        BOOST_CHECK_THROW(db.scan_files(no_batch), std::invalid_argument);
+    }
+}
+
+#if defined(__linux__)
+BOOST_TEST_DECORATOR(* utf::description(
+    "library_watcher::poll() with changed files updates tracks"))
+BOOST_AUTO_TEST_CASE(watch_library__changed_files__tracks_updated)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto music = tmp_loc.temp_dir_path / "music";
+        boost::filesystem::create_directories(music / "sub");
+        std::ofstream{(music / "a.mp3").string()} << "a";
+        std::ofstream{(music / "b.mp3").string()} << "b";
+        std::ofstream{(music / "sub/c.mp3").string()} << "c";
+        auto a = db.create_track("music/a.mp3");
+        auto b = db.create_track("music/b.mp3");
+        auto c = db.create_track("music/sub/c.mp3");
+        djinterop::library_watcher_options options;
+        options.settle_time = std::chrono::milliseconds{50};
+        auto watcher = db.watch_library(options);
+        BOOST_CHECK_EQUAL(watcher.watched_directory_count(), 2);
+
+        // Act
+        boost::filesystem::rename(music / "a.mp3", music / "a2.mp3");
+        boost::filesystem::remove(music / "b.mp3");
+        boost::filesystem::rename(music / "sub", music / "sub2");
+        boost::filesystem::create_directory(music / "new");
+        std::ofstream{(music / "new/d.FLAC").string()} << "d";
+        std::ofstream{(music / "new/notes.txt").string()} << "e";
+        auto update = watcher.poll(std::chrono::milliseconds{1000});
+        auto idle_update = watcher.poll(std::chrono::milliseconds{0});
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(update.created_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(
+            update.created_tracks[0].relative_path(), "music/new/d.FLAC");
+        BOOST_CHECK_EQUAL(update.relocated_tracks.size(), 2);
+        BOOST_CHECK_EQUAL(a.relative_path(), "music/a2.mp3");
+        BOOST_CHECK_EQUAL(c.relative_path(), "music/sub2/c.mp3");
+        BOOST_REQUIRE_EQUAL(update.deleted_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(update.deleted_tracks[0].id(), b.id());
+        BOOST_CHECK(b.is_valid());
+        BOOST_CHECK_EQUAL(watcher.watched_directory_count(), 3);
+        BOOST_CHECK(idle_update.created_tracks.empty());
+        BOOST_CHECK(idle_update.relocated_tracks.empty());
+        BOOST_CHECK(idle_update.deleted_tracks.empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "library_watcher::poll() with a directory renamed onto tracked paths "
+    "reports it and applies the rest of the batch"))
+BOOST_AUTO_TEST_CASE(watch_library__renamed_onto_tracked_path__reported)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto music = tmp_loc.temp_dir_path / "music";
+        boost::filesystem::create_directories(music / "sub");
+        std::ofstream{(music / "b.mp3").string()} << "b";
+        std::ofstream{(music / "sub/c.mp3").string()} << "c";
+        db.create_track("music/b.mp3");
+        auto c = db.create_track("music/sub/c.mp3");
+        auto stale = db.create_track("music/sub2/c.mp3");
+        djinterop::library_watcher_options options;
+        options.settle_time = std::chrono::milliseconds{50};
+        auto watcher = db.watch_library(options);
+
+        // Act
+        boost::filesystem::rename(music / "sub", music / "sub2");
+        std::ofstream{(music / "d.mp3").string()} << "d";
+        auto update = watcher.poll(std::chrono::milliseconds{1000});
+        std::ofstream{(music / "e.mp3").string()} << "e";
+        auto next_update = watcher.poll(std::chrono::milliseconds{1000});
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(update.failed_directory_renames.size(), 1);
+        BOOST_CHECK_EQUAL(
+            update.failed_directory_renames[0].first, "music/sub");
+        BOOST_CHECK_EQUAL(
+            update.failed_directory_renames[0].second, "music/sub2");
+        BOOST_CHECK(update.relocated_tracks.empty());
+        BOOST_CHECK_EQUAL(c.relative_path(), "music/sub/c.mp3");
+        BOOST_CHECK_EQUAL(stale.relative_path(), "music/sub2/c.mp3");
+        BOOST_REQUIRE_EQUAL(update.created_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(
+            update.created_tracks[0].relative_path(), "music/d.mp3");
+        BOOST_CHECK(next_update.failed_directory_renames.empty());
+        BOOST_REQUIRE_EQUAL(next_update.created_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(
+            next_update.created_tracks[0].relative_path(), "music/e.mp3");
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "library_watcher::poll() with a copied folder creates tracks at once"))
+BOOST_AUTO_TEST_CASE(watch_library__copied_folder__tracks_created)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto music = tmp_loc.temp_dir_path / "music";
+        auto staging = tmp_loc.temp_dir_path / "staging";
+        boost::filesystem::create_directory(music);
+        boost::filesystem::create_directories(staging / "album");
+        std::ofstream{(music / "a.mp3").string()} << "a";
+        db.create_track("music/a.mp3");
+        djinterop::library_watcher_options options;
+        options.settle_time = std::chrono::milliseconds{100};
+        auto watcher = db.watch_library(options);
+        constexpr int file_count = 1000;
+        for (int i = 0; i < file_count; ++i)
+        {
+            auto name = "track" + std::to_string(i) + ".mp3";
+            std::ofstream{(staging / "album" / name).string()} << i;
+        }
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        boost::filesystem::rename(staging / "album", music / "album");
+        for (int i = 0; i < file_count; ++i)
+        {
+            auto name = "copy" + std::to_string(i) + ".mp3";
+            std::ofstream{(music / name).string()} << i;
+        }
+
+        auto update = watcher.poll(std::chrono::milliseconds{1000});
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_CHECK_EQUAL(update.created_tracks.size(), 2 * file_count);
+        BOOST_CHECK_EQUAL(db.tracks().size(), 2 * file_count + 1);
+        BOOST_TEST_MESSAGE(
+            "Applied " << 2 * file_count << " new files in "
+                       << std::chrono::duration_cast<std::chrono::milliseconds>(
+                              elapsed)
+                              .count()
+                       << "ms");
+    }
+}
+#else
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::watch_library() on an unsupported platform throws"))
+BOOST_AUTO_TEST_CASE(watch_library__unsupported_platform__throws)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+
+        // Act/Assert
+        BOOST_CHECK_THROW(db.watch_library(), std::runtime_error);
+    }
+}
+#endif
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::copy_tracks() with sample tracks copies all of their data"))
+BOOST_DATA_TEST_CASE(
+    copy_tracks__sample_tracks__copied, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto source =
+            el::load_database(std::string{STRINGIFY(TESTDATA_DIR) "/el1"});
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto tracks = source.tracks();
+        std::reverse(tracks.begin(), tracks.end());
+
+        // Act
+        auto copies = db.copy_tracks(source, tracks);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(copies.size(), tracks.size());
+        BOOST_CHECK_EQUAL(db.tracks().size(), tracks.size());
+        for (size_t i = 0; i < tracks.size(); ++i)
+        {
+            auto& t = tracks[i];
+            auto& copy = copies[i];
+            BOOST_CHECK_EQUAL(copy.relative_path(), t.relative_path());
+            BOOST_CHECK_EQUAL(copy.filename(), t.filename());
+            BOOST_CHECK(copy.title() == t.title());
+            BOOST_CHECK(copy.artist() == t.artist());
+            BOOST_CHECK(copy.bpm() == t.bpm());
+            BOOST_CHECK(copy.key() == t.key());
+            BOOST_CHECK(copy.sampling() == t.sampling());
+            BOOST_CHECK(copy.adjusted_beatgrid() == t.adjusted_beatgrid());
+            BOOST_CHECK(copy.hot_cues() == t.hot_cues());
+            BOOST_CHECK(copy.loops() == t.loops());
+            BOOST_CHECK(copy.waveform() == t.waveform());
+            BOOST_CHECK_EQUAL(
+                copy.album_art_id().has_value(), t.album_art_id().has_value());
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::copy_tracks() with an existing path throws and copies nothing, "
+    "for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    copy_tracks__existing_path__throws_and_unchanged, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory source_loc;
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto source = el::create_database(source_loc.temp_dir, version);
+        auto a = source.create_track("a.mp3");
+        auto b = source.create_track("b.mp3");
+        auto gone = source.create_track("gone.mp3");
+        source.remove_track(gone);
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        db.create_track("b.mp3");
+
+        // Act/Assert
+        BOOST_CHECK_THROW(
+            db.copy_tracks(source, {a, b}), std::runtime_error);
+        BOOST_CHECK_EQUAL(db.tracks().size(), 1);
+        BOOST_CHECK_THROW(
+            db.copy_tracks(source, {a, gone}), djinterop::track_deleted);
+        BOOST_CHECK_EQUAL(db.tracks().size(), 1);
+        BOOST_CHECK_EQUAL(db.copy_tracks(source, {a, a}).size(), 2);
+        BOOST_CHECK_EQUAL(db.tracks().size(), 2);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description(
+          "database::copy_tracks() with 10k analysed tracks copies them "
+          "quickly"))
+BOOST_AUTO_TEST_CASE(copy_tracks__10k_tracks__copies)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory source_loc;
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto source =
+            el::create_database(source_loc.temp_dir, el::version_latest);
+        constexpr int track_count = 10000;
+        std::vector<djinterop::waveform_entry> waveform(
+            1024, djinterop::waveform_entry{{1, 2}, {3, 4}, {5, 6}});
+        {
+            auto trans = source.begin_transaction();
+            for (int i = 0; i < track_count; ++i)
+            {
+                auto t =
+                    source.create_track("music/" + std::to_string(i) + ".mp3");
+                t.set_title("Title " + std::to_string(i));
+                t.set_sampling(djinterop::sampling_info{44100, 44100 * 300});
+                t.set_default_beatgrid(
+                    {{0, 0}, {512, 44100 * 256}});
+                t.set_adjusted_beatgrid(
+                    {{0, 0}, {512, 44100 * 256}});
+                t.set_hot_cue_at(
+                    0, djinterop::hot_cue{
+                           "Drop", 44100.0 * i / track_count,
+                           el::standard_pad_colors::pad_1});
+                t.set_waveform(waveform);
+            }
+
+            trans.commit();
+        }
+
+        auto tracks = source.tracks();
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        auto copies = db.copy_tracks(source, tracks);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(copies.size(), track_count);
+        BOOST_CHECK(copies.back().hot_cues() == tracks.back().hot_cues());
+        BOOST_CHECK(copies.back().waveform() == waveform);
+        BOOST_TEST_MESSAGE(
+            "Copied " << track_count << " tracks in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(
+                             elapsed)
+                             .count()
+                      << "ms");
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::sync_library() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    sync_library__changed_tracks__synchronised, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory first_loc;
+    temporary_directory second_loc;
+
+    {
+        // Arrange
+        auto first = el::create_database(first_loc.temp_dir, version);
+        auto second = el::create_database(second_loc.temp_dir, version);
+        auto modified_at = std::chrono::system_clock::time_point{
+            std::chrono::seconds{1600000000}};
+        auto first_a = first.create_track("music/a.mp3");
+        auto first_b = first.create_track("music/b.mp3");
+        auto first_c = first.create_track("music/c.mp3");
+        for (auto&& t : {first_a, first_b, first_c})
+        {
+            t.set_title(std::string{"Title"});
+            t.set_last_modified_at(modified_at);
+        }
+        auto copies = second.copy_tracks(first, {first_a, first_b});
+        auto& second_a = copies[0];
+        auto& second_b = copies[1];
+        auto second_d = second.create_track("music/d.mp3");
+        djinterop::hot_cue cue{
+            "Drop", 44100, el::standard_pad_colors::pad_1};
+        first_a.set_hot_cue_at(0, cue);
+        first_a.set_last_modified_at(modified_at + std::chrono::seconds{1});
+        second_b.set_title(std::string{"New title"});
+        second_b.set_last_modified_at(modified_at + std::chrono::seconds{2});
+        djinterop::library_sync_options options;
+        options.dry_run = true;
+
+        // Act
+        auto planned = first.sync_library(second, options);
+        auto report = first.sync_library(second);
+        auto repeated = first.sync_library(second, options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(planned.matched_count, 2);
+        BOOST_CHECK_EQUAL(planned.unchanged_count, 0);
+        BOOST_REQUIRE_EQUAL(planned.changes.size(), 4);
+        BOOST_CHECK(
+            planned.changes[0].action ==
+            djinterop::library_sync_action::update_second);
+        BOOST_CHECK(planned.changes[0].performance_data_differs);
+        BOOST_CHECK(!planned.changes[0].track_differs);
+        BOOST_CHECK(
+            planned.changes[1].action ==
+            djinterop::library_sync_action::update_first);
+        BOOST_CHECK(planned.changes[1].metadata_differs);
+        BOOST_CHECK(!planned.changes[1].performance_data_differs);
+        BOOST_CHECK(
+            planned.changes[2].action ==
+            djinterop::library_sync_action::copy_to_second);
+        BOOST_CHECK(planned.changes[2].first_track_id == first_c.id());
+        BOOST_CHECK(!planned.changes[2].second_track_id);
+        BOOST_CHECK(
+            planned.changes[3].action ==
+            djinterop::library_sync_action::copy_to_first);
+        BOOST_CHECK_EQUAL(planned.changes[3].relative_path, "music/d.mp3");
+
+        BOOST_REQUIRE_EQUAL(report.changes.size(), 4);
+        BOOST_REQUIRE(report.changes[2].second_track_id);
+        BOOST_REQUIRE(report.changes[3].first_track_id);
+        BOOST_CHECK(second_a.hot_cue_at(0) == cue);
+        BOOST_CHECK(first_b.title() == std::string{"New title"});
+        BOOST_CHECK(
+            first_b.last_modified_at() == second_b.last_modified_at());
+        auto second_c = second.track_by_id(*report.changes[2].second_track_id);
+        BOOST_REQUIRE(second_c);
+        BOOST_CHECK_EQUAL(second_c->relative_path(), "music/c.mp3");
+        BOOST_CHECK(second_d.relative_path() ==
+                    first.track_by_id(*report.changes[3].first_track_id)
+                        ->relative_path());
+
+        BOOST_CHECK_EQUAL(repeated.matched_count, 4);
+        BOOST_CHECK_EQUAL(repeated.unchanged_count, 4);
+        BOOST_CHECK(repeated.changes.empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::sync_library() matches moved tracks by content hash, and "
+    "applies the conflict policy"))
+BOOST_AUTO_TEST_CASE(sync_library__moved_track__matched_by_content_hash)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory first_loc;
+    temporary_directory second_loc;
+
+    {
+        // Arrange
+        auto first =
+            el::create_database(first_loc.temp_dir, el::version_latest);
+        auto second =
+            el::create_database(second_loc.temp_dir, el::version_latest);
+        {
+            std::ofstream out{first_loc.temp_dir + "/a.mp3", std::ios::binary};
+            out << std::string(1000, 'a');
+        }
+        auto first_a = first.create_track("a.mp3");
+        first_a.set_title(std::string{"Title"});
+        first.compute_content_hashes(djinterop::content_hash_options{});
+        auto second_a = second.copy_tracks(first, {first_a})[0];
+        second_a.set_relative_path("usb/a.mp3");
+        first_a.set_title(std::string{"First title"});
+        second_a.set_title(std::string{"Second title"});
+        djinterop::library_sync_options options;
+        options.dry_run = true;
+
+        // Act
+        auto newer = first.sync_library(second, options);
+        options.conflict_policy =
+            djinterop::library_sync_conflict_policy::skip;
+        auto skipped = first.sync_library(second, options);
+        options.conflict_policy =
+            djinterop::library_sync_conflict_policy::prefer_second;
+        options.dry_run = false;
+        auto preferred = first.sync_library(second, options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(newer.matched_count, 1);
+        BOOST_REQUIRE_EQUAL(newer.changes.size(), 1);
+        BOOST_CHECK(
+            newer.changes[0].action ==
+            djinterop::library_sync_action::conflict_skipped);
+        BOOST_REQUIRE_EQUAL(skipped.changes.size(), 1);
+        BOOST_CHECK(
+            skipped.changes[0].action ==
+            djinterop::library_sync_action::conflict_skipped);
+        BOOST_REQUIRE_EQUAL(preferred.changes.size(), 1);
+        BOOST_CHECK(
+            preferred.changes[0].action ==
+            djinterop::library_sync_action::update_first);
+        BOOST_CHECK_EQUAL(preferred.changes[0].relative_path, "usb/a.mp3");
+        BOOST_CHECK(first_a.title() == std::string{"Second title"});
+        BOOST_CHECK_EQUAL(first_a.relative_path(), "a.mp3");
+        BOOST_CHECK_EQUAL(first.tracks().size(), 1);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description(
+          "database::sync_library() with 100k tracks applies only the changes"))
+BOOST_AUTO_TEST_CASE(sync_library__100k_tracks__synchronised)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory first_loc;
+    temporary_directory second_loc;
+
+    {
+        // Arrange
+        auto first =
+            el::create_database(first_loc.temp_dir, el::version_latest);
+        constexpr int track_count = 100000;
+        std::vector<djinterop::waveform_entry> waveform(
+            256, djinterop::waveform_entry{{1, 2}, {3, 4}, {5, 6}});
+        auto modified_at = std::chrono::system_clock::time_point{
+            std::chrono::seconds{1600000000}};
+        {
+            auto trans = first.begin_transaction();
+            for (int i = 0; i < track_count; ++i)
+            {
+                auto t = first.create_track(
+                    "music/" + std::to_string(i % 100) + "/" +
+                    std::to_string(i) + ".mp3");
+                t.set_title("Title " + std::to_string(i));
+                t.set_last_modified_at(modified_at);
+                t.set_sampling(djinterop::sampling_info{44100, 44100 * 300});
+                t.set_waveform(waveform);
+            }
+
+            trans.commit();
+        }
+
+        auto tracks = first.tracks();
+        auto second =
+            el::create_database(second_loc.temp_dir, el::version_latest);
+        auto copies = second.copy_tracks(first, tracks);
+        {
+            auto trans = second.begin_transaction();
+            for (int i = 0; i < track_count; i += 1000)
+            {
+                copies[i].set_hot_cue_at(
+                    0, djinterop::hot_cue{
+                           "Drop", 44100, el::standard_pad_colors::pad_1});
+                copies[i].set_last_modified_at(
+                    modified_at + std::chrono::seconds{1});
+            }
+
+            trans.commit();
+        }
+
+        djinterop::library_sync_options options;
+        options.dry_run = true;
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        auto planned = first.sync_library(second, options);
+        auto planned_at = std::chrono::steady_clock::now();
+        auto report = first.sync_library(second);
+        auto elapsed = std::chrono::steady_clock::now() - planned_at;
+
+        // Assert
+        BOOST_CHECK_EQUAL(planned.matched_count, track_count);
+        BOOST_CHECK_EQUAL(planned.changes.size(), track_count / 1000);
+        BOOST_CHECK_EQUAL(report.changes.size(), track_count / 1000);
+        BOOST_CHECK(tracks[1000].hot_cue_at(0) == copies[1000].hot_cue_at(0));
+        BOOST_CHECK(!tracks[1001].hot_cue_at(0));
+        BOOST_TEST_MESSAGE(
+            "Planned sync of " << track_count << " tracks in "
+                               << std::chrono::duration_cast<
+                                      std::chrono::milliseconds>(
+                                      planned_at - start)
+                                      .count()
+                               << "ms, and synchronised in "
+                               << std::chrono::duration_cast<
+                                      std::chrono::milliseconds>(elapsed)
+                                      .count()
+                               << "ms");
+    }
+}
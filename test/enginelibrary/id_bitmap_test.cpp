@@ -0,0 +1,156 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE id_bitmap_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include <djinterop/id_bitmap.hpp>
+
+namespace utf = boost::unit_test;
+
+namespace
+{
+struct density
+{
+    int64_t range;
+    size_t count;
+};
+
+std::ostream& operator<<(std::ostream& os, const density& d)
+{
+    os << d.count << " of " << d.range;
+    return os;
+}
+
+// Mixtures of sparse (array) and dense (bitmap) chunks.
+const std::vector<density> densities{
+    density{100, 50},
+    density{65536, 100},
+    density{65536, 10000},
+    density{300000, 20000},
+    density{300000, 150000},
+};
+
+std::vector<int64_t> random_ids(const density& d, unsigned seed)
+{
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<int64_t> dist{1, d.range};
+    std::vector<int64_t> ids;
+    for (size_t i = 0; i < d.count; ++i)
+        ids.push_back(dist(gen));
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+}  // namespace
+
+BOOST_TEST_DECORATOR(* utf::description("add(), contains(), and remove()"))
+BOOST_AUTO_TEST_CASE(add_remove__ids__expected_contents)
+{
+    // Arrange
+    djinterop::id_bitmap bitmap;
+
+    // Act
+    bitmap.add(3);
+    bitmap.add(1);
+    bitmap.add(70000);
+    bitmap.add(3);
+    bitmap.remove(1);
+    bitmap.remove(12345);
+
+    // Assert
+    BOOST_CHECK_EQUAL(bitmap.size(), 2);
+    BOOST_CHECK(bitmap.contains(3));
+    BOOST_CHECK(!bitmap.contains(1));
+    BOOST_CHECK(bitmap.contains(70000));
+    BOOST_CHECK(
+        bitmap.to_vector() == (std::vector<int64_t>{3, 70000}));
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("add() and remove() across the dense threshold"))
+BOOST_AUTO_TEST_CASE(add_remove__dense_chunk__expected_contents)
+{
+    // Arrange
+    djinterop::id_bitmap bitmap;
+    std::vector<int64_t> expected;
+
+    // Act
+    for (int64_t id = 0; id < 10000; id += 2)
+    {
+        bitmap.add(id);
+        expected.push_back(id);
+    }
+    for (int64_t id = 0; id < 2000; id += 2)
+    {
+        bitmap.remove(id);
+    }
+    expected.erase(expected.begin(), expected.begin() + 1000);
+
+    // Assert
+    BOOST_CHECK_EQUAL(bitmap.size(), expected.size());
+    BOOST_CHECK(bitmap.to_vector() == expected);
+    BOOST_CHECK(bitmap == djinterop::id_bitmap{expected});
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("Set operations agree with sorted vector algorithms"))
+BOOST_DATA_TEST_CASE(set_operations__random_ids__match_reference, densities, d)
+{
+    // Arrange
+    auto a_ids = random_ids(d, 1);
+    auto b_ids = random_ids(d, 2);
+    djinterop::id_bitmap a{a_ids.begin(), a_ids.end()};
+    djinterop::id_bitmap b{b_ids.begin(), b_ids.end()};
+    std::vector<int64_t> expected_union;
+    std::vector<int64_t> expected_intersection;
+    std::vector<int64_t> expected_difference;
+    std::set_union(
+        a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(),
+        std::back_inserter(expected_union));
+    std::set_intersection(
+        a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(),
+        std::back_inserter(expected_intersection));
+    std::set_difference(
+        a_ids.begin(), a_ids.end(), b_ids.begin(), b_ids.end(),
+        std::back_inserter(expected_difference));
+
+    // Act
+    auto actual_union = a | b;
+    auto actual_intersection = a & b;
+    auto actual_difference = a - b;
+
+    // Assert
+    BOOST_CHECK_EQUAL(a.size(), a_ids.size());
+    BOOST_CHECK(a.to_vector() == a_ids);
+    BOOST_CHECK(actual_union.to_vector() == expected_union);
+    BOOST_CHECK(actual_intersection.to_vector() == expected_intersection);
+    BOOST_CHECK(actual_difference.to_vector() == expected_difference);
+    BOOST_CHECK(actual_union == djinterop::id_bitmap{expected_union});
+    BOOST_CHECK(
+        actual_intersection == djinterop::id_bitmap{expected_intersection});
+    BOOST_CHECK(actual_difference == djinterop::id_bitmap{expected_difference});
+}
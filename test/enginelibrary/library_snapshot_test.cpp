@@ -0,0 +1,370 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE library_snapshot_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/library_snapshot.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_edit.hpp>
+#include <djinterop/transaction_guard.hpp>
+
+#include "temporary_directory.hpp"
+
+namespace utf = boost::unit_test;
+namespace bdata = boost::unit_test::data;
+namespace el = djinterop::enginelibrary;
+
+using djinterop::library_column;
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::load_library_snapshot() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    load_library_snapshot__tracks__expected_columns,
+    bdata::make(el::all_versions), version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto t1 = db.create_track("a.mp3");
+        t1.edit()
+            .set_artist(std::string{"Artist B"})
+            .set_title(std::string{"Zebra"})
+            .set_genre(std::string{"House"})
+            .set_bpm(124)
+            .set_key(djinterop::musical_key::a_minor)
+            .set_year(2001)
+            .set_sampling(djinterop::sampling_info{44100, 44100 * 90})
+            .commit();
+        auto t2 = db.create_track("b.mp3");
+        t2.edit()
+            .set_artist(std::string{"Artist A"})
+            .set_title(std::string{"Apple"})
+            .set_genre(std::string{"House"})
+            .set_bpm(128)
+            .commit();
+        auto t3 = db.create_track("c.mp3");
+
+        // Act
+        auto snapshot = db.load_library_snapshot();
+
+        // Assert
+        BOOST_REQUIRE(snapshot.row_of(t1.id()));
+        BOOST_REQUIRE(snapshot.row_of(t2.id()));
+        BOOST_REQUIRE(snapshot.row_of(t3.id()));
+        auto r1 = *snapshot.row_of(t1.id());
+        auto r2 = *snapshot.row_of(t2.id());
+        auto r3 = *snapshot.row_of(t3.id());
+        BOOST_CHECK_EQUAL(snapshot.ids()[r1], t1.id());
+        BOOST_CHECK_EQUAL(snapshot.text(snapshot.titles()[r1]), "Zebra");
+        BOOST_CHECK_EQUAL(snapshot.text(snapshot.artists()[r2]), "Artist A");
+        BOOST_CHECK_EQUAL(snapshot.genres()[r1], snapshot.genres()[r2]);
+        BOOST_CHECK_EQUAL(
+            snapshot.artists()[r3], djinterop::library_snapshot::no_text);
+        BOOST_CHECK(snapshot.bpms()[r2] == 128.0);
+        BOOST_CHECK(snapshot.keys()[r1] == djinterop::musical_key::a_minor);
+        BOOST_CHECK(!snapshot.keys()[r2]);
+        BOOST_CHECK(snapshot.years()[r1] == 2001);
+        BOOST_CHECK(
+            snapshot.durations()[r1] == std::chrono::milliseconds{90000});
+        BOOST_CHECK(!snapshot.durations()[r3]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sorted_rows__columns__expected_order)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto t1 = db.create_track("a.mp3");
+        t1.edit().set_title(std::string{"Zebra"}).set_bpm(124).commit();
+        auto t2 = db.create_track("b.mp3");
+        t2.edit().set_title(std::string{"Apple"}).set_bpm(128).commit();
+        auto t3 = db.create_track("c.mp3");
+        t3.edit().set_bpm(124).commit();
+        auto snapshot = db.load_library_snapshot();
+        auto ids_of = [&](const std::vector<size_t>& rows) {
+            std::vector<int64_t> results;
+            for (auto row : rows)
+            {
+                if (snapshot.ids()[row] == t1.id() ||
+                    snapshot.ids()[row] == t2.id() ||
+                    snapshot.ids()[row] == t3.id())
+                {
+                    results.push_back(snapshot.ids()[row]);
+                }
+            }
+            return results;
+        };
+
+        // Act
+        auto by_title = snapshot.sorted_rows(library_column::title);
+        auto by_bpm_desc = snapshot.sorted_rows(library_column::bpm, true);
+
+        // Assert
+        BOOST_CHECK(
+            ids_of(by_title) ==
+            (std::vector<int64_t>{t2.id(), t1.id(), t3.id()}));
+        BOOST_CHECK(
+            ids_of(by_bpm_desc) ==
+            (std::vector<int64_t>{t2.id(), t1.id(), t3.id()}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rows_in_range__numeric_and_text_columns__expected_rows)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto t1 = db.create_track("a.mp3");
+        t1.edit().set_genre(std::string{"House"}).set_bpm(120).commit();
+        auto t2 = db.create_track("b.mp3");
+        t2.edit().set_genre(std::string{"Techno"}).set_bpm(130).commit();
+        auto t3 = db.create_track("c.mp3");
+        t3.edit().set_genre(std::string{"House"}).set_bpm(126).commit();
+        auto snapshot = db.load_library_snapshot();
+        auto r1 = *snapshot.row_of(t1.id());
+        auto r2 = *snapshot.row_of(t2.id());
+        auto r3 = *snapshot.row_of(t3.id());
+
+        // Act
+        auto in_range = snapshot.rows_in_range(library_column::bpm, 125, 135);
+        auto house = snapshot.rows_with_text(library_column::genre, "House");
+        auto fast_house = snapshot.rows_where([&](size_t row) {
+            return snapshot.genres()[row] == snapshot.genres()[r1] &&
+                   snapshot.bpms()[row] > 122.0;
+        });
+
+        // Assert
+        BOOST_CHECK(in_range == (std::vector<size_t>{r2, r3}));
+        BOOST_CHECK(house == (std::vector<size_t>{r1, r3}));
+        BOOST_CHECK(fast_house == (std::vector<size_t>{r3}));
+        BOOST_CHECK(
+            snapshot.rows_with_text(library_column::genre, "Jazz").empty());
+        BOOST_CHECK_THROW(
+            snapshot.rows_in_range(library_column::genre, 0, 1),
+            std::invalid_argument);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(decode__encoded_snapshot__same_columns)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto t1 = db.create_track("a.mp3");
+        t1.edit()
+            .set_artist(std::string{"Artist"})
+            .set_title(std::string{"Title"})
+            .set_bpm(124.5)
+            .set_key(djinterop::musical_key::c_major)
+            .set_year(1999)
+            .commit();
+        db.create_track("b.mp3");
+        auto snapshot = db.load_library_snapshot();
+
+        // Act
+        auto encoded = snapshot.encode();
+        auto decoded =
+            djinterop::library_snapshot::decode(encoded.data(), encoded.size());
+
+        // Assert
+        BOOST_CHECK(decoded.ids() == snapshot.ids());
+        BOOST_CHECK(decoded.bpms() == snapshot.bpms());
+        BOOST_CHECK(decoded.keys() == snapshot.keys());
+        BOOST_CHECK(decoded.years() == snapshot.years());
+        BOOST_CHECK(decoded.durations() == snapshot.durations());
+        BOOST_CHECK(decoded.bitrates() == snapshot.bitrates());
+        BOOST_CHECK(decoded.artists() == snapshot.artists());
+        BOOST_CHECK(decoded.titles() == snapshot.titles());
+        auto row = *decoded.row_of(t1.id());
+        BOOST_CHECK_EQUAL(decoded.text(decoded.artists()[row]), "Artist");
+        BOOST_CHECK(
+            decoded.sorted_rows(library_column::title) ==
+            snapshot.sorted_rows(library_column::title));
+        BOOST_CHECK_THROW(
+            djinterop::library_snapshot::decode(
+                encoded.data(), encoded.size() - 1),
+            std::invalid_argument);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(load_cached_library_snapshot__rebuilt__fresh_until_changed)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto t1 = db.create_track("a.mp3");
+        t1.edit().set_genre(std::string{"House"}).commit();
+        bool stale = false;
+        BOOST_CHECK(
+            !el::load_cached_library_snapshot(tmp_loc.temp_dir, stale));
+
+        // Act
+        auto rebuilt = el::rebuild_library_snapshot_cache(tmp_loc.temp_dir);
+        auto snapshot = rebuilt.get();
+        auto cached =
+            el::load_cached_library_snapshot(tmp_loc.temp_dir, stale);
+
+        // Assert
+        BOOST_REQUIRE(cached);
+        BOOST_CHECK(!stale);
+        BOOST_CHECK(cached->ids() == snapshot.ids());
+        BOOST_CHECK_EQUAL(
+            cached->rows_with_text(library_column::genre, "House").size(), 1);
+
+        db.create_track("b.mp3");
+        cached = el::load_cached_library_snapshot(tmp_loc.temp_dir, stale);
+        BOOST_REQUIRE(cached);
+        BOOST_CHECK(stale);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(load_cached_library_snapshot__no_database__stale)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        {
+            auto db =
+                el::create_database(tmp_loc.temp_dir, el::version_latest);
+            db.create_track("a.mp3");
+            el::rebuild_library_snapshot_cache(tmp_loc.temp_dir).get();
+        }
+        boost::filesystem::remove(tmp_loc.temp_dir_path / "m.db");
+        boost::filesystem::remove(tmp_loc.temp_dir_path / "p.db");
+
+        // Act
+        bool stale = false;
+        auto cached =
+            el::load_cached_library_snapshot(tmp_loc.temp_dir, stale);
+
+        // Assert
+        BOOST_REQUIRE(cached);
+        BOOST_CHECK(stale);
+        BOOST_CHECK_EQUAL(cached->ids().size(), 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rebuild_library_snapshot_cache__concurrent__all_succeed)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        for (int i = 0; i < 100; ++i)
+        {
+            db.create_track(std::to_string(i) + ".mp3");
+        }
+
+        // Act
+        std::vector<std::future<djinterop::library_snapshot>> rebuilds;
+        for (int i = 0; i < 8; ++i)
+        {
+            rebuilds.push_back(
+                el::rebuild_library_snapshot_cache(tmp_loc.temp_dir));
+        }
+
+        // Assert
+        for (auto& rebuild : rebuilds)
+        {
+            BOOST_CHECK_EQUAL(rebuild.get().ids().size(), 100);
+        }
+
+        bool stale = true;
+        auto cached =
+            el::load_cached_library_snapshot(tmp_loc.temp_dir, stale);
+        BOOST_REQUIRE(cached);
+        BOOST_CHECK(!stale);
+        BOOST_CHECK_EQUAL(cached->ids().size(), 100);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description(
+          "database::load_library_snapshot() timing with 100k tracks"))
+BOOST_AUTO_TEST_CASE(load_library_snapshot__100k_tracks__loads)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_artist("Artist " + std::to_string(i % 500))
+                    .set_title("Title " + std::to_string(i))
+                    .set_genre("Genre " + std::to_string(i % 20))
+                    .set_bpm(100 + i % 50)
+                    .set_year(1980 + i % 40)
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        auto snapshot = db.load_library_snapshot();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Loaded snapshot of 100k tracks in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                   .count()
+            << "ms");
+        BOOST_CHECK_GE(snapshot.size(), 100000);
+        BOOST_CHECK_EQUAL(
+            snapshot.rows_with_text(library_column::genre, "Genre 7").size(),
+            5000);
+    }
+}
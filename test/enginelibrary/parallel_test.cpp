@@ -0,0 +1,63 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE parallel_test
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <djinterop/parallel.hpp>
+
+namespace utf = boost::unit_test;
+
+BOOST_TEST_DECORATOR(
+    * utf::description("for_each_in_parallel() calls once for each index"))
+BOOST_AUTO_TEST_CASE(for_each_in_parallel__indices__each_called_once)
+{
+    // Arrange
+    std::vector<std::atomic<int>> calls(1000);
+
+    // Act
+    djinterop::for_each_in_parallel(
+        calls.size(), 8, [&](size_t index, size_t) { ++calls[index]; });
+
+    // Assert
+    for (auto&& call : calls)
+    {
+        BOOST_CHECK_EQUAL(call.load(), 1);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "for_each_in_parallel() rethrows an exception thrown by a call"))
+BOOST_AUTO_TEST_CASE(for_each_in_parallel__call_throws__rethrown)
+{
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        djinterop::for_each_in_parallel(
+            1000, 8,
+            [](size_t index, size_t) {
+                if (index == 10)
+                {
+                    throw std::runtime_error{"Failed"};
+                }
+            }),
+        std::runtime_error);
+}
@@ -0,0 +1,466 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MODULE track_query_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_cursor.hpp>
+#include <djinterop/track_edit.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/transaction_guard.hpp>
+
+#include "temporary_directory.hpp"
+
+namespace utf = boost::unit_test;
+namespace bdata = boost::unit_test::data;
+namespace el = djinterop::enginelibrary;
+
+using djinterop::musical_key;
+using djinterop::track_field;
+using djinterop::track_query;
+
+namespace
+{
+std::vector<int64_t> ids_of(djinterop::track_cursor cursor)
+{
+    std::vector<int64_t> ids;
+    while (auto tr = cursor.next())
+    {
+        ids.push_back(tr->id());
+    }
+
+    return ids;
+}
+
+std::vector<int64_t> ids_of(const std::vector<djinterop::track>& tracks)
+{
+    std::vector<int64_t> ids;
+    for (auto&& tr : tracks)
+    {
+        ids.push_back(tr.id());
+    }
+
+    return ids;
+}
+
+std::vector<int64_t> ids_of_all_pages(
+    const djinterop::database& db, const track_query& query, size_t page_size)
+{
+    std::vector<int64_t> ids;
+    djinterop::stdx::optional<std::string> token;
+    do
+    {
+        auto page = db.list_tracks(query, page_size, token);
+        BOOST_REQUIRE_LE(page.tracks.size(), page_size);
+        auto page_ids = ids_of(page.tracks);
+        ids.insert(ids.end(), page_ids.begin(), page_ids.end());
+        token = page.continuation_token;
+    } while (token);
+
+    return ids;
+}
+
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::query_tracks() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    query_tracks__predicates__expected_tracks, bdata::make(el::all_versions),
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        auto match = db.create_track("a.mp3");
+        match.edit()
+            .set_bpm(126)
+            .set_key(musical_key::a_minor)
+            .set_genre(std::string{"Techno"})
+            .commit();
+        auto slow = db.create_track("b.mp3");
+        slow.edit()
+            .set_bpm(120)
+            .set_key(musical_key::a_minor)
+            .set_genre(std::string{"Techno"})
+            .commit();
+        auto other_key = db.create_track("c.mp3");
+        other_key.edit()
+            .set_bpm(124)
+            .set_key(musical_key::c_major)
+            .set_genre(std::string{"Techno"})
+            .commit();
+        auto other_genre = db.create_track("d.mp3");
+        other_genre.edit()
+            .set_bpm(128)
+            .set_key(musical_key::e_minor)
+            .set_genre(std::string{"House"})
+            .commit();
+        auto edge = db.create_track("e.mp3");
+        edge.edit()
+            .set_bpm(128)
+            .set_key(musical_key::e_minor)
+            .set_genre(std::string{"Techno"})
+            .commit();
+
+        // Act
+        auto ids = ids_of(db.query_tracks(
+            track_query{}
+                .where_between(track_field::bpm, 124, 128)
+                .where_in(
+                    track_field::key, {musical_key::a_minor, musical_key::e_minor})
+                .where(
+                    track_field::genre, track_query::comparison::equal,
+                    "Techno")));
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(ids.size(), 2);
+        BOOST_CHECK_EQUAL(ids[0], match.id());
+        BOOST_CHECK_EQUAL(ids[1], edge.id());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::query_tracks() orders by metadata, with missing values last"))
+BOOST_AUTO_TEST_CASE(query_tracks__order_and_limit__expected_order)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        auto no_artist = db.create_track("a.mp3");
+        no_artist.set_year(2001);
+        auto artist_b = db.create_track("b.mp3");
+        artist_b.edit().set_artist("B").set_year(1999).commit();
+        auto artist_a_new = db.create_track("c.mp3");
+        artist_a_new.edit().set_artist("A").set_year(2010).commit();
+        auto artist_a_old = db.create_track("d.mp3");
+        artist_a_old.edit().set_artist("A").set_year(1990).commit();
+
+        // Act
+        auto ordered = ids_of(db.query_tracks(
+            track_query{}
+                .order_by(track_field::artist)
+                .order_by(track_field::year, true)));
+        auto limited = ids_of(db.query_tracks(
+            track_query{}.order_by(track_field::year, true).limit(2)));
+        auto missing = ids_of(
+            db.query_tracks(track_query{}.where_missing(track_field::artist)));
+        auto not_equal = ids_of(db.query_tracks(track_query{}.where(
+            track_field::artist, track_query::comparison::not_equal, "A")));
+        auto none =
+            ids_of(db.query_tracks(track_query{}.where_in(track_field::year, {})));
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(ordered.size(), 4);
+        BOOST_CHECK_EQUAL(ordered[0], artist_a_new.id());
+        BOOST_CHECK_EQUAL(ordered[1], artist_a_old.id());
+        BOOST_CHECK_EQUAL(ordered[2], artist_b.id());
+        BOOST_CHECK_EQUAL(ordered[3], no_artist.id());
+        BOOST_REQUIRE_EQUAL(limited.size(), 2);
+        BOOST_CHECK_EQUAL(limited[0], artist_a_new.id());
+        BOOST_CHECK_EQUAL(limited[1], no_artist.id());
+        BOOST_REQUIRE_EQUAL(missing.size(), 1);
+        BOOST_CHECK_EQUAL(missing[0], no_artist.id());
+        BOOST_REQUIRE_EQUAL(not_equal.size(), 1);
+        BOOST_CHECK_EQUAL(not_equal[0], artist_b.id());
+        BOOST_CHECK(none.empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "track_query rejects values of the wrong kind for a field"))
+BOOST_AUTO_TEST_CASE(where__mismatched_value__throws)
+{
+    // Arrange
+    track_query query;
+
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        query.where(track_field::bpm, track_query::comparison::equal, "fast"),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        query.where_between(track_field::title, 1, 2), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        query.where(track_field::year, track_query::comparison::between, 2000),
+        std::invalid_argument);
+    BOOST_CHECK(query.predicates().empty());
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description("database::query_tracks() timing with 100k tracks"))
+BOOST_AUTO_TEST_CASE(query_tracks__100k_tracks__queries)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_genre("Genre " + std::to_string(i % 20))
+                    .set_bpm(100 + i % 50)
+                    .set_key(static_cast<musical_key>(1 + i % 24))
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        // Act
+        auto start = std::chrono::steady_clock::now();
+        auto ids = ids_of(db.query_tracks(
+            track_query{}
+                .where_between(track_field::bpm, 124, 128)
+                .where_in(
+                    track_field::key, {musical_key::a_minor, musical_key::e_minor})
+                .where(
+                    track_field::genre, track_query::comparison::equal,
+                    "Genre 4")
+                .order_by(track_field::bpm)));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Assert
+        BOOST_TEST_MESSAGE(
+            "Queried 100k tracks in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                   .count()
+            << "ms");
+        BOOST_CHECK(!ids.empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::list_tracks() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    list_tracks__all_pages__same_as_query, bdata::make(el::all_versions),
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        for (int i = 0; i < 23; ++i)
+        {
+            auto tr = db.create_track(std::to_string(i) + ".mp3");
+            auto edit = tr.edit();
+            if (i % 5 != 0)
+            {
+                edit.set_artist("Artist " + std::to_string(i % 3));
+            }
+            if (i % 4 != 0)
+            {
+                edit.set_title("Title " + std::to_string(i % 6));
+            }
+            if (i % 7 != 0)
+            {
+                edit.set_year(2000 + i % 2);
+            }
+            edit.commit();
+        }
+
+        const std::vector<track_query> queries{
+            track_query{}
+                .order_by(track_field::artist)
+                .order_by(track_field::title, true),
+            track_query{}
+                .order_by(track_field::artist, true)
+                .order_by(track_field::year),
+            track_query{}.order_by(track_field::year).order_by(
+                track_field::title),
+            track_query{}
+                .where(
+                    track_field::year, track_query::comparison::equal, 2001)
+                .order_by(track_field::title),
+            track_query{},
+        };
+
+        for (auto&& query : queries)
+        {
+            // Act
+            auto expected = ids_of(db.query_tracks(query));
+            auto single_pages = ids_of_all_pages(db, query, 1);
+            auto larger_pages = ids_of_all_pages(db, query, 4);
+            auto one_page = ids_of_all_pages(db, query, expected.size());
+
+            // Assert
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                single_pages.begin(), single_pages.end(), expected.begin(),
+                expected.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                larger_pages.begin(), larger_pages.end(), expected.begin(),
+                expected.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                one_page.begin(), one_page.end(), expected.begin(),
+                expected.end());
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::list_tracks() by negative and signed zero real keys"))
+BOOST_AUTO_TEST_CASE(list_tracks__negative_real_keys__all_pages)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        for (double bpm : {-100.0, -99.5, -0.0, 0.0, 98.0})
+        {
+            db.create_track(std::to_string(bpm) + ".mp3").set_bpm(bpm);
+        }
+
+        auto query = track_query{}.order_by(track_field::bpm);
+        auto expected = ids_of(db.query_tracks(query));
+
+        // Act
+        auto single_pages = ids_of_all_pages(db, query, 1);
+
+        // Assert
+        BOOST_CHECK_EQUAL(expected.size(), 5);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            single_pages.begin(), single_pages.end(), expected.begin(),
+            expected.end());
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::list_tracks() rejects invalid arguments"))
+BOOST_AUTO_TEST_CASE(list_tracks__invalid_arguments__throws)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        db.create_track("a.mp3").set_artist(std::string{"A"});
+        db.create_track("b.mp3").set_artist(std::string{"B"});
+        auto query = track_query{}.order_by(track_field::artist);
+        auto token = db.list_tracks(query, 1).continuation_token;
+        BOOST_REQUIRE(token);
+
+        // Act/Assert
+        BOOST_CHECK_THROW(db.list_tracks(query, 0), std::invalid_argument);
+        BOOST_CHECK_THROW(
+            db.list_tracks(query, 1, std::string{"garbage"}),
+            std::invalid_argument);
+        BOOST_CHECK_THROW(
+            db.list_tracks(
+                track_query{}.order_by(track_field::artist).order_by(
+                    track_field::title),
+                1, token),
+            std::invalid_argument);
+        BOOST_CHECK_EQUAL(db.list_tracks(query, 1, token).tracks.size(), 1);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::label("benchmark") * utf::disabled()
+    * utf::description(
+          "database::list_tracks() timing of pages deep into 100k tracks"))
+BOOST_AUTO_TEST_CASE(list_tracks__100k_tracks__constant_time_pages)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, el::version_latest);
+        {
+            auto guard = db.begin_transaction();
+            for (int i = 0; i < 100000; ++i)
+            {
+                auto tr = db.create_track(std::to_string(i) + ".mp3");
+                tr.edit()
+                    .set_artist("Artist " + std::to_string(i * 31 % 30000))
+                    .set_title("Title " + std::to_string(i * 7919 % 100000))
+                    .commit();
+            }
+            guard.commit();
+        }
+
+        auto query = track_query{}
+                         .order_by(track_field::artist)
+                         .order_by(track_field::title);
+
+        // Act
+        std::vector<std::chrono::steady_clock::duration> elapsed;
+        size_t count = 0;
+        djinterop::stdx::optional<std::string> token;
+        do
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto page = db.list_tracks(query, 50, token);
+            elapsed.push_back(std::chrono::steady_clock::now() - start);
+            count += page.tracks.size();
+            token = page.continuation_token;
+        } while (token);
+
+        // Assert
+        auto us = [](std::chrono::steady_clock::duration d) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(d)
+                .count();
+        };
+        // Average over a window of full pages at either end, skipping the
+        // first page (cold caches) and the last page (possibly partial).
+        const auto window = 20;
+        BOOST_REQUIRE_GT(elapsed.size(), 2 * window + 2);
+        auto early = std::accumulate(
+                         elapsed.begin() + 1, elapsed.begin() + 1 + window,
+                         std::chrono::steady_clock::duration::zero()) /
+                     window;
+        auto late = std::accumulate(
+                        elapsed.end() - 1 - window, elapsed.end() - 1,
+                        std::chrono::steady_clock::duration::zero()) /
+                    window;
+        BOOST_TEST_MESSAGE(
+            "Listed 100k tracks in " << elapsed.size() << " pages, taking "
+                                     << us(early) << "us per early page and "
+                                     << us(late) << "us per late page");
+        BOOST_CHECK_EQUAL(count, 100000);
+
+        // Keyset pagination must not degrade with depth the way an OFFSET
+        // scan would; the factor and slack are generous to absorb noise.
+        BOOST_CHECK_LE(us(late), 10 * us(early) + 2000);
+    }
+}
@@ -28,7 +28,10 @@
 #include <djinterop/crate.hpp>
 #include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
+#include <djinterop/exceptions.hpp>
 #include <djinterop/track.hpp>
+#include <djinterop/track_edit.hpp>
+#include <djinterop/transaction_guard.hpp>
 
 #define STRINGIFY(x) STRINGIFY_(x)
 #define STRINGIFY_(x) #x
@@ -217,6 +220,39 @@ BOOST_AUTO_TEST_CASE(tracks_by_relative_path__invalid_path__no_ids)
     BOOST_CHECK_EQUAL(results.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(tracks_by_relative_paths__mixed_paths__aligned_results)
+{
+    // Arrange
+    auto db = el::load_database(sample_path);
+
+    // Act
+    auto results = db.tracks_by_relative_paths(
+        {"Does Not Exist.mp3",
+         "../01 - Dennis Cruz - Mad (Original Mix).mp3"});
+
+    // Assert
+    BOOST_CHECK_EQUAL(results.size(), 2);
+    BOOST_CHECK_EQUAL(results[0].size(), 0);
+    BOOST_CHECK_EQUAL(results[1].size(), 1);
+    BOOST_CHECK_EQUAL(results[1][0].id(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(tracks_by_ids__mixed_ids__aligned_results)
+{
+    // Arrange
+    auto db = el::load_database(sample_path);
+
+    // Act
+    auto results = db.tracks_by_ids({123, 1, 1, 456});
+
+    // Assert
+    BOOST_CHECK_EQUAL(results.size(), 4);
+    BOOST_CHECK(!results[0]);
+    BOOST_CHECK_EQUAL(results[1]->id(), 1);
+    BOOST_CHECK_EQUAL(results[2]->id(), 1);
+    BOOST_CHECK(!results[3]);
+}
+
 BOOST_AUTO_TEST_CASE(ctor__track1__correct_fields)
 {
     // Arrange
@@ -340,3 +376,249 @@ BOOST_AUTO_TEST_CASE(set_sampling__zero_rate__no_sampling)
     // Assert
     BOOST_CHECK(t.sampling() == djinterop::stdx::nullopt);
 }
+
+BOOST_AUTO_TEST_CASE(edit__example_track_1__saves)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto t = db.create_track("");
+    populate_example_track_2(t);
+
+    // Act
+    t.edit()
+        .set_track_number(1)
+        .set_bpm(123)
+        .set_year(2017)
+        .set_title("Mad (Original Mix)"s)
+        .set_artist("Dennis Cruz"s)
+        .set_album("Mad EP"s)
+        .set_genre("Tech House"s)
+        .set_comment("Purchased at Beatport.com"s)
+        .set_publisher("Stereo Productions"s)
+        .set_composer(djinterop::stdx::nullopt)
+        .set_key(djinterop::musical_key::a_minor)
+        .set_relative_path("../01 - Dennis Cruz - Mad (Original Mix).mp3")
+        .set_last_modified_at(
+            c::system_clock::time_point{c::seconds{1509371790}})
+        .set_bitrate(320)
+        .set_last_played_at(djinterop::stdx::nullopt)
+        .set_last_accessed_at(
+            c::system_clock::time_point{c::seconds{1509321600}})
+        .set_import_info(djinterop::stdx::nullopt)
+        .set_album_art_id(2)
+        .commit();
+
+    // Assert
+    auto t_reloaded = *db.track_by_id(t.id());
+    check_track_1(t);
+    check_track_1(t_reloaded);
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(edit__performance_data__saves)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto t = db.create_track("");
+    djinterop::hot_cue cue{"Drop"s, 1234567, djinterop::pad_color{}};
+
+    // Act
+    auto edit = t.edit();
+    edit.set_sampling(djinterop::sampling_info{44100, 17452800})
+        .set_average_loudness(0.5)
+        .set_default_main_cue(2732)
+        .set_adjusted_main_cue(2732)
+        .set_hot_cue_at(3, cue);
+    edit.commit();
+
+    // Assert
+    BOOST_CHECK(!edit.changes().sampling);
+    BOOST_CHECK(*t.sampling() == (djinterop::sampling_info{44100, 17452800}));
+    BOOST_CHECK_EQUAL(t.duration()->count(), 395755);
+    BOOST_CHECK_CLOSE(*t.average_loudness(), 0.5, 0.001);
+    BOOST_CHECK_EQUAL(t.default_main_cue(), 2732);
+    BOOST_CHECK_EQUAL(t.adjusted_main_cue(), 2732);
+    BOOST_CHECK(*t.hot_cue_at(3) == cue);
+    BOOST_CHECK(!t.hot_cue_at(0));
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(bpm__changed_via_other_handle__new_value)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto t = db.create_track("");
+    t.set_bpm(120);
+    BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+    auto other = *db.track_by_id(t.id());
+
+    // Act
+    other.set_bpm(128);
+
+    // Assert
+    BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(track_by_id__two_lookups__edits_shared)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto id = db.create_track("a.mp3").id();
+    auto t = *db.track_by_id(id);
+    t.set_bpm(120);
+    BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+    auto other = *db.tracks_by_ids({id})[0];
+
+    // Act
+    other.set_bpm(128);
+    other.set_year(1999);
+
+    // Assert
+    BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+    BOOST_CHECK_EQUAL(*t.year(), 1999);
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(remove_track__live_handle__no_longer_found)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto t = db.create_track("a.mp3");
+    t.set_bpm(120);
+    auto id = t.id();
+
+    // Act
+    db.remove_track(t);
+
+    // Assert
+    BOOST_CHECK(!db.track_by_id(id));
+    BOOST_CHECK_THROW(t.relative_path(), djinterop::track_deleted);
+    auto created = db.create_track("b.mp3");
+    auto found = *db.track_by_id(created.id());
+    BOOST_CHECK_EQUAL(found.relative_path(), "b.mp3");
+    BOOST_CHECK(!found.bpm());
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(bpm__changed_via_other_connection__new_value)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    {
+        auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+        auto t = db.create_track("");
+        t.set_bpm(120);
+        BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+        auto other_db = el::load_database(temp_dir.string());
+        auto other = *other_db.track_by_id(t.id());
+
+        // Act
+        other.set_bpm(128);
+        other.set_relative_path("moved.mp3");
+
+        // Assert
+        BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+        BOOST_CHECK_EQUAL(t.relative_path(), "moved.mp3");
+    }
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(
+    bpm__changed_via_other_connection_in_transaction__new_value)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    {
+        auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+        auto t = db.create_track("");
+        t.set_bpm(120);
+        BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+        auto other_db = el::load_database(temp_dir.string());
+        auto other = *other_db.track_by_id(t.id());
+
+        // Act
+        other.set_bpm(128);
+
+        // Assert
+        auto guard = db.begin_transaction();
+        BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+        guard.commit();
+    }
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(
+    bpm__changed_via_other_connection_cache_this_connection__old_value)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    {
+        auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+        db.set_track_row_cache_policy(
+            djinterop::track_row_cache_policy::this_connection);
+        auto t = db.create_track("");
+        t.set_bpm(120);
+        BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+        auto other_db = el::load_database(temp_dir.string());
+        auto other = *other_db.track_by_id(t.id());
+
+        // Act
+        other.set_bpm(128);
+
+        // Assert
+        BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+        t.set_year(2020);
+        BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+    }
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(
+    bpm__changed_via_other_connection_cache_disabled__new_value)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    {
+        auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+        db.set_track_row_cache_policy(
+            djinterop::track_row_cache_policy::disabled);
+        auto t = db.create_track("");
+        t.set_bpm(120);
+        BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+        auto other_db = el::load_database(temp_dir.string());
+        auto other = *other_db.track_by_id(t.id());
+
+        // Act
+        other.set_bpm(128);
+
+        // Assert
+        BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+    }
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(bpm__transaction_rolled_back__old_value)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_7_1);
+    auto t = db.create_track("");
+    t.set_bpm(120);
+
+    // Act
+    {
+        auto guard = db.begin_transaction();
+        t.set_bpm(128);
+        BOOST_CHECK_CLOSE(*t.bpm(), 128.0, 0.001);
+    }
+
+    // Assert
+    BOOST_CHECK_CLOSE(*t.bpm(), 120.0, 0.001);
+    remove_temp_dir(temp_dir);
+}